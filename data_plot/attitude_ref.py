@@ -0,0 +1,96 @@
+"""Referência em float do estimador de atitude do firmware.
+
+Uso:
+    python attitude_ref.py sensor_data.csv [adc_att.csv] [tau_ms]
+
+Reproduz o filtro complementar de inc/dsp/attitude.c em ponto flutuante a
+partir do CSV de amostras (m/s² e °/s). Sem o segundo arquivo, imprime
+time_s,roll,pitch,yaw; com ele, compara linha a linha com a saída gravada
+pelo firmware na mesma coleta, informa o maior desvio de cada ângulo e
+termina com erro se algum passar de MAX_ERROR_DEG. host_test/attitude_replay.c
+gera os dois arquivos no PC a partir de um CSV de amostras.
+"""
+import csv
+import math
+import sys
+
+G = 9.81
+MAX_DT_MS = 1000
+
+# Maior desvio aceito em relação ao firmware, em graus. A saída do firmware
+# é arredondada a 0,01° depois de attitude_centideg descartar os 16 bits
+# baixos do BAM (até ~0,011° juntos); a integração em BAM, o CORDIC e o
+# peso do acelerômetro somam menos de 0,002°.
+MAX_ERROR_DEG = 0.02
+
+
+def wrap(deg):
+    return (deg + 180.0) % 360.0 - 180.0
+
+
+def accel_angles(ax, ay, az):
+    roll = math.degrees(math.atan2(ay, az))
+    pitch = math.degrees(math.atan2(-ax, math.hypot(ay, az)))
+    return roll, pitch
+
+
+def iter_attitude(rows, tau_ms=1000):
+    """Gera (time_s, roll, pitch, yaw) em graus para cada amostra."""
+    state = None
+    last_ms = 0
+    for t, ax, ay, az, gx, gy, gz in rows:
+        ms = round(t * 1000)
+        if state is None:
+            state = [*accel_angles(ax, ay, az), 0.0]
+            last_ms = ms
+            yield (t, *state)
+            continue
+
+        dt = min(ms - last_ms, MAX_DT_MS)
+        last_ms = ms
+        state[0] = wrap(state[0] + gx * dt / 1000.0)
+        state[1] = wrap(state[1] + gy * dt / 1000.0)
+        state[2] = wrap(state[2] + gz * dt / 1000.0)
+
+        # Correção pelo acelerômetro só perto de 1 g, como no firmware
+        norm = math.sqrt(ax * ax + ay * ay + az * az) / G
+        if 0.75 < norm < 1.25 and dt > 0:
+            w = dt / (tau_ms + dt)
+            for i, target in enumerate(accel_angles(ax, ay, az)):
+                state[i] = wrap(state[i] + w * wrap(target - state[i]))
+        yield (t, *state)
+
+
+def read_csv(path):
+    with open(path, newline='') as f:
+        reader = csv.reader(f)
+        next(reader)
+        for fields in reader:
+            if fields:
+                yield tuple(map(float, fields))
+
+
+def compare(ref, device):
+    worst = [0.0, 0.0, 0.0]
+    n = 0
+    for r, d in zip(ref, device):
+        for i in range(3):
+            worst[i] = max(worst[i], abs(wrap(r[i + 1] - d[i + 1])))
+        n += 1
+    print(f'{n} linhas; desvio máximo: roll {worst[0]:.3f}°, pitch {worst[1]:.3f}°, yaw {worst[2]:.3f}°'
+          f' (limite {MAX_ERROR_DEG}°)')
+    return n > 0 and max(worst) <= MAX_ERROR_DEG
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+    tau = int(sys.argv[3]) if len(sys.argv) > 3 else 1000
+    ref = iter_attitude(read_csv(sys.argv[1]), tau)
+    if len(sys.argv) > 2:
+        sys.exit(0 if compare(ref, read_csv(sys.argv[2])) else 1)
+    else:
+        print('time_s,roll,pitch,yaw')
+        for row in ref:
+            print(','.join(f'{v:.2f}' for v in row))
@@ -0,0 +1,226 @@
+"""Modelo de referência do banco de filtros em ponto fixo do firmware.
+
+Uso:
+    python filter_ref.py
+
+Reproduz bit a bit a aritmética de inc/dsp/filter_bank.c (biquads em Q2.30
+com realimentação do erro de arredondamento, FIR em Q15) e compara a saída
+com a mesma cascata calculada em precisão dupla, com os mesmos coeficientes
+quantizados. Assim o desvio medido é só o da aritmética em ponto fixo.
+
+Os biquads passa-baixas e passa-altas são exercitados com cortes de 0,001
+a 0,45 da taxa de amostragem, com 1 e 4 seções, e o FIR com dois projetos.
+Cada um recebe degrau, senoides perto e longe do corte e ruído, sem
+saturar. O programa mostra o maior desvio e o desvio médio, em contagens
+do sensor, e termina com erro se algum passar do limite do seu tipo.
+"""
+import math
+import random
+import struct
+import sys
+
+BIQUAD_COEF_SHIFT = 30
+BIQUAD_ONE = 1 << BIQUAD_COEF_SHIFT
+FILTER_MAX_FIR = 16
+
+# Maior desvio aceito em relação à precisão dupla, em contagens: por seção
+# nos biquads (cada seção arredonda a saída para 16 bits e a seguinte
+# filtra esse erro) e no total no FIR, que arredonda uma vez por amostra
+MAX_ERROR_PER_SECTION = 2.0
+MAX_ERROR_FIR = 0.5
+
+
+def f32(v):
+    """Arredonda para float de 32 bits, como os argumentos float do firmware."""
+    return struct.unpack('<f', struct.pack('<f', v))[0]
+
+
+def c_round(v):
+    """round() do C: metades se afastam do zero."""
+    return math.floor(v + 0.5) if v >= 0 else -math.floor(-v + 0.5)
+
+
+def to_q30(v):
+    q = c_round(v * BIQUAD_ONE)
+    return max(-(1 << 31), min((1 << 31) - 1, q))
+
+
+def error_feedback_taps(a1):
+    """Pesos (k1, k2) da realimentação do erro, como error_feedback_taps."""
+    if -a1 > BIQUAD_ONE + BIQUAD_ONE // 2:
+        return 2, -1
+    if -a1 > 0:
+        return 1, 0
+    if -a1 > -BIQUAD_ONE:
+        return 0, 0
+    return -1, 0
+
+
+def design_biquads(kind, fc_hz, fs_hz, sections):
+    """Coeficientes (b0, b1, b2, a1, a2) em Q30, como filter_bank_set_biquads."""
+    w0 = 2.0 * math.pi * f32(fc_hz) / f32(fs_hz)
+    cw = math.cos(w0)
+    order = 2 * sections
+    coefs = []
+    for k in range(sections):
+        q = 1.0 / (2.0 * math.cos(math.pi * (2 * k + 1) / (2.0 * order)))
+        alpha = math.sin(w0) / (2.0 * q)
+        a0 = 1.0 + alpha
+        a1 = to_q30(-2.0 * cw / a0)
+        a2 = to_q30((1.0 - alpha) / a0)
+        if kind == 'lp':
+            b0 = to_q30((1.0 - cw) / 2.0 / a0)
+            b1 = BIQUAD_ONE + a1 + a2 - 2 * b0
+        else:
+            b0 = to_q30((1.0 + cw) / 2.0 / a0)
+            b1 = -2 * b0
+        coefs.append((b0, b1, b0, a1, a2))
+    return coefs
+
+
+def design_fir(taps, fc):
+    """Coeficientes Q15 de fir_design_lowpass (sinc com janela de Hamming).
+
+    O firmware calcula em float; aqui o cálculo é em dupla, então um
+    coeficiente pode diferir em 1 LSB. A comparação usa os mesmos
+    coeficientes nos dois modelos, o que não afeta o resultado.
+    """
+    def windowed_sinc(i):
+        n = i - (taps - 1) / 2.0
+        sinc = 2.0 * fc if n == 0 else math.sin(2.0 * math.pi * fc * n) / (math.pi * n)
+        window = 0.54 - 0.46 * math.cos(2.0 * math.pi * i / (taps - 1)) if taps > 1 else 1.0
+        return sinc * window
+
+    total = sum(windowed_sinc(i) for i in range(taps))
+    coef = [c_round(windowed_sinc(i) / total * 32768.0) for i in range(taps)]
+    coef[taps // 2] += 32768 - sum(coef)
+    return coef
+
+
+def sat16(v):
+    return max(-32768, min(32767, v))
+
+
+class Biquad:
+    """biquad_process: forma direta I, acumulação exata e erro realimentado."""
+
+    def __init__(self, coef):
+        self.b0, self.b1, self.b2, self.a1, self.a2 = coef
+        self.k1, self.k2 = error_feedback_taps(self.a1)
+        self.x1 = self.x2 = self.y1 = self.y2 = 0
+        self.err1 = self.err2 = 0
+
+    def process(self, x):
+        # As metades de 16 bits do firmware somam exatamente o produto
+        # completo; em Python o inteiro não transborda
+        acc = (self.b0 * x + self.b1 * self.x1 + self.b2 * self.x2
+               - self.a1 * self.y1 - self.a2 * self.y2
+               + self.k1 * self.err1 + self.k2 * self.err2)
+        q = acc >> BIQUAD_COEF_SHIFT
+        self.err2 = self.err1
+        self.err1 = acc - (q << BIQUAD_COEF_SHIFT)
+        y = sat16(q)
+        if y != q:
+            self.err1 = 0
+        self.x2, self.x1 = self.x1, x
+        self.y2, self.y1 = self.y1, y
+        return y
+
+
+class Fir:
+    """FIR do filter_bank_process: acumulador com arredondamento, saída >> 15."""
+
+    def __init__(self, coef):
+        self.coef = coef
+        self.hist = [0] * FILTER_MAX_FIR
+        self.pos = 0
+
+    def process(self, x):
+        self.hist[self.pos] = x
+        acc = 1 << 14
+        for k, c in enumerate(self.coef):
+            acc += c * self.hist[(self.pos - k) & (FILTER_MAX_FIR - 1)]
+        self.pos = (self.pos + 1) & (FILTER_MAX_FIR - 1)
+        return sat16(acc >> 15)
+
+
+def run_fixed(stages, signal):
+    out = []
+    for x in signal:
+        for s in stages:
+            x = s.process(x)
+        out.append(x)
+    return out
+
+
+def run_double(biquads, fir, signal):
+    """Mesma cascata em precisão dupla, com os coeficientes quantizados."""
+    state = [[0.0] * 4 for _ in biquads]
+    hist = [0.0] * len(fir)
+    out = []
+    for x in signal:
+        x = float(x)
+        for (b0, b1, b2, a1, a2), s in zip(biquads, state):
+            y = (b0 * x + b1 * s[0] + b2 * s[1] - a1 * s[2] - a2 * s[3]) / BIQUAD_ONE
+            s[1], s[0] = s[0], x
+            s[3], s[2] = s[2], y
+            x = y
+        if fir:
+            hist = [x] + hist[:-1]
+            x = sum(c * h for c, h in zip(fir, hist)) / 32768.0
+        out.append(x)
+    return out
+
+
+def test_signals(fs_hz, fc_hz, n=4000):
+    rng = random.Random(1)
+    yield 'degrau', [0] * 100 + [12000] * (n - 100)
+    for name, f in (('seno no corte', fc_hz), ('seno 0,2 fc', fc_hz * 0.2),
+                    ('seno 3 fc', min(fc_hz * 3, fs_hz * 0.45))):
+        yield name, [round(10000 * math.sin(2 * math.pi * f / fs_hz * i)) for i in range(n)]
+    yield 'ruido', [rng.randint(-8000, 8000) for _ in range(n)]
+
+
+# (tipo, parâmetros): cortes muito baixos e perto de fs / 2 são os piores
+# casos dos biquads
+CONFIGS = tuple(
+    (kind, (ratio * 1000.0, 1000.0, sections))
+    for kind in ('lp', 'hp')
+    for ratio in (0.001, 0.005, 0.02, 0.1, 0.25, 0.45)
+    for sections in (1, 4)
+) + (
+    ('fir', (16, 5.0, 100.0)),
+    ('fir', (9, 40.0, 1000.0)),
+)
+
+
+def check():
+    ok = True
+    for kind, params in CONFIGS:
+        if kind == 'fir':
+            taps, fc_hz, fs_hz = params
+            biquads, fir = [], design_fir(taps, f32(fc_hz) / f32(fs_hz))
+            label = f'fir {taps} coef, fc {fc_hz:g} Hz, fs {fs_hz:g} Hz'
+            limit = MAX_ERROR_FIR
+        else:
+            fc_hz, fs_hz, sections = params
+            biquads, fir = design_biquads(kind, fc_hz, fs_hz, sections), []
+            label = f'{kind} {sections} seç., fc {fc_hz:g} Hz, fs {fs_hz:g} Hz'
+            limit = MAX_ERROR_PER_SECTION * sections
+
+        for name, signal in test_signals(fs_hz, fc_hz):
+            stages = [Biquad(c) for c in biquads] + ([Fir(fir)] if fir else [])
+            fixed = run_fixed(stages, signal)
+            ref = run_double(biquads, fir, signal)
+            errors = [abs(a - b) for a, b in zip(fixed, ref)]
+            worst = max(errors)
+            mean = sum(errors) / len(errors)
+            passed = worst <= limit
+            ok = ok and passed
+            print(f'{label:36} {name:14} máx {worst:6.3f}  média {mean:6.3f}'
+                  f'{"" if passed else "  FALHOU"}')
+    return ok
+
+
+if __name__ == '__main__':
+    sys.exit(0 if check() else 1)
@@ -0,0 +1,508 @@
+"""Decodificador dos arquivos de log binários gravados pelo data logger.
+
+Uso:
+    python log_decoder.py adc_col_data.bin [saida.csv]
+
+Aceita os arquivos .bin, .blz, .cfr, .clz, .col, .olz, .sfr e .slz e gera
+um CSV com as mesmas colunas do formato texto do firmware (os resumos por
+janela mantêm as suas próprias colunas). Frames com CRC inválido são
+descartados com um aviso; para cartões danificados use log_recover.py.
+
+Para o formato colunar, read_columns() lê apenas os canais pedidos.
+
+Os tempos das amostras são devolvidos em us. A partir da versão 3 eles são
+reconstruídos das âncoras (posição na grade, período e instante medido da
+primeira amostra) gravadas em cada bloco delta e em cada chunk colunar.
+"""
+import struct
+import sys
+import zlib
+from array import array
+
+try:
+    import lz4.block as lz4_block
+except ImportError:
+    lz4_block = None
+
+LOG_FILE_MAGIC = b'DLOG'
+LOG_FORMAT_CSV = 0
+LOG_FORMAT_DELTA = 1
+LOG_FORMAT_COLUMNAR = 2
+LOG_FORMAT_STATS = 3
+
+# Formatos gravados como texto CSV dentro dos frames
+TEXT_FORMATS = (LOG_FORMAT_CSV, LOG_FORMAT_STATS)
+
+# Nomes dos canais na ordem gravada pelo firmware
+CHANNELS = ('time_us', 'accel_x', 'accel_y', 'accel_z', 'giro_x', 'giro_y', 'giro_z')
+
+DELTA_BLOCK_TAG = 0x44
+DELTA_BLOCK_TAG_ANCHOR = 0x54
+DELTA_BLOCK_TAG_GRID = 0x47
+DELTA_BLOCK_HEADER = struct.Struct('<BBHHB')
+# index, period_us, time_us: âncora dos blocos delta e dos chunks colunares
+TIME_ANCHOR = struct.Struct('<IIQ')
+DELTA_PACK_VARINT = 0
+DELTA_PACK_BITS = 1
+
+LOG_FLAG_LZ = 0x01
+LOG_FLAG_FRAMED = 0x02
+
+COL_CHUNK_TAG = 0x43
+COL_CHUNK_TAG_ANCHOR = 0x63
+COL_CHUNK_HEADER = struct.Struct('<BBHHH14i')
+
+LOG_FRAME_SYNC = struct.pack('<I', 0xA55AD10C)
+# sync, session, seq, method, format, raw_len, data_len, info, crc
+LOG_FRAME_HEADER = struct.Struct('<IIIBBHHHI')
+LOG_FRAME_STORED = 0
+LOG_FRAME_LZ = 1
+
+CSV_HEADER = 'time_s,accel_x,accel_y,accel_z,giro_x,giro_y,giro_z'
+# Canal opcional gravado com "temp log on": temperatura média em contagens
+LOG_CHANNELS = 7
+TEMP_COLUMN = 'temp_c'
+
+# Fatores de escala padrão do MPU6050 (±2 g e ±250 °/s), usados quando o
+# cabeçalho não traz a configuração do sensor (header_size < 22)
+ACCEL_SCALE = 9.81 / 16384.0
+GYRO_SCALE = 1.0 / 131.0
+DEFAULT_SCALE = (ACCEL_SCALE, GYRO_SCALE)
+
+# accel_range, gyro_range, dlpf, smplrt_div, accel_scale, gyro_scale
+SENSOR_INFO = struct.Struct('<BBBBff')
+LOG_FILE_VERSION = 3
+LOG_FILE_HEADER_SIZE = 10 + SENSOR_INFO.size
+
+# Sensibilidade do giroscópio em LSB/(°/s) * 10 para cada gyro_range
+GYRO_LSB_X10 = (1310, 655, 328, 164)
+
+
+def sensor_from_info(info):
+    """Decodifica o campo info de um frame (log_frame_info no firmware).
+
+    Retorna (canais, accel_range, gyro_range, dlpf, smplrt_div, accel_scale,
+    gyro_scale), com os fatores de escala calculados como no firmware.
+    """
+    accel_range = info & 0x03
+    gyro_range = (info >> 2) & 0x03
+    channels = LOG_CHANNELS + ((info >> 7) & 1)
+    accel_scale = struct.unpack('<f', struct.pack('<f', 9.81 / (16384 >> accel_range)))[0]
+    gyro_scale = struct.unpack('<f', struct.pack('<f', 10.0 / GYRO_LSB_X10[gyro_range]))[0]
+    return (channels, accel_range, gyro_range, (info >> 4) & 0x07, info >> 8,
+            accel_scale, gyro_scale)
+
+
+def read_header(data):
+    """Lê o cabeçalho do arquivo e retorna (dicionário, offset do primeiro bloco)."""
+    if data[:4] != LOG_FILE_MAGIC:
+        raise ValueError('arquivo não é um log binário (assinatura inválida)')
+    header_size, version, fmt, channels, flags = struct.unpack_from('<HBBBB', data, 4)
+    header = {
+        'version': version,
+        'format': fmt,
+        'channels': channels,
+        'flags': flags,
+        'scale': DEFAULT_SCALE,
+    }
+    if header_size >= 10 + SENSOR_INFO.size:
+        accel_range, gyro_range, dlpf, div, accel_scale, gyro_scale = SENSOR_INFO.unpack_from(data, 10)
+        header.update({
+            'accel_range_g': 2 << accel_range,
+            'gyro_range_dps': 250 << gyro_range,
+            'dlpf': dlpf,
+            'smplrt_div': div,
+            'scale': (accel_scale, gyro_scale),
+        })
+    if version < 2 and flags & LOG_FLAG_LZ:
+        raise ValueError('frames da versão 1 não são mais suportados')
+    return header, header_size
+
+
+def read_varint(data, pos):
+    result = 0
+    shift = 0
+    while True:
+        b = data[pos]
+        pos += 1
+        result |= (b & 0x7F) << shift
+        if b < 0x80:
+            return result, pos
+        shift += 7
+
+
+def zigzag_decode(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+def decode_delta_block(data, pos):
+    """Decodifica o bloco em pos. Retorna (lista de amostras, offset do próximo bloco).
+
+    O primeiro valor de cada amostra é o tempo em us: reconstruído da âncora
+    nos blocos com âncora, convertido do canal em ms nos blocos antigos.
+    """
+    tag, channels, samples, length, packing = DELTA_BLOCK_HEADER.unpack_from(data, pos)
+    if tag not in (DELTA_BLOCK_TAG, DELTA_BLOCK_TAG_ANCHOR, DELTA_BLOCK_TAG_GRID):
+        raise ValueError(f'bloco inválido no offset {pos}')
+    pos += DELTA_BLOCK_HEADER.size
+    anchor = None
+    if tag != DELTA_BLOCK_TAG:
+        anchor = TIME_ANCHOR.unpack_from(data, pos)
+        pos += TIME_ANCHOR.size
+    start = pos
+    end = pos + length
+
+    # Blocos da grade: o key-frame começa com as posições puladas antes da
+    # amostra 1 e cada resíduo com a variação delas (nos blocos
+    # DELTA_BLOCK_TAG_ANCHOR é sempre 0)
+    grid = tag == DELTA_BLOCK_TAG_GRID
+    steps = [0]
+    skipped = 0
+    if grid:
+        skipped, pos = read_varint(data, pos)
+
+    # Key-frame: valores absolutos da primeira amostra
+    prev = []
+    for _ in range(channels):
+        v, pos = read_varint(data, pos)
+        prev.append(zigzag_decode(v))
+    rows = [list(prev)] if samples else []
+
+    if packing == DELTA_PACK_VARINT:
+        for _ in range(samples - 1):
+            if grid:
+                v, pos = read_varint(data, pos)
+                skipped += zigzag_decode(v)
+            steps.append(steps[-1] + 1 + skipped)
+            for c in range(channels):
+                v, pos = read_varint(data, pos)
+                prev[c] += zigzag_decode(v)
+            rows.append(list(prev))
+    elif packing == DELTA_PACK_BITS:
+        skipped_width = 0
+        if grid:
+            skipped_width = data[pos]
+            pos += 1
+        widths = data[pos:pos + channels]
+        pos += channels
+        # O fluxo de bits é lido como um único inteiro little-endian
+        bits = int.from_bytes(data[pos:end], 'little')
+        masks = [(1 << w) - 1 for w in widths]
+        skipped_mask = (1 << skipped_width) - 1
+        for _ in range(samples - 1):
+            skipped += zigzag_decode(bits & skipped_mask)
+            bits >>= skipped_width
+            steps.append(steps[-1] + 1 + skipped)
+            for c in range(channels):
+                prev[c] += zigzag_decode(bits & masks[c])
+                bits >>= widths[c]
+            rows.append(list(prev))
+        pos = end
+    else:
+        raise ValueError(f'empacotamento {packing} desconhecido no offset {start}')
+
+    if pos != end:
+        raise ValueError(f'tamanho do bloco inconsistente no offset {start}')
+
+    if anchor:
+        # steps[k] é a distância da amostra k à âncora, em posições da grade
+        _, period_us, time_us = anchor
+        rows = [[time_us + k * period_us] + row for k, row in zip(steps, rows)]
+    else:
+        for row in rows:
+            row[0] *= 1000
+    return rows, end
+
+
+def _lz_decompress_py(src, raw_len):
+    """Descompressor LZ4 (formato de bloco) em Python puro."""
+    out = bytearray()
+    pos = 0
+    end = len(src)
+    while pos < end:
+        token = src[pos]
+        pos += 1
+        lit = token >> 4
+        if lit == 15:
+            while True:
+                b = src[pos]
+                pos += 1
+                lit += b
+                if b != 255:
+                    break
+        out += src[pos:pos + lit]
+        pos += lit
+        if pos >= end:
+            break  # A última sequência só tem literais
+        offset = src[pos] | (src[pos + 1] << 8)
+        pos += 2
+        mlen = token & 15
+        if mlen == 15:
+            while True:
+                b = src[pos]
+                pos += 1
+                mlen += b
+                if b != 255:
+                    break
+        mlen += 4
+        start = len(out) - offset
+        if offset >= mlen:
+            out += out[start:start + mlen]
+        else:
+            # Match sobreposto: repete os últimos offset bytes
+            out += (out[start:] * (mlen // offset + 1))[:mlen]
+    if len(out) != raw_len:
+        raise ValueError('frame LZ corrompido')
+    return bytes(out)
+
+
+def lz_decompress(src, raw_len):
+    if lz4_block is not None:
+        return lz4_block.decompress(src, uncompressed_size=raw_len)
+    return _lz_decompress_py(src, raw_len)
+
+
+def scan_frames(data, pos=0, stop=None):
+    """Procura frames íntegros em data[pos:] e gera dicionários com os dados.
+
+    A busca é feita pela palavra de sincronismo, então trechos corrompidos ou
+    lixo entre frames são pulados. Cada frame tem o CRC verificado e os dados
+    já são entregues descomprimidos. Se stop for dado, só frames que começam
+    antes dele são entregues (o frame pode terminar depois).
+    """
+    end = len(data)
+    if stop is None:
+        stop = end
+    while True:
+        pos = data.find(LOG_FRAME_SYNC, pos)
+        if pos < 0 or pos >= stop or pos + LOG_FRAME_HEADER.size > end:
+            return
+        (_, session, seq, method, fmt, raw_len, data_len, info,
+         crc) = LOG_FRAME_HEADER.unpack_from(data, pos)
+        body = pos + LOG_FRAME_HEADER.size
+        if body + data_len > end or method not in (LOG_FRAME_STORED, LOG_FRAME_LZ):
+            pos += 1
+            continue
+        head = data[pos:pos + LOG_FRAME_HEADER.size - 4]
+        chunk = data[body:body + data_len]
+        if zlib.crc32(chunk, zlib.crc32(head)) != crc:
+            pos += 1
+            continue
+        if method == LOG_FRAME_LZ:
+            chunk = lz_decompress(bytes(chunk), raw_len)
+        yield {
+            'offset': pos,
+            'end': body + data_len,
+            'session': session,
+            'seq': seq,
+            'format': fmt,
+            'info': info,
+            'data': bytes(chunk),
+        }
+        pos = body + data_len
+
+
+def unpack_frames(data, pos):
+    """Junta os dados dos frames a partir de pos, avisando sobre frames perdidos."""
+    out = bytearray()
+    expected = 0
+    for frame in scan_frames(data, pos):
+        if frame['seq'] != expected:
+            print(f'aviso: frames {expected} a {frame["seq"] - 1} perdidos ou corrompidos',
+                  file=sys.stderr)
+        expected = frame['seq'] + 1
+        out += frame['data']
+    return bytes(out)
+
+
+def read_payload(data):
+    """Retorna (cabeçalho, dados após o cabeçalho já descomprimidos)."""
+    header, pos = read_header(data)
+    if header['flags'] & (LOG_FLAG_LZ | LOG_FLAG_FRAMED):
+        return header, unpack_frames(data, pos)
+    return header, data[pos:]
+
+
+def read_col_chunk_header(buf, pos=0):
+    """Lê o cabeçalho de um chunk colunar em buf[pos:].
+
+    Nos chunks com âncora a primeira coluna é o índice da amostra na grade;
+    nos antigos (sem 'anchor') é o tempo em ms.
+    """
+    fields = COL_CHUNK_HEADER.unpack_from(buf, pos)
+    tag, channels, samples, capacity, size = fields[:5]
+    if tag not in (COL_CHUNK_TAG, COL_CHUNK_TAG_ANCHOR):
+        raise ValueError(f'chunk colunar inválido no offset {pos}')
+    limits = fields[5:]
+    chunk = {
+        'channels': channels,
+        'samples': samples,
+        'capacity': capacity,
+        'size': size,
+        'min': limits[0::2],
+        'max': limits[1::2],
+        'header_size': COL_CHUNK_HEADER.size,
+        'anchor': None,
+    }
+    if tag == COL_CHUNK_TAG_ANCHOR:
+        chunk['anchor'] = TIME_ANCHOR.unpack_from(buf, pos + COL_CHUNK_HEADER.size)
+        chunk['header_size'] += TIME_ANCHOR.size
+    return chunk
+
+
+# Bytes lidos para obter o cabeçalho de um chunk de qualquer versão
+COL_CHUNK_HEADER_MAX = COL_CHUNK_HEADER.size + TIME_ANCHOR.size
+
+
+def col_offset(chunk, channel):
+    """Deslocamento da coluna dentro do chunk: tempo/índice (u32) e depois os eixos (i16)."""
+    if channel == 0:
+        return chunk['header_size']
+    return chunk['header_size'] + 4 * chunk['capacity'] + 2 * chunk['capacity'] * (channel - 1)
+
+
+def _col_array(channel, raw):
+    values = array('I' if channel == 0 else 'h')
+    values.frombytes(raw)
+    if sys.byteorder != 'little':
+        values.byteswap()
+    return values
+
+
+def _col_times(chunk, raw):
+    """Converte a primeira coluna do chunk em tempos em us."""
+    column = _col_array(0, raw)
+    if chunk['anchor'] is None:
+        return array('Q', (t * 1000 for t in column))
+    index, period_us, time_us = chunk['anchor']
+    return array('Q', (time_us + (n - index) * period_us for n in column))
+
+
+def read_columns(path, names=CHANNELS, chunk_filter=None):
+    """Lê apenas os canais em names de um log colunar.
+
+    Retorna um dicionário nome -> array. chunk_filter(chunk) pode descartar
+    chunks inteiros a partir do cabeçalho (min/max) sem ler suas colunas.
+    Em arquivos sem frames só os bytes das colunas pedidas são lidos.
+    """
+    channels = [CHANNELS.index(n) for n in names]
+    out = {n: array('Q') if c == 0 else _col_array(c, b'') for n, c in zip(names, channels)}
+
+    with open(path, 'rb') as f:
+        head = f.read(64)
+        header, pos = read_header(head)
+        if header['format'] != LOG_FORMAT_COLUMNAR:
+            raise ValueError('o arquivo não está no formato colunar')
+
+        if header['flags'] & (LOG_FLAG_LZ | LOG_FLAG_FRAMED):
+            f.seek(0)
+            _, payload = read_payload(f.read())
+            read = lambda off, n: payload[off:off + n]
+            end = len(payload)
+            pos = 0
+        else:
+            def read(off, n):
+                f.seek(off)
+                return f.read(n)
+            f.seek(0, 2)
+            end = f.tell()
+
+        while pos + COL_CHUNK_HEADER.size <= end:
+            chunk = read_col_chunk_header(read(pos, COL_CHUNK_HEADER_MAX))
+            if chunk_filter is None or chunk_filter(chunk):
+                for n, c in zip(names, channels):
+                    width = 4 if c == 0 else 2
+                    raw = read(pos + col_offset(chunk, c), width * chunk['samples'])
+                    out[n].extend(_col_times(chunk, raw) if c == 0 else _col_array(c, raw))
+            pos += chunk['size']
+
+    return out
+
+
+def iter_col_samples(payload):
+    pos = 0
+    while pos < len(payload):
+        chunk = read_col_chunk_header(payload, pos)
+        cols = []
+        for c in range(chunk['channels']):
+            width = 4 if c == 0 else 2
+            start = pos + col_offset(chunk, c)
+            raw = payload[start:start + width * chunk['samples']]
+            cols.append(_col_times(chunk, raw) if c == 0 else _col_array(c, raw))
+        yield from zip(*cols)
+        pos += chunk['size']
+
+
+def iter_samples(data):
+    """Percorre todas as amostras brutas (tempo em us, contagens do sensor)."""
+    header, payload = read_payload(data)
+    yield from iter_payload_samples(header, payload)
+
+
+def iter_payload_samples(header, payload):
+    if header['format'] == LOG_FORMAT_COLUMNAR:
+        yield from iter_col_samples(payload)
+        return
+    if header['format'] != LOG_FORMAT_DELTA:
+        raise ValueError(f'formato {header["format"]} não suportado')
+    pos = 0
+    while pos < len(payload):
+        rows, pos = decode_delta_block(payload, pos)
+        yield from rows
+
+
+def to_units(row, scale=DEFAULT_SCALE):
+    """Converte uma amostra bruta para segundos, m/s² e °/s.
+
+    scale é o par (m/s² por contagem, °/s por contagem) do cabeçalho. Com o
+    canal de temperatura, acrescenta a temperatura em °C.
+    """
+    a, g = scale
+    t, ax, ay, az, gx, gy, gz = row[:LOG_CHANNELS]
+    out = (t / 1e6, ax * a, ay * a, az * a, gx * g, gy * g, gz * g)
+    if len(row) > LOG_CHANNELS:
+        out += (row[LOG_CHANNELS] / 340.0 + 36.53,)
+    return out
+
+
+def csv_header(header):
+    """Linha de cabeçalho do CSV para as amostras do log descrito em header."""
+    if header['channels'] > LOG_CHANNELS:
+        return CSV_HEADER + ',' + TEMP_COLUMN
+    return CSV_HEADER
+
+
+def format_rows(rows, scale=DEFAULT_SCALE):
+    """Formata amostras brutas como linhas do CSV (mesmas colunas do firmware)."""
+    lines = []
+    for row in rows:
+        values = to_units(row, scale)
+        lines.append('%.6f,' % values[0] + ','.join('%.2f' % v for v in values[1:]) + '\n')
+    return ''.join(lines)
+
+
+def convert(path_in, out):
+    with open(path_in, 'rb') as f:
+        convert_data(f.read(), out)
+
+
+def convert_data(data, out):
+    """Escreve em out o CSV correspondente ao log completo em data."""
+    header, payload = read_payload(data)
+    if header['format'] in TEXT_FORMATS:
+        # CSV ou resumo por janela: o conteúdo já é o texto gerado pelo firmware
+        out.write(payload.decode())
+        return
+    out.write(csv_header(header) + '\n')
+    out.write(format_rows(iter_payload_samples(header, payload), header['scale']))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], 'w') as out:
+            convert(sys.argv[1], out)
+    else:
+        convert(sys.argv[1], sys.stdout)
@@ -0,0 +1,92 @@
+"""Recupera coletas a partir de um log truncado ou de uma imagem do cartão SD.
+
+Uso:
+    python log_recover.py imagem.img [pasta_saida]
+
+Procura frames íntegros (sincronismo + CRC) em qualquer posição do arquivo,
+agrupa-os por sessão, ordena pelo número de sequência e grava, para cada
+sessão, um log reconstruído (recuperado_<sessão>.dlog) e o CSV decodificado.
+Lacunas na sequência são listadas; os frames restantes continuam válidos.
+
+A imagem pode ser obtida com, por exemplo:
+    dd if=/dev/sdX of=imagem.img bs=4M
+"""
+import mmap
+import os
+import struct
+import sys
+
+import log_decoder as ld
+
+
+def find_sessions(data):
+    """Retorna {sessão: {seq: frame}} com todos os frames íntegros em data."""
+    sessions = {}
+    for frame in ld.scan_frames(data):
+        frames = sessions.setdefault(frame['session'], {})
+        # Cópias repetidas do mesmo frame (setores realocados) são ignoradas
+        frames.setdefault(frame['seq'], frame)
+    return sessions
+
+
+def gaps(seqs):
+    """Lista os intervalos (primeiro, último) de frames ausentes."""
+    missing = []
+    expected = 0
+    for seq in seqs:
+        if seq > expected:
+            missing.append((expected, seq - 1))
+        expected = seq + 1
+    return missing
+
+
+def rebuild(data, frames):
+    """Monta um log DLOG com os frames da sessão em ordem.
+
+    O cabeçalho original não está nos frames: a configuração do sensor e o
+    número de canais vêm do campo info, repetido em cada frame.
+    """
+    fmt = frames[0]['format']
+    channels, *sensor = ld.sensor_from_info(frames[0]['info'])
+    out = bytearray(ld.LOG_FILE_MAGIC)
+    out += struct.pack('<HBBBB', ld.LOG_FILE_HEADER_SIZE, ld.LOG_FILE_VERSION, fmt, channels,
+                       ld.LOG_FLAG_FRAMED | ld.LOG_FLAG_LZ)
+    out += ld.SENSOR_INFO.pack(*sensor)
+    for frame in frames:
+        out += data[frame['offset']:frame['end']]
+    return bytes(out)
+
+
+def recover(path, out_dir):
+    os.makedirs(out_dir, exist_ok=True)
+    with open(path, 'rb') as f, mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as data:
+        sessions = find_sessions(data)
+        if not sessions:
+            print('nenhum frame íntegro encontrado')
+            return
+
+        for session, by_seq in sorted(sessions.items()):
+            seqs = sorted(by_seq)
+            frames = [by_seq[s] for s in seqs]
+            size = sum(len(fr['data']) for fr in frames)
+            print(f'sessão {session:08x}: {len(frames)} frames, {size} bytes, '
+                  f'formato {frames[0]["format"]}')
+            for first, last in gaps(seqs):
+                print(f'  frames {first} a {last} ausentes')
+
+            name = os.path.join(out_dir, f'recuperado_{session:08x}')
+            log = rebuild(data, frames)
+            with open(name + '.dlog', 'wb') as out:
+                out.write(log)
+            with open(name + '.csv', 'w') as out:
+                try:
+                    ld.convert_data(log, out)
+                except (ValueError, IndexError, struct.error) as e:
+                    print(f'  erro ao decodificar: {e}')
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+    recover(sys.argv[1], sys.argv[2] if len(sys.argv) > 2 else '.')
@@ -0,0 +1,155 @@
+"""Leitura em fluxo e decimação min/max de logs grandes.
+
+iter_rows() percorre as amostras já convertidas (s, m/s², °/s) de um CSV ou
+de qualquer log binário do firmware sem carregar o arquivo inteiro. Os logs
+com frames são lidos da saída do conversor em C++ (host_tools/log_convert.cpp)
+quando ele está no PATH ou em LOG_CONVERT; sem ele, são decodificados aqui.
+MinMaxDecimator reduz o fluxo a um número fixo de intervalos, guardando o
+mínimo e o máximo de cada canal: o traçado resultante é visualmente igual
+ao original, mas o custo de desenhar depende só da largura em pixels.
+"""
+import csv
+import mmap
+import os
+import shutil
+import subprocess
+
+import log_decoder as ld
+
+CSV_COLUMNS = ld.CSV_HEADER.split(',')
+
+# Executável do conversor em C++, se disponível
+LOG_CONVERT = os.environ.get('LOG_CONVERT') or shutil.which('log_convert')
+
+
+def iter_rows(path):
+    """Gera tuplas (tempo, accel_x, ..., giro_z) em unidades físicas."""
+    with open(path, 'rb') as f:
+        magic = f.read(len(ld.LOG_FILE_MAGIC))
+
+    if magic != ld.LOG_FILE_MAGIC:
+        yield from _iter_csv(path)
+        return
+
+    with open(path, 'rb') as f, mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as data:
+        header, pos = ld.read_header(data)
+        if header['format'] == ld.LOG_FORMAT_STATS:
+            raise ValueError('resumos por janela não têm amostras; use log_decoder.py')
+        if not header['flags'] & ld.LOG_FLAG_FRAMED:
+            # Logs antigos sem frames: decodificados de uma vez
+            for row in ld.iter_samples(data[:]):
+                yield ld.to_units(row, header['scale'])
+            return
+        if LOG_CONVERT:
+            yield from _iter_converter(path)
+            return
+        for frame in ld.scan_frames(data, pos):
+            if frame['format'] == ld.LOG_FORMAT_CSV:
+                yield from _parse_csv_lines(frame['data'].decode().splitlines())
+            else:
+                for row in ld.iter_payload_samples(frame, frame['data']):
+                    yield ld.to_units(row, header['scale'])
+
+
+def _iter_converter(path):
+    """Lê em fluxo o CSV gerado pelo conversor em C++."""
+    proc = subprocess.Popen([LOG_CONVERT, path], stdout=subprocess.PIPE, text=True)
+    done = False
+    try:
+        yield from _parse_csv_lines(proc.stdout)
+        done = True
+    finally:
+        # Leitura interrompida: o conversor não precisa terminar o arquivo
+        proc.stdout.close()
+        if not done:
+            proc.kill()
+        proc.wait()
+    if proc.returncode:
+        raise RuntimeError(f'{LOG_CONVERT} terminou com erro {proc.returncode}')
+
+
+def _iter_csv(path):
+    with open(path, newline='') as f:
+        yield from _parse_csv_lines(f)
+
+
+def _parse_csv_lines(lines):
+    for fields in csv.reader(lines):
+        # Linha de cabeçalho (no início do arquivo ou do primeiro frame)
+        if not fields or fields[0] == CSV_COLUMNS[0]:
+            continue
+        yield tuple(map(float, fields))
+
+
+class MinMaxDecimator:
+    """Decimação min/max em fluxo com memória limitada.
+
+    Cada intervalo cobre 'step' amostras e guarda, por canal, o mínimo e o
+    máximo com os respectivos tempos. Quando o número de intervalos passa de
+    2 * buckets, intervalos vizinhos são unidos e 'step' dobra, então o total
+    de amostras não precisa ser conhecido antes.
+    """
+
+    def __init__(self, channels, buckets=2000):
+        self.channels = channels
+        self.buckets = buckets
+        self.step = 1
+        self.count = 0
+        self.data = []  # por intervalo: [t_min, v_min, t_max, v_max] * canais
+
+    def push(self, t, values):
+        if self.count % self.step == 0:
+            self.data.append([x for v in values for x in (t, v, t, v)])
+            if len(self.data) > 2 * self.buckets:
+                self._merge()
+        else:
+            cur = self.data[-1]
+            for i, v in enumerate(values):
+                k = 4 * i
+                if v < cur[k + 1]:
+                    cur[k] = t
+                    cur[k + 1] = v
+                if v > cur[k + 3]:
+                    cur[k + 2] = t
+                    cur[k + 3] = v
+        self.count += 1
+
+    def _merge(self):
+        merged = []
+        for a, b in zip(self.data[0::2], self.data[1::2]):
+            for k in range(0, len(a), 4):
+                if b[k + 1] < a[k + 1]:
+                    a[k:k + 2] = b[k:k + 2]
+                if b[k + 3] > a[k + 3]:
+                    a[k + 2:k + 4] = b[k + 2:k + 4]
+            merged.append(a)
+        if len(self.data) % 2:
+            merged.append(self.data[-1])
+        # A união acontece logo após abrir o intervalo 2 * buckets + 1, que
+        # começa em um múltiplo do novo passo e fica sozinho no fim da lista
+        self.data = merged
+        self.step *= 2
+
+    def series(self, channel):
+        """Retorna (tempos, valores) do canal, com min e max na ordem temporal."""
+        k = 4 * channel
+        ts = []
+        vs = []
+        for b in self.data:
+            t_min, v_min, t_max, v_max = b[k:k + 4]
+            if t_min <= t_max:
+                ts += (t_min, t_max)
+                vs += (v_min, v_max)
+            else:
+                ts += (t_max, t_min)
+                vs += (v_max, v_min)
+        return ts, vs
+
+
+def load_decimated(path, buckets=2000):
+    """Lê o log em fluxo e retorna o MinMaxDecimator com os seis canais."""
+    dec = MinMaxDecimator(len(CSV_COLUMNS) - 1, buckets)
+    for row in iter_rows(path):
+        # A temperatura opcional (última coluna) não entra nos seis canais
+        dec.push(row[0], row[1:len(CSV_COLUMNS)])
+    return dec
@@ -1,20 +1,26 @@
-import pandas as pd
+import sys
+
 import matplotlib.pyplot as plt
 
-# Carregar os dados do arquivo CSV
-dados = pd.read_csv('sensor_data.csv')  # Altere para o nome do seu arquivo
+from log_stream import load_decimated
 
-# Verificar as primeiras linhas para confirmar leitura
-print(dados.head())
+# Arquivo de dados: CSV ou log binário do firmware (.bin, .blz, .col, ...)
+arquivo = sys.argv[1] if len(sys.argv) > 1 else 'sensor_data.csv'
 
 # Criar figura com subplots
-plt.figure(figsize=(15, 10))
+fig = plt.figure(figsize=(15, 10))
+
+# Os dados são lidos em fluxo e reduzidos a min/max por coluna de pixels,
+# então o tempo de desenho não depende do número de linhas do arquivo
+largura_px = int(fig.get_figwidth() * fig.dpi)
+dados = load_decimated(arquivo, buckets=largura_px)
+print(f'{dados.count} amostras lidas, {len(dados.data)} intervalos de {dados.step} amostras')
 
 # Gráfico de aceleração
 plt.subplot(2, 1, 1)
-plt.plot(dados['time_s'], dados['accel_x'], label='Acel X')
-plt.plot(dados['time_s'], dados['accel_y'], label='Acel Y')
-plt.plot(dados['time_s'], dados['accel_z'], label='Acel Z')
+plt.plot(*dados.series(0), label='Acel X')
+plt.plot(*dados.series(1), label='Acel Y')
+plt.plot(*dados.series(2), label='Acel Z')
 plt.title('Acelerômetro')
 plt.ylabel('Aceleração (m/s²)')
 plt.xlabel('Tempo (s)')
@@ -23,9 +29,9 @@ plt.grid(True)
 
 # Gráfico de giroscópio
 plt.subplot(2, 1, 2)
-plt.plot(dados['time_s'], dados['giro_x'], label='Giro X')
-plt.plot(dados['time_s'], dados['giro_y'], label='Giro Y')
-plt.plot(dados['time_s'], dados['giro_z'], label='Giro Z')
+plt.plot(*dados.series(3), label='Giro X')
+plt.plot(*dados.series(4), label='Giro Y')
+plt.plot(*dados.series(5), label='Giro Z')
 plt.title('Giroscópio')
 plt.ylabel('Velocidade Angular (º/s)')
 plt.xlabel('Tempo (s)')
@@ -0,0 +1,101 @@
+"""Referência exata do resumo por janela do firmware.
+
+Uso:
+    python window_stats_ref.py ws_in.csv adc_stats.csv
+
+Recalcula com frações cada linha do resumo gravado por
+inc/dsp/window_stats.c (time_s, n e mean, var, min, max e rms por eixo) a
+partir das amostras em contagens (time_ms e os 6 eixos), consumidas em
+sequência com o n de cada linha. mean é arredondada ao centésimo mais
+próximo com empate para longe do zero; var (populacional) e rms, que não
+são negativos, com empate para cima. Informa a primeira diferença de cada
+campo e termina com erro se houver alguma. host_test/window_stats.c gera
+os dois arquivos no PC.
+"""
+import csv
+import math
+import sys
+from fractions import Fraction
+
+AXES = 6
+FIELDS = ('mean', 'var', 'min', 'max', 'rms')
+
+
+def round_half_away(x):
+    """Inteiro mais próximo de uma fração, com empate para longe do zero."""
+    n = abs(x)
+    r = math.floor(n + Fraction(1, 2))
+    return r if x >= 0 else -r
+
+
+def centi_sqrt(v):
+    """Centésimos da raiz de uma fração v >= 0, arredondados ao mais próximo."""
+    # round(100 * sqrt(v)) = maior r com (r - 1/2)² <= 10000 * v
+    x = 10000 * v
+    r = math.isqrt(math.floor(x))
+    return r + 1 if (r + Fraction(1, 2)) ** 2 <= x else r
+
+
+def centi(text):
+    """Campo com duas casas decimais em centésimos, sem passar por float."""
+    return round_half_away(Fraction(text) * 100)
+
+
+def window_summary(rows):
+    """Campos (mean, var, min, max, rms) por eixo, em centésimos onde cabe."""
+    n = len(rows)
+    result = []
+    for a in range(AXES):
+        xs = [r[a + 1] for r in rows]
+        s = sum(xs)
+        s2 = sum(x * x for x in xs)
+        mean = Fraction(s, n)
+        var = Fraction(s2, n) - mean * mean
+        result.append((round_half_away(100 * mean), round_half_away(100 * var), min(xs), max(xs),
+                       centi_sqrt(Fraction(s2, n))))
+    return result
+
+
+def read_rows(path):
+    with open(path, newline='') as f:
+        reader = csv.reader(f)
+        next(reader)
+        for fields in reader:
+            if fields:
+                yield tuple(map(int, fields))
+
+
+def compare(samples, device):
+    samples = iter(samples)
+    first = {}
+    windows = 0
+    with open(device, newline='') as f:
+        reader = csv.reader(f)
+        next(reader)
+        for fields in reader:
+            n = int(fields[1])
+            rows = [next(samples) for _ in range(n)]
+            # O tempo segue o "%.2f" do CSV de amostras (csv_put_time), que
+            # não define o empate: aceita qualquer um dos dois lados
+            if abs(Fraction(fields[0]) * 1000 - rows[0][0]) > 5:
+                first.setdefault('time_s', (windows, fields[0], rows[0][0]))
+            for a, ref in enumerate(window_summary(rows)):
+                got = fields[2 + a * 5:7 + a * 5]
+                values = (centi(got[0]), centi(got[1]), int(got[2]), int(got[3]), centi(got[4]))
+                for name, r, d, text in zip(FIELDS, ref, values, got):
+                    if r != d:
+                        first.setdefault(f'{name} eixo {a}', (windows, text, r))
+            windows += 1
+
+    leftover = sum(1 for _ in samples)
+    for key, (w, got, ref) in first.items():
+        print(f'{key}: janela {w} tem {got}, referência {ref}')
+    print(f'{windows} janelas; {len(first)} campos com diferença; {leftover} amostras sobrando')
+    return windows > 0 and not first and leftover == 0
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 3:
+        print(__doc__)
+        sys.exit(1)
+    sys.exit(0 if compare(read_rows(sys.argv[1]), sys.argv[2]) else 1)
@@ -0,0 +1,154 @@
+/*
+ Reprodução no PC do estimador de atitude (inc/dsp/attitude.c) sobre um
+ CSV de amostras, para comparar com a referência em float de
+ data_plot/attitude_ref.py.
+
+ Uso, a partir da raiz do repositório:
+   gcc -O2 -Wall -Ihost_test/sdk -I. -Iinc/dsp host_test/attitude_replay.c \
+       inc/dsp/attitude.c inc/log_codec/csv_format.c -lm -o attitude_replay
+   ./attitude_replay data_plot/sensor_data.csv att_in.csv att_out.csv [tau_ms]
+   python3 data_plot/attitude_ref.py att_in.csv att_out.csv [tau_ms]
+
+ sensor_data.csv é uma coleta lenta, sempre perto de 1 g. Com --synthetic
+ no lugar do CSV é gerado um movimento que passa pelo que ela não tem:
+ roll dando voltas (passagem por ±180°), pitch até ±60°, choques acima de
+ 1,25 g (correção suspensa) e uma pausa maior que ATT_MAX_DT_MS.
+
+ As amostras do CSV (m/s² e °/s, faixa padrão) voltam a contagens do
+ sensor, arredondadas, e passam por attitude_update como no firmware;
+ att_out.csv recebe as linhas de attitude_format_line (o adc_att.csv da
+ coleta). att_in.csv recebe as mesmas contagens convertidas de volta
+ para m/s² e °/s sem arredondar, de modo que a referência veja
+ exatamente a entrada do filtro. attitude_ref.py compara as duas saídas
+ e termina com erro se algum ângulo passar de MAX_ERROR_DEG.
+*/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "attitude.h"
+
+// Faixa padrão: ±2 g e ±250 °/s
+#define ACCEL_LSB_PER_G 16384
+#define GYRO_LSB_X10 1310
+#define G 9.81
+
+// Amostras geradas com --synthetic, a cada 1 ms (coleta a 1 kHz)
+#define SYNTH_SAMPLES 60000
+#define SYNTH_PERIOD_MS 1
+
+static attitude_t att;
+static FILE *ref_in;
+static FILE *out;
+
+static int16_t to_counts(double v, double lsb) {
+    double c = round(v * lsb);
+    return c > 32767 ? 32767 : c < -32768 ? -32768 : (int16_t)c;
+}
+
+// Passa uma amostra pelo filtro e grava a saída e a entrada da referência
+static void replay(uint32_t ms, const int16_t accel[3], const int16_t gyro[3]) {
+    char buf[ATTITUDE_LINE_MAX];
+
+    attitude_update(&att, ms, accel, gyro);
+    fwrite(buf, 1, attitude_format_line(&att, ms, buf), out);
+    fprintf(ref_in, "%.3f,%.9f,%.9f,%.9f,%.9f,%.9f,%.9f\n", ms / 1000.0,
+            accel[0] * G / ACCEL_LSB_PER_G, accel[1] * G / ACCEL_LSB_PER_G, accel[2] * G / ACCEL_LSB_PER_G,
+            gyro[0] * 10.0 / GYRO_LSB_X10, gyro[1] * 10.0 / GYRO_LSB_X10, gyro[2] * 10.0 / GYRO_LSB_X10);
+}
+
+// Amostras do CSV (m/s² e °/s) convertidas de volta a contagens
+static uint32_t replay_csv(FILE *in) {
+    char line[256];
+    uint32_t samples = 0;
+
+    fgets(line, sizeof(line), in); // Cabeçalho
+    while (fgets(line, sizeof(line), in)) {
+        double t, v[6];
+        if (sscanf(line, "%lf,%lf,%lf,%lf,%lf,%lf,%lf", &t, &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) != 7) {
+            continue;
+        }
+        int16_t accel[3], gyro[3];
+        for (int i = 0; i < 3; i++) {
+            accel[i] = to_counts(v[i], ACCEL_LSB_PER_G / G);
+            gyro[i] = to_counts(v[i + 3], GYRO_LSB_X10 / 10.0);
+        }
+
+        // Mesmo arredondamento do tempo que attitude_ref.py
+        replay((uint32_t)llround(t * 1000), accel, gyro);
+        samples++;
+    }
+    return samples;
+}
+
+/*
+ Movimento sintético: o roll gira a 90 °/s e inverte a cada 8 s, o pitch
+ oscila ±60° e o yaw ±45°, com o giroscópio coerente com os ângulos e um
+ pouco de ruído. A cada 7 s há 0,2 s de choque (|a| = 1,6 g) e aos 30 s
+ uma pausa de 3 s na coleta.
+*/
+static uint32_t replay_synthetic(void) {
+    uint32_t seed = 1;
+    double roll = 0;
+    uint32_t ms = 0;
+
+    for (uint32_t i = 0; i < SYNTH_SAMPLES; i++) {
+        double t = ms / 1000.0;
+        double roll_rate = ((uint32_t)(t / 8) % 2) ? -90.0 : 90.0;
+        double pitch = 60.0 * sin(2 * M_PI * t / 11);
+        double pitch_rate = 60.0 * 2 * M_PI / 11 * cos(2 * M_PI * t / 11);
+        double yaw_rate = 45.0 * 2 * M_PI / 5 * cos(2 * M_PI * t / 5);
+        double g = (ms % 7000) < 200 ? 1.6 : 1.0;
+
+        double r = roll * M_PI / 180, p = pitch * M_PI / 180;
+        double a[3] = {-sin(p), cos(p) * sin(r), cos(p) * cos(r)};
+        double w[3] = {roll_rate, pitch_rate, yaw_rate};
+        int16_t accel[3], gyro[3];
+        for (int k = 0; k < 3; k++) {
+            seed = seed * 1103515245u + 12345u;
+            int noise = (int)((seed >> 16) % 81) - 40;
+            accel[k] = to_counts(a[k] * g, ACCEL_LSB_PER_G) + noise;
+            gyro[k] = to_counts(w[k], GYRO_LSB_X10 / 10.0) + noise / 8;
+        }
+        replay(ms, accel, gyro);
+
+        ms += SYNTH_PERIOD_MS;
+        roll += roll_rate * SYNTH_PERIOD_MS / 1000.0;
+        if (i == SYNTH_SAMPLES / 2) {
+            ms += 3000;
+        }
+    }
+    return SYNTH_SAMPLES;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        fprintf(stderr, "uso: attitude_replay sensor_data.csv|--synthetic att_in.csv att_out.csv [tau_ms]\n");
+        return 1;
+    }
+    bool synthetic = strcmp(argv[1], "--synthetic") == 0;
+    FILE *in = synthetic ? NULL : fopen(argv[1], "r");
+    ref_in = fopen(argv[2], "w");
+    out = fopen(argv[3], "w");
+    if ((!synthetic && !in) || !ref_in || !out) {
+        perror("attitude_replay");
+        return 1;
+    }
+    uint32_t tau_ms = argc > 4 ? strtoul(argv[4], NULL, 10) : ATTITUDE_DEFAULT_TAU_MS;
+
+    attitude_init(&att, tau_ms);
+    attitude_set_scale(&att, ACCEL_LSB_PER_G, GYRO_LSB_X10);
+    fputs("time_s,accel_x,accel_y,accel_z,giro_x,giro_y,giro_z\n", ref_in);
+    fputs(ATTITUDE_HEADER, out);
+
+    uint32_t samples = synthetic ? replay_synthetic() : replay_csv(in);
+
+    if (in) {
+        fclose(in);
+    }
+    fclose(ref_in);
+    fclose(out);
+    printf("%lu amostras, tau = %lu ms\n", (unsigned long)samples, (unsigned long)tau_ms);
+    return 0;
+}
@@ -0,0 +1,141 @@
+/*
+ Teste no PC da conversão inteira do CSV (inc/log_codec/csv_format.c).
+
+ Uso, a partir da raiz do repositório:
+   gcc -O2 -Wall -Ihost_test/sdk -I. -Iinc/log_codec host_test/csv_format.c \
+       inc/log_codec/csv_format.c -lm -o csv_format && ./csv_format
+
+ Confere as afirmações do cabeçalho csv_format.h contra o caminho antigo
+ em float com sprintf:
+  - na faixa padrão (±2 g, ±250 °/s) acel e giro são idênticos a
+    "%.2f" de (raw / 16384.0f) * 9.81 e raw / 131.0f para os 65536 raw;
+  - nas outras faixas, cada diferença é um valor em um empate ou a menos
+    de 3e-6 dele, em que a versão inteira dá o arredondamento exato e o
+    float não, e há no máximo 20 por faixa;
+  - csv_put_time é idêntico a "%.2f" de ms / 1000.0f para todo ms abaixo
+    de 2^25 e para ms aleatórios até 2^32;
+  - csv_put_time_us é idêntico a "%.6f" de us / 1000000.0.
+ Termina com erro se alguma verificação falhar.
+*/
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "csv_format.h"
+
+// Diferenças aceitas por faixa fora da padrão e distância máxima ao
+// empate, na unidade gravada (ver csv_format.h)
+#define MAX_NEAR_TIE 20
+#define NEAR_TIE_DIST 3e-6
+
+static uint32_t failures;
+
+static void put(char *dst, int32_t centi, bool negative) {
+    *csv_put_centi(dst, centi, negative) = '\0';
+}
+
+/*
+ Centésimos exatos num / den, com num e den inteiros, arredondados para o
+ mais próximo com empate para longe do zero. near_tie recebe a distância
+ do valor (na unidade gravada) ao empate mais próximo.
+*/
+static int64_t exact_centi(int64_t num, int64_t den, double *near_tie) {
+    int64_t a = num < 0 ? -num : num;
+    int64_t q = (2 * a + den) / (2 * den);
+    int64_t twice = 2 * (a % den); // Parte fracionária * 2 den
+    *near_tie = fabs((double)(twice - den) / (2.0 * den)) / 100.0;
+    return num < 0 ? -q : q;
+}
+
+// Compara um campo com o float antigo; retorna true quando houve diferença
+static bool check_field(const char *what, int16_t raw, int32_t centi, float old,
+                        int64_t num, int64_t den, bool default_range) {
+    char a[24], b[24];
+    put(a, centi, raw < 0);
+    sprintf(b, "%.2f", old);
+    if (strcmp(a, b) == 0)
+        return false;
+
+    double dist;
+    int64_t exact = exact_centi(num, den, &dist);
+    if (default_range || exact != centi || dist >= NEAR_TIE_DIST) {
+        if (failures++ < 20)
+            printf("%s raw %d: \"%s\", float \"%s\" (exato %lld centésimos)\n",
+                   what, raw, a, b, (long long)exact);
+    }
+    return true;
+}
+
+static void check_scales(void) {
+    static const uint16_t gyro_lsb_x10[] = {1310, 655, 328, 164};
+
+    for (uint8_t range = 0; range < 4; range++) {
+        uint8_t shift = range;
+        uint16_t lsb = gyro_lsb_x10[range];
+        float lsb_g = (float)(16384 >> shift);
+        float lsb_dps = lsb / 10.0f;
+        uint32_t accel_diff = 0, gyro_diff = 0;
+
+        for (int32_t r = -32768; r < 32768; r++) {
+            int16_t raw = r;
+            // m/s² * 100 = raw * 981 * 2^shift / 16384, °/s * 100 = raw * 1000 / lsb
+            accel_diff += check_field("acel", raw, accel_to_centi(raw, shift),
+                                      (float)((raw / lsb_g) * 9.81),
+                                      (int64_t)raw * 981 << shift, 16384, range == 0);
+            gyro_diff += check_field("giro", raw, gyro_to_centi(raw, lsb),
+                                     raw / lsb_dps, (int64_t)raw * 1000, lsb, range == 0);
+        }
+
+        printf("faixa %u: acel %u e giro %u valores diferentes do float\n", range,
+               accel_diff, gyro_diff);
+        if (accel_diff > MAX_NEAR_TIE || gyro_diff > MAX_NEAR_TIE) {
+            failures++;
+            printf("faixa %u: mais de %d diferenças\n", range, MAX_NEAR_TIE);
+        }
+    }
+}
+
+static bool check_time(uint32_t ms) {
+    char a[24], b[24];
+    *csv_put_time(a, ms) = '\0';
+    sprintf(b, "%.2f", ms / 1000.0f);
+    if (strcmp(a, b) == 0)
+        return true;
+    if (failures++ < 20)
+        printf("tempo %lu ms: \"%s\", float \"%s\"\n", (unsigned long)ms, a, b);
+    return false;
+}
+
+static bool check_time_us(uint64_t us) {
+    char a[32], b[32];
+    *csv_put_time_us(a, us) = '\0';
+    sprintf(b, "%.6f", us / 1000000.0);
+    if (strcmp(a, b) == 0)
+        return true;
+    if (failures++ < 20)
+        printf("tempo %llu us: \"%s\", double \"%s\"\n", (unsigned long long)us, a, b);
+    return false;
+}
+
+int main(void) {
+    uint64_t seed = 1;
+
+    check_scales();
+
+    for (uint32_t ms = 0; ms < (1u << 25); ms++)
+        check_time(ms);
+    for (int i = 0; i < 2000000; i++) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        check_time(seed >> 32);
+    }
+
+    for (uint64_t us = 0; us < 2000000; us++)
+        check_time_us(us);
+    for (int i = 0; i < 2000000; i++) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        check_time_us(seed >> (24 + (seed & 15))); // Até ~2^40 us (12 dias)
+    }
+
+    printf("%lu falhas\n", (unsigned long)failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,204 @@
+/*
+ Teste no PC da decimação em cascata (inc/dsp/decimator.c).
+
+ Uso, a partir da raiz do repositório:
+   gcc -O2 -Wall -Ihost_test/sdk -I. -Iinc/dsp host_test/decimator.c \
+       inc/dsp/decimator.c inc/dsp/filter_bank.c -lm -o decimator && ./decimator
+
+ Para cada fator de 2 a DECIM_MAX_FACTOR e para cascatas de 2 e 3
+ estágios (entre elas a "decim 5 5 4" do exemplo), confere que:
+  - cada estágio produz uma saída centrada em cada 'factor' amostras da
+    sua entrada, a partir da primeira, assim que a janela chega ao centro:
+    M entradas geram (M - 1 - taps / 2) / factor + 1 saídas; só nas
+    chamadas em que o anterior produziu, com a primeira no tempo da
+    primeira amostra e as outras espaçadas pelo fator acumulado;
+  - o tempo de cada saída é o da amostra central da janela: uma rampa sai
+    com o valor da rampa nesse tempo (ganho 1 em DC, fase linear);
+  - tons acima de STOP_EDGE vezes a frequência de Nyquist da saída, até a
+    de Nyquist da entrada, são atenuados pelo menos MIN_STOP_DB (o que
+    decimator.h promete), e qualquer tom acima da de Nyquist da saída
+    perde pelo menos MIN_ABOVE_NYQUIST_DB;
+  - tons até PASS_EDGE vezes a de Nyquist da saída perdem no máximo
+    MAX_PASS_DB.
+ A amplitude é medida com um seno em um eixo e o cosseno em outro, então
+ não depende da fase em que a saída amostra o tom. Termina com erro se
+ alguma verificação falhar.
+*/
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "decimator.h"
+
+#define AMPLITUDE 8000.0
+#define STOP_EDGE 1.7
+#define MIN_STOP_DB 30.0
+#define MIN_ABOVE_NYQUIST_DB 6.0
+#define PASS_EDGE 0.25
+#define MAX_PASS_DB 1.0
+
+// Entradas no teste de contagem (não é múltiplo de nenhum fator)
+#define COUNT_INPUTS 100003
+
+// Saídas descartadas (transitório) e medidas em cada tom
+#define SETTLE_OUTPUTS DECIM_HIST
+#define MEASURE_OUTPUTS 48
+
+// Tons por configuração, em passos geométricos
+#define TONES 1000
+
+static uint32_t failures;
+
+static const struct {
+    uint8_t count;
+    uint16_t factors[DECIM_MAX_STAGES];
+} configs[] = {
+    {1, {2}}, {1, {3}}, {1, {4}}, {1, {5}}, {1, {6}}, {1, {7}}, {1, {8}},
+    {2, {2, 2}}, {2, {8, 2}}, {2, {4, 3}}, {2, {6, 4}}, {2, {2, 5}}, {2, {3, 7}},
+    {3, {5, 5, 4}}, {3, {2, 2, 2}}, {3, {8, 8, 8}},
+};
+
+static void fail(const char *name, const char *fmt, ...) {
+    if (failures++ < 30) {
+        va_list args;
+        va_start(args, fmt);
+        printf("%s: ", name);
+        vprintf(fmt, args);
+        printf("\n");
+        va_end(args);
+    }
+}
+
+// Contagem de saídas, espaçamento e atraso de cada estágio com uma rampa
+static void check_counts(decim_chain_t *c, const char *name) {
+    uint32_t outputs[DECIM_MAX_STAGES] = {0};
+    uint32_t expected[DECIM_MAX_STAGES];
+    uint32_t last_time[DECIM_MAX_STAGES] = {0};
+    double worst_ramp = 0;
+
+    decim_chain_reset(c);
+    for (uint32_t t = 0; t < COUNT_INPUTS; t++) {
+        // Rampa de 0,25 contagem por ms em todos os eixos
+        int16_t v = (int16_t)(t / 4);
+        int16_t accel[3] = {v, v, v}, gyro[3] = {v, v, v};
+        uint8_t mask = decim_chain_push(c, t, accel, gyro);
+
+        if (mask & (mask + 1)) {
+            fail(name, "máscara 0x%02x com estágio sem o anterior (t = %lu)", mask, (unsigned long)t);
+        }
+        for (uint8_t i = 0; i < c->stages; i++) {
+            if (!(mask & (1u << i))) {
+                continue;
+            }
+            const decim_stage_t *s = &c->stage[i];
+            uint32_t step = decim_chain_total_factor(c, i);
+            if (outputs[i] == 0 && s->out_time != 0) {
+                fail(name, "estágio %u: primeira saída em %lu ms", i + 1, (unsigned long)s->out_time);
+            }
+            if (outputs[i] > 0 && s->out_time - last_time[i] != step) {
+                fail(name, "estágio %u: saídas espaçadas de %lu ms em vez de %lu", i + 1,
+                     (unsigned long)(s->out_time - last_time[i]), (unsigned long)step);
+            }
+            last_time[i] = s->out_time;
+
+            // Depois do transitório a saída é a rampa no tempo da saída
+            if (++outputs[i] > SETTLE_OUTPUTS) {
+                double err = fabs(s->out[0] - s->out_time / 4.0);
+                worst_ramp = err > worst_ramp ? err : worst_ramp;
+            }
+        }
+    }
+
+    uint32_t inputs = COUNT_INPUTS;
+    for (uint8_t i = 0; i < c->stages; i++) {
+        const decim_stage_t *s = &c->stage[i];
+        expected[i] = inputs > s->taps / 2u ? (inputs - 1 - s->taps / 2u) / s->factor + 1 : 0;
+        if (outputs[i] != expected[i]) {
+            fail(name, "estágio %u: %lu saídas em vez de %lu", i + 1, (unsigned long)outputs[i],
+                 (unsigned long)expected[i]);
+        }
+        inputs = expected[i];
+    }
+    // Meia contagem do arredondamento mais o passo de 1 contagem da rampa
+    if (worst_ramp > 1.5) {
+        fail(name, "rampa fora do tempo da saída: erro de %.1f contagens", worst_ramp);
+    }
+}
+
+// Ganho em dB na saída do último estágio para um tom de freq (ciclos por
+// amostra de entrada)
+static double tone_gain_db(decim_chain_t *c, double freq) {
+    uint8_t last = 1u << (c->stages - 1);
+    uint32_t outputs = 0;
+    double peak = 0;
+
+    decim_chain_reset(c);
+    for (uint32_t t = 0; outputs < SETTLE_OUTPUTS + MEASURE_OUTPUTS; t++) {
+        double phase = 2 * M_PI * freq * t;
+        int16_t accel[3] = {(int16_t)lround(AMPLITUDE * sin(phase)), (int16_t)lround(AMPLITUDE * cos(phase)), 0};
+        int16_t gyro[3] = {0, 0, 0};
+        if (decim_chain_push(c, t, accel, gyro) & last) {
+            const int16_t *out = c->stage[c->stages - 1].out;
+            if (++outputs > SETTLE_OUTPUTS) {
+                double amp = hypot(out[0], out[1]);
+                peak = amp > peak ? amp : peak;
+            }
+        }
+    }
+    return 20 * log10((peak + 0.5) / AMPLITUDE);
+}
+
+static void check_tones(decim_chain_t *c, const char *name) {
+    uint32_t total = decim_chain_total_factor(c, c->stages - 1);
+    double nyquist = 0.5 / total; // Nyquist da saída, em ciclos por amostra de entrada
+
+    // Menor atenuação em cada faixa e maior perda na banda passante
+    double stop_db = INFINITY, above_db = INFINITY, pass_db = 0;
+
+    // De 0,05 a total vezes a Nyquist da saída (a Nyquist da entrada)
+    for (uint32_t k = 0; k <= TONES; k++) {
+        double rel = 0.05 * pow(total / 0.05, (double)k / TONES);
+        double atten = -tone_gain_db(c, rel * nyquist);
+        if (rel >= STOP_EDGE) {
+            stop_db = fmin(stop_db, atten);
+            if (atten < MIN_STOP_DB) {
+                fail(name, "tom a %.2fx Nyquist atenuado só %.1f dB", rel, atten);
+            }
+        } else if (rel > 1.0) {
+            above_db = fmin(above_db, atten);
+            if (atten < MIN_ABOVE_NYQUIST_DB) {
+                fail(name, "tom a %.2fx Nyquist atenuado só %.1f dB", rel, atten);
+            }
+        } else if (rel <= PASS_EDGE) {
+            pass_db = fmax(pass_db, atten);
+            if (atten > MAX_PASS_DB) {
+                fail(name, "tom a %.2fx Nyquist perde %.1f dB na banda passante", rel, atten);
+            }
+        }
+    }
+
+    printf("%-7s (fator %3lu): perda até %.2fx %.2f dB, atenuação acima de 1x %.1f dB, "
+           "acima de %.1fx %.1f dB\n", name, (unsigned long)total, PASS_EDGE, pass_db, above_db,
+           STOP_EDGE, stop_db);
+}
+
+int main(void) {
+    static decim_chain_t chain;
+
+    for (uint8_t i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+        char name[16];
+        int n = 0;
+        for (uint8_t k = 0; k < configs[i].count; k++) {
+            n += snprintf(name + n, sizeof(name) - n, k ? "-%u" : "%u", configs[i].factors[k]);
+        }
+        if (!decim_chain_config(&chain, configs[i].factors, configs[i].count)) {
+            fail(name, "configuração recusada");
+            continue;
+        }
+        check_counts(&chain, name);
+        check_tones(&chain, name);
+    }
+
+    printf("%lu falhas\n", (unsigned long)failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,289 @@
+/*
+ Teste no PC da camada de buffer do ff_stdio (inc/FatFs_SPI/src/ff_stdio.c).
+
+ Uso, a partir da raiz do repositório:
+   gcc -O2 -Wall -Iinc/FatFs_SPI/include -Iinc/FatFs_SPI/ff15/source \
+       host_test/ff_stdio_bench.c inc/FatFs_SPI/src/ff_stdio.c \
+       inc/FatFs_SPI/src/f_util.c inc/FatFs_SPI/ff15/source/ff.c \
+       inc/FatFs_SPI/ff15/source/ffunicode.c \
+       inc/FatFs_SPI/ff15/source/ffsystem.c -o ff_stdio_bench && ./ff_stdio_bench
+
+ O FatFs é o mesmo do firmware, sobre um disco em RAM formatado com
+ f_mkfs. O programa:
+  - mede a vazão (bytes/s) de escritas de 1 e 16 bytes sem buffer
+    (FF_IONBF, cada chamada vai ao f_write) e com o buffer padrão;
+  - confere, contra um modelo do arquivo em memória, uma sequência
+    aleatória de escritas, leituras, fseek (SET/CUR/END), ftell, fflush,
+    fputc/fgetc, feof, filelength e trocas de modo de buffer, nos três
+    modos, e o conteúdo relido do cartão depois do fclose;
+  - confere que ff_fflush e o fim de linha em FF_IOLBF entregam os dados
+    ao FatFs (f_size e f_tell do FIL).
+ Termina com erro se alguma verificação falhar. A vazão no PC mede só o
+ custo de CPU das camadas; no cartão cada f_write também custa o SPI.
+*/
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ff.h"
+#include "diskio.h"
+#include "ff_stdio.h"
+
+#define DISK_SECTORS (16 * 2048) // 16 MB
+#define BENCH_BYTES (1024 * 1024)
+#define FILE_MAX (64 * 1024)     // Tamanho máximo do arquivo do teste aleatório
+#define RANDOM_OPS 200000
+
+static uint8_t *disk;
+static uint32_t failures;
+
+// Disco em RAM para o FatFs
+DSTATUS disk_initialize(BYTE pdrv) {
+    (void)pdrv;
+    if (!disk) disk = calloc(DISK_SECTORS, FF_MAX_SS);
+    return disk ? 0 : STA_NOINIT;
+}
+DSTATUS disk_status(BYTE pdrv) {
+    (void)pdrv;
+    return disk ? 0 : STA_NOINIT;
+}
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
+    (void)pdrv;
+    memcpy(buff, disk + sector * FF_MAX_SS, count * FF_MAX_SS);
+    return RES_OK;
+}
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
+    (void)pdrv;
+    memcpy(disk + sector * FF_MAX_SS, buff, count * FF_MAX_SS);
+    return RES_OK;
+}
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff) {
+    (void)pdrv;
+    switch (cmd) {
+        case GET_SECTOR_COUNT:
+            *(LBA_t *)buff = DISK_SECTORS;
+            return RES_OK;
+        case GET_SECTOR_SIZE:
+            *(WORD *)buff = FF_MAX_SS;
+            return RES_OK;
+        case GET_BLOCK_SIZE:
+            *(DWORD *)buff = 1;
+            return RES_OK;
+        default:
+            return RES_OK;
+    }
+}
+DWORD get_fattime(void) {
+    return ((DWORD)(2024 - 1980) << 25) | (1 << 21) | (1 << 16);
+}
+
+// my_debug.c usa instruções do M0+; aqui as falhas só são impressas
+void my_printf(const char *pcFormat, ...) {
+    va_list xArgs;
+    va_start(xArgs, pcFormat);
+    vprintf(pcFormat, xArgs);
+    va_end(xArgs);
+}
+void my_assert_func(const char *file, int line, const char *func,
+                    const char *pred) {
+    printf("assertion \"%s\" failed: file \"%s\", line %d, function: %s\n",
+           pred, file, line, func);
+    abort();
+}
+
+static double now_s(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+#define CHECK(cond, ...)                          \
+    do {                                          \
+        if (!(cond)) {                            \
+            if (failures++ < 20) {                \
+                printf("falha (linha %d): ", __LINE__); \
+                printf(__VA_ARGS__);              \
+                printf("\n");                     \
+            }                                     \
+        }                                         \
+    } while (0)
+
+static void bench(void) {
+    static const size_t record_sizes[] = {1, 16};
+    static const int modes[] = {FF_IONBF, FF_IOFBF};
+    const char rec[16] = "0123456789abcde";
+
+    for (size_t m = 0; m < 2; m++) {
+        for (size_t r = 0; r < 2; r++) {
+            FF_FILE *fp = ff_fopen("bench.bin", "w");
+            CHECK(fp, "ff_fopen bench.bin");
+            if (!fp) return;
+            ff_setvbuf(fp, NULL, modes[m], FF_IONBF == modes[m] ? 0 : ffconfigSTDIO_BUFFER_SIZE);
+
+            double start = now_s();
+            for (size_t n = 0; n < BENCH_BYTES; n += record_sizes[r])
+                ff_fwrite(rec, 1, record_sizes[r], fp);
+            ff_fclose(fp);
+            double elapsed = now_s() - start;
+
+            FF_Stat_t st;
+            CHECK(0 == ff_stat("bench.bin", &st) && BENCH_BYTES == st.st_size,
+                  "tamanho do bench.bin");
+            printf("%s %2u B: %10.0f bytes/s\n",
+                   FF_IONBF == modes[m] ? "sem buffer" : "com buffer",
+                   (unsigned)record_sizes[r], BENCH_BYTES / elapsed);
+        }
+    }
+    ff_remove("bench.bin");
+}
+
+// Modelo do arquivo: conteúdo, tamanho e posição lógica
+static uint8_t model[FILE_MAX];
+static size_t model_size, model_pos;
+
+static uint32_t rng_state = 12345;
+static uint32_t rnd(uint32_t n) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return (rng_state >> 8) % n;
+}
+
+static void check_position(FF_FILE *fp, const char *op) {
+    CHECK(ff_ftell(fp) == (long)model_pos, "%s: ftell %ld, esperado %zu", op,
+          ff_ftell(fp), model_pos);
+    CHECK(ff_filelength(fp) == (long)model_size,
+          "%s: filelength %ld, esperado %zu", op, ff_filelength(fp), model_size);
+    CHECK(ff_feof(fp) == (model_pos >= model_size), "%s: feof", op);
+}
+
+static void random_ops(void) {
+    static char buffers[3][700];
+    uint8_t data[600], got[600];
+    FF_FILE *fp = ff_fopen("rnd.bin", "w+");
+    CHECK(fp, "ff_fopen rnd.bin");
+    if (!fp) return;
+    model_size = model_pos = 0;
+
+    for (uint32_t i = 0; i < RANDOM_OPS && failures == 0; i++) {
+        switch (rnd(10)) {
+            case 0:
+            case 1: {  // Escrita, sem passar do tamanho máximo
+                size_t n = 1 + rnd(rnd(4) ? 20 : sizeof data);
+                if (model_pos + n > FILE_MAX) n = FILE_MAX - model_pos;
+                if (!n) break;
+                for (size_t k = 0; k < n; k++) data[k] = rnd(256);
+                if (rnd(8) == 0) data[rnd(n)] = '\n';
+                size_t w = ff_fwrite(data, 1, n, fp);
+                CHECK(w == n, "fwrite %zu -> %zu", n, w);
+                memcpy(model + model_pos, data, n);
+                model_pos += n;
+                if (model_pos > model_size) model_size = model_pos;
+                check_position(fp, "fwrite");
+                break;
+            }
+            case 2:
+            case 3: {  // Leitura, que pode passar do fim
+                size_t n = 1 + rnd(rnd(4) ? 20 : sizeof got);
+                size_t expect = model_size - model_pos < n ? model_size - model_pos : n;
+                size_t r = ff_fread(got, 1, n, fp);
+                CHECK(r == expect, "fread %zu -> %zu, esperado %zu", n, r, expect);
+                CHECK(0 == memcmp(got, model + model_pos, expect),
+                      "fread: conteúdo na posição %zu", model_pos);
+                model_pos += expect;
+                check_position(fp, "fread");
+                break;
+            }
+            case 4: {  // fputc / fgetc
+                if (rnd(2) && model_pos < FILE_MAX) {
+                    int c = rnd(256);
+                    CHECK(ff_fputc(c, fp) == c, "fputc");
+                    model[model_pos++] = c;
+                    if (model_pos > model_size) model_size = model_pos;
+                } else {
+                    int c = ff_fgetc(fp);
+                    int expect = model_pos < model_size ? model[model_pos] : FF_EOF;
+                    CHECK(c == expect, "fgetc %d, esperado %d", c, expect);
+                    if (model_pos < model_size) model_pos++;
+                }
+                check_position(fp, "fputc/fgetc");
+                break;
+            }
+            case 5:
+            case 6: {  // fseek dentro do arquivo, perto da posição atual
+                long target = rnd(3) ? (long)model_pos - 40 + (long)rnd(80)
+                                     : (long)rnd(model_size + 1);
+                if (target < 0) target = 0;
+                if (target > (long)model_size) target = model_size;
+                int whence = rnd(3);
+                int offset = FF_SEEK_SET == whence   ? target
+                             : FF_SEEK_CUR == whence ? target - (long)model_pos
+                                                     : target - (long)model_size;
+                CHECK(0 == ff_fseek(fp, offset, whence), "fseek(%d, %d)", offset, whence);
+                model_pos = target;
+                check_position(fp, "fseek");
+                break;
+            }
+            case 7: {  // fflush entrega tudo ao FatFs
+                CHECK(0 == ff_fflush(fp), "fflush");
+                CHECK(f_size(&fp->fil) == model_size, "fflush: f_size %lu, esperado %zu",
+                      (unsigned long)f_size(&fp->fil), model_size);
+                CHECK(f_tell(&fp->fil) == model_pos, "fflush: f_tell %lu, esperado %zu",
+                      (unsigned long)f_tell(&fp->fil), model_pos);
+                check_position(fp, "fflush");
+                break;
+            }
+            case 8: {  // Troca de modo e de buffer com dados pendentes
+                int mode = rnd(3);
+                size_t size = 0;
+                char *buf = NULL;
+                if (FF_IONBF != mode) {
+                    size = 1 + rnd(3) * 300 + rnd(2) * 99;
+                    if (rnd(2)) buf = buffers[rnd(3)];
+                }
+                // Um buffer da lista pode ser o atual: só o modo muda
+                if (buf && (uint8_t *)buf == fp->pucBuffer) buf = NULL, size = 0;
+                CHECK(0 == ff_setvbuf(fp, buf, mode, size), "setvbuf(%d, %zu)", mode, size);
+                check_position(fp, "setvbuf");
+                break;
+            }
+            default: {  // Linha terminada em FF_IOLBF vai direto ao FatFs
+                if (FF_IOLBF != fp->iBufferMode || model_pos + 3 > FILE_MAX) break;
+                CHECK(3 == ff_fwrite("ok\n", 1, 3, fp), "fwrite de linha");
+                memcpy(model + model_pos, "ok\n", 3);
+                model_pos += 3;
+                if (model_pos > model_size) model_size = model_pos;
+                CHECK(f_tell(&fp->fil) == model_pos, "linha não entregue ao FatFs");
+                break;
+            }
+        }
+    }
+    CHECK(0 == ff_fclose(fp), "fclose");
+
+    // Conteúdo no disco, relido sem a camada de buffer
+    FIL fil;
+    UINT br = 0;
+    static uint8_t disk_copy[FILE_MAX];
+    CHECK(FR_OK == f_open(&fil, "rnd.bin", FA_READ), "f_open rnd.bin");
+    CHECK(FR_OK == f_read(&fil, disk_copy, sizeof disk_copy, &br), "f_read");
+    f_close(&fil);
+    CHECK(br == model_size && 0 == memcmp(disk_copy, model, br),
+          "conteúdo no disco: %u bytes, esperado %zu", br, model_size);
+    ff_remove("rnd.bin");
+}
+
+int main(void) {
+    static FATFS fs;
+    static BYTE work[FF_MAX_SS];
+    MKFS_PARM opt = {FM_ANY, 0, 0, 0, 0};
+
+    CHECK(FR_OK == f_mkfs("", &opt, work, sizeof work), "f_mkfs");
+    CHECK(FR_OK == f_mount(&fs, "", 1), "f_mount");
+    if (failures) return 1;
+
+    bench();
+    random_ops();
+
+    printf("%d operações aleatórias, %lu falhas\n", RANDOM_OPS, (unsigned long)failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,14 @@
+// Substituto mínimo do Pico SDK: clock do sistema fixo em 125 MHz
+#ifndef HOST_HARDWARE_CLOCKS_H
+#define HOST_HARDWARE_CLOCKS_H
+
+#include <stdint.h>
+
+enum clock_index { clk_sys = 5 };
+
+static inline uint32_t clock_get_hz(enum clock_index clk) {
+  (void)clk;
+  return 125000000;
+}
+
+#endif
@@ -0,0 +1,55 @@
+// Substituto mínimo do Pico SDK: não há canal livre, então o driver usa o
+// envio bloqueante. Um teste pode oferecer um canal em host_dma_channel;
+// a transferência iniciada fica em host_dma_read_addr/host_dma_count para
+// o teste executá-la e sinalizar o fim em host_dma_irq1.
+#ifndef HOST_HARDWARE_DMA_H
+#define HOST_HARDWARE_DMA_H
+
+#include "pico/stdlib.h"
+
+typedef struct {
+  uint32_t ctrl;
+} dma_channel_config;
+
+enum { DREQ_I2C0_TX = 32, DREQ_I2C1_TX = 34 };
+#define DMA_SIZE_16 1
+#define DMA_IRQ_1 12
+
+__attribute__((weak)) int host_dma_channel = -1;
+__attribute__((weak)) const volatile void *host_dma_read_addr;
+__attribute__((weak)) uint32_t host_dma_count;
+__attribute__((weak)) volatile bool host_dma_irq1;
+
+static inline int dma_claim_unused_channel(bool required) {
+  (void)required;
+  return host_dma_channel;
+}
+
+static inline void dma_channel_unclaim(uint chan) { (void)chan; }
+
+static inline dma_channel_config dma_channel_get_default_config(uint chan) {
+  (void)chan;
+  return (dma_channel_config){0};
+}
+
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c, int size) { (void)c; (void)size; }
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr) { (void)c; (void)incr; }
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr) { (void)c; (void)incr; }
+static inline void channel_config_set_dreq(dma_channel_config *c, uint dreq) { (void)c; (void)dreq; }
+
+static inline void dma_channel_configure(uint chan, const dma_channel_config *c, volatile void *write_addr,
+    const volatile void *read_addr, uint count, bool trigger) {
+  (void)chan; (void)c; (void)write_addr; (void)read_addr; (void)count; (void)trigger;
+}
+
+static inline void dma_channel_set_irq1_enabled(uint chan, bool enabled) { (void)chan; (void)enabled; }
+static inline bool dma_channel_get_irq1_status(uint chan) { (void)chan; return host_dma_irq1; }
+static inline void dma_channel_acknowledge_irq1(uint chan) { (void)chan; host_dma_irq1 = false; }
+
+static inline void dma_channel_transfer_from_buffer_now(uint chan, const volatile void *read_addr, uint32_t count) {
+  (void)chan;
+  host_dma_read_addr = read_addr;
+  host_dma_count = count;
+}
+
+#endif
@@ -0,0 +1,51 @@
+// Substituto mínimo do Pico SDK: as escritas no barramento são descartadas,
+// ou entregues a host_i2c_write quando um teste a define, e as leituras
+// devolvem zeros. Os registradores ficam em host_i2c_hw, o mesmo em todas
+// as unidades de compilação (definições fracas).
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+typedef struct i2c_inst i2c_inst_t;
+
+typedef struct {
+  volatile uint32_t tar, data_cmd, enable, status, raw_intr_stat, clr_tx_abrt, dma_cr;
+} i2c_hw_t;
+
+#define I2C_IC_DATA_CMD_STOP_BITS 0x200
+#define I2C_IC_STATUS_TFE_BITS 0x4
+#define I2C_IC_STATUS_MST_ACTIVITY_BITS 0x20
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x40
+#define I2C_IC_DMA_CR_TDMAE_BITS 0x2
+
+typedef void (*host_i2c_write_fn)(uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+__attribute__((weak)) host_i2c_write_fn host_i2c_write;
+__attribute__((weak)) i2c_hw_t host_i2c_hw = {.status = I2C_IC_STATUS_TFE_BITS};
+
+static inline int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+  (void)i2c;
+  if (host_i2c_write)
+    host_i2c_write(addr, src, len, nostop);
+  return (int)len;
+}
+
+static inline int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+  (void)i2c; (void)addr; (void)nostop;
+  memset(dst, 0, len);
+  return (int)len;
+}
+
+static inline i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) {
+  (void)i2c;
+  return &host_i2c_hw;
+}
+
+static inline uint i2c_hw_index(i2c_inst_t *i2c) {
+  (void)i2c;
+  return 1;
+}
+
+#endif
@@ -0,0 +1,21 @@
+// Substituto mínimo do Pico SDK: as interrupções nunca disparam sozinhas;
+// o tratador registrado fica em host_irq_handler para um teste chamá-lo
+#ifndef HOST_HARDWARE_IRQ_H
+#define HOST_HARDWARE_IRQ_H
+
+#include "pico/stdlib.h"
+
+typedef void (*irq_handler_t)(void);
+
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+__attribute__((weak)) irq_handler_t host_irq_handler;
+
+static inline void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order) {
+  (void)num; (void)order;
+  host_irq_handler = handler;
+}
+
+static inline void irq_set_enabled(uint num, bool enabled) { (void)num; (void)enabled; }
+
+#endif
@@ -0,0 +1,15 @@
+// Substituto mínimo do Pico SDK: o SysTick fica parado, então as medidas
+// de inc/cycle_counter dão 0 no PC
+#ifndef HOST_HARDWARE_STRUCTS_SYSTICK_H
+#define HOST_HARDWARE_STRUCTS_SYSTICK_H
+
+#include <stdint.h>
+
+typedef struct {
+  volatile uint32_t csr, rvr, cvr, calib;
+} systick_hw_t;
+
+static systick_hw_t host_systick_hw __attribute__((unused));
+#define systick_hw (&host_systick_hw)
+
+#endif
@@ -0,0 +1,25 @@
+// Substituto mínimo do Pico SDK para compilar no PC os módulos usados por
+// host_test e host_tools (display, MPU6050, codecs). Só o que eles usam.
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+typedef unsigned int uint;
+
+static inline uint64_t time_us_64(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t)t.tv_sec * 1000000u + t.tv_nsec / 1000;
+}
+
+static inline void tight_loop_contents(void) {}
+
+static inline void sleep_ms(uint32_t ms) {
+  (void)ms;
+}
+
+#endif
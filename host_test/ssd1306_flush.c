@@ -0,0 +1,376 @@
+/*
+ Teste no PC do envio ao display (inc/display/ssd1306.c) contra um modelo
+ da GDDRAM do SSD1306.
+
+ Uso, a partir da raiz do repositório:
+   gcc -O2 -Wall -Ihost_test/sdk -Iinc/display host_test/ssd1306_flush.c \
+       inc/display/ssd1306.c -o ssd1306_flush && ./ssd1306_flush
+
+ O modelo interpreta o que chega ao barramento como o controlador: byte
+ de controle no início de cada transação (Co e D/C), comandos com seus
+ argumentos, janela SET_COL_ADDR/SET_PAGE_ADDR e escrita de dados com o
+ avanço do modo vertical. Ele recebe as transações do envio bloqueante
+ (i2c_write_blocking) e as palavras de IC_DATA_CMD do envio por DMA,
+ separadas nos bits de STOP, e confere que as palavras só têm dados e
+ STOP, que a última fecha a transação e que cabem no buffer do DMA.
+
+ Em FRAMES quadros com alterações aleatórias (pixels, textos, retângulos,
+ linhas, blocos de bytes, tela cheia ou nada) cada envio usa um caminho:
+  - ssd1306_send_data (bloqueante);
+  - ssd1306_flush, com o ram_buffer redesenhado antes de o DMA terminar:
+    o display deve mostrar o quadro do momento do envio;
+  - ssd1306_flush com outro pedido durante o DMA e depois dele, com a
+    FIFO do I2C ainda ocupada: o segundo fica pendente e sai em
+    ssd1306_flush_poll;
+  - ssd1306_flush interrompido por falta de ACK no meio: o display fica
+    com parte do quadro e o próximo envio tem de ser completo.
+ Depois de cada envio concluído a GDDRAM do modelo tem de ser igual ao
+ quadro enviado. Termina com erro se algo falhar.
+*/
+#include <stdio.h>
+#include <string.h>
+
+#include "ssd1306.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+#define FRAMES 2000
+
+// Canal oferecido ao driver pelo hardware/dma.h de host_test/sdk
+#define DMA_CHANNEL 3
+
+enum { PATH_BLOCKING, PATH_DMA, PATH_PENDING, PATH_NACK, PATHS };
+static const char *path_name[PATHS] = {"bloqueante", "DMA", "DMA pendente", "DMA sem ACK"};
+
+static ssd1306_t ssd;
+static uint32_t seed = 1;
+static uint32_t failures;
+static uint32_t done_calls;
+
+static uint32_t next_random(void) {
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 8;
+}
+
+static void fail(const char *msg, uint32_t frame) {
+  if (failures++ < 20)
+    printf("quadro %lu: %s\n", (unsigned long)frame, msg);
+}
+
+// Modelo do controlador
+static struct {
+  uint8_t ram[SSD1306_MAX_PAGES][WIDTH];
+  uint8_t mode; // SET_MEM_ADDR: 0 horizontal, 1 vertical, 2 página (após reset)
+  uint8_t col0, col1, page0, page1, col, page;
+  uint8_t cmd[3], cmd_len, cmd_need;
+  uint32_t errors;
+} panel;
+
+// Argumentos de cada comando usado pelo driver
+static int8_t command_args(uint8_t c) {
+  switch (c) {
+  case SET_MEM_ADDR: case SET_CONTRAST: case SET_MUX_RATIO: case SET_DISP_OFFSET: case SET_COM_PIN_CFG:
+  case SET_DISP_CLK_DIV: case SET_PRECHARGE: case SET_VCOM_DESEL: case SET_CHARGE_PUMP:
+    return 1;
+  case SET_COL_ADDR: case SET_PAGE_ADDR:
+    return 2;
+  case SSD1306_NOP: case SET_DISP: case SET_DISP | 1: case SET_SEG_REMAP: case SET_SEG_REMAP | 1: case SET_COM_OUT_DIR:
+  case SET_COM_OUT_DIR | 8: case SET_ENTIRE_ON: case SET_ENTIRE_ON | 1: case SET_NORM_INV: case SET_NORM_INV | 1:
+    return 0;
+  default:
+    return (c & 0xC0) == SET_DISP_START_LINE ? 0 : -1;
+  }
+}
+
+static void panel_command(uint8_t byte) {
+  if (panel.cmd_len == 0) {
+    int8_t args = command_args(byte);
+    if (args < 0) {
+      panel.errors++;
+      return;
+    }
+    panel.cmd_need = args;
+  }
+  panel.cmd[panel.cmd_len++] = byte;
+  if (panel.cmd_len <= panel.cmd_need)
+    return;
+
+  panel.cmd_len = 0;
+  switch (panel.cmd[0]) {
+  case SET_MEM_ADDR:
+    panel.mode = panel.cmd[1] & 3;
+    break;
+  case SET_COL_ADDR:
+    panel.col0 = panel.cmd[1] & 0x7F;
+    panel.col1 = panel.cmd[2] & 0x7F;
+    panel.col = panel.col0;
+    break;
+  case SET_PAGE_ADDR:
+    panel.page0 = panel.cmd[1] & 7;
+    panel.page1 = panel.cmd[2] & 7;
+    panel.page = panel.page0;
+    break;
+  }
+}
+
+// Escrita de dados com o avanço do modo vertical (o único que o driver usa)
+static void panel_data(uint8_t byte) {
+  if (panel.mode != 1) {
+    panel.errors++;
+    return;
+  }
+  panel.ram[panel.page][panel.col] = byte;
+  if (panel.page == panel.page1 || panel.page == SSD1306_MAX_PAGES - 1) {
+    panel.page = panel.page0;
+    panel.col = panel.col == panel.col1 || panel.col == WIDTH - 1 ? panel.col0 : panel.col + 1;
+  } else {
+    panel.page++;
+  }
+}
+
+// Uma transação: bytes de controle com Co = 1 valem para um byte; com
+// Co = 0 o resto da transação é de comandos (D/C = 0) ou dados (D/C = 1)
+static void panel_transaction(uint8_t addr, const uint8_t *src, size_t len) {
+  if (addr != DISP_ADDR) {
+    panel.errors++;
+    return;
+  }
+  size_t i = 0;
+  while (i < len) {
+    uint8_t control = src[i++];
+    if (control & 0x3F) {
+      panel.errors++;
+      return;
+    }
+    bool data = control & 0x40;
+    size_t end = (control & 0x80) ? (i < len ? i + 1 : i) : len;
+    for (; i < end; i++) {
+      if (data)
+        panel_data(src[i]);
+      else
+        panel_command(src[i]);
+    }
+  }
+}
+
+// Envio bloqueante: cada i2c_write_blocking do driver é uma transação
+static void on_i2c_write(uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+  if (nostop || ssd.flush_busy)
+    panel.errors++;
+  panel_transaction(addr, src, len);
+}
+
+static void on_flush_done(void) {
+  done_calls++;
+}
+
+// Executa as palavras do DMA iniciado por ssd1306_flush até 'limit'
+// palavras. Retorna false se alguma palavra não for dado + STOP.
+static bool run_dma(uint32_t limit, uint32_t frame) {
+  const volatile uint16_t *words = host_dma_read_addr;
+  uint8_t bytes[(WIDTH * SSD1306_MAX_PAGES) + 16];
+  size_t len = 0;
+  bool ok = true;
+
+  if (!words) {
+    fail("nenhum DMA iniciado", frame);
+    return false;
+  }
+  if (words != ssd.dma_buffer || host_dma_count != ssd.dma_words || host_dma_count == 0)
+    fail("DMA iniciado com buffer ou tamanho errado", frame);
+  if (host_dma_count > ssd.bufsize - 1 + ssd.pages * 8 + 2)
+    fail("palavras além do buffer do DMA", frame);
+  if (host_i2c_hw.tar != DISP_ADDR || !(host_i2c_hw.dma_cr & I2C_IC_DMA_CR_TDMAE_BITS))
+    fail("I2C sem o endereço do display ou sem DMA de transmissão", frame);
+  if (!(host_dma_count > 0 && (words[host_dma_count - 1] & I2C_IC_DATA_CMD_STOP_BITS)))
+    fail("última palavra sem STOP", frame);
+
+  for (uint32_t i = 0; i < host_dma_count && i < limit; i++) {
+    if (words[i] & ~(0xFF | I2C_IC_DATA_CMD_STOP_BITS))
+      ok = false;
+    if (len < sizeof(bytes))
+      bytes[len++] = words[i] & 0xFF;
+    if (words[i] & I2C_IC_DATA_CMD_STOP_BITS) {
+      panel_transaction(host_i2c_hw.tar, bytes, len);
+      len = 0;
+    }
+  }
+  // Transação interrompida: os bytes já recebidos ficam na GDDRAM
+  if (len)
+    panel_transaction(host_i2c_hw.tar, bytes, len);
+
+  if (!ok)
+    fail("palavra de IC_DATA_CMD com bits além de dados e STOP", frame);
+  host_dma_read_addr = NULL;
+  return ok;
+}
+
+// Fim do DMA: a interrupção libera o driver
+static void finish_dma(uint32_t frame) {
+  uint32_t calls = done_calls;
+  host_dma_irq1 = true;
+  host_irq_handler();
+  if (ssd.flush_busy || done_calls != calls + 1)
+    fail("interrupção do DMA não concluiu o envio", frame);
+}
+
+static void check_panel(const uint8_t *frame_buf, uint32_t frame, uint8_t path) {
+  for (uint8_t x = 0; x < ssd.width; x++) {
+    for (uint8_t p = 0; p < ssd.pages; p++) {
+      if (panel.ram[p][x] != frame_buf[1 + x * ssd.pages + p]) {
+        char msg[96];
+        snprintf(msg, sizeof(msg), "envio %s: coluna %u, página %u diferente no display", path_name[path], x, p);
+        fail(msg, frame);
+        return;
+      }
+    }
+  }
+  if (panel.errors) {
+    fail("transação ou comando inválido no barramento", frame);
+    panel.errors = 0;
+  }
+}
+
+// Alteração aleatória no ram_buffer
+static void random_edit(void) {
+  uint8_t x = next_random() % WIDTH, y = next_random() % HEIGHT;
+
+  switch (next_random() % 8) {
+  case 0:
+    for (uint8_t k = next_random() % 6 + 1; k > 0; k--)
+      ssd1306_pixel(&ssd, next_random() % WIDTH, next_random() % HEIGHT, next_random() & 1);
+    break;
+  case 1: {
+    char text[12];
+    snprintf(text, sizeof(text), "QTND: %lu", (unsigned long)(next_random() % 100000));
+    ssd1306_draw_string(&ssd, text, x % (WIDTH - 8), y % (HEIGHT - 8));
+    break;
+  }
+  case 2:
+    ssd1306_rect(&ssd, y % 48, x % 100, 2 + next_random() % 28, 2 + next_random() % 16, next_random() & 1,
+        next_random() & 1);
+    break;
+  case 3:
+    ssd1306_vline(&ssd, x, y, next_random() % HEIGHT, next_random() & 1);
+    break;
+  case 4: {
+    // Bloco de bytes aleatórios: várias páginas e colunas de uma vez
+    uint8_t w = 1 + next_random() % 40, p0 = next_random() % 8, p1 = p0 + next_random() % (8 - p0);
+    for (uint8_t c = x; c < WIDTH && c < x + w; c++)
+      for (uint8_t p = p0; p <= p1; p++)
+        ssd.ram_buffer[1 + c * ssd.pages + p] = next_random();
+    break;
+  }
+  case 5:
+    ssd1306_fill(&ssd, next_random() & 1);
+    break;
+  case 6:
+    ssd1306_line(&ssd, x, y, next_random() % WIDTH, next_random() % HEIGHT, true);
+    break;
+  default:
+    break; // Quadro sem mudança
+  }
+}
+
+int main(void) {
+  static uint8_t sent[WIDTH * SSD1306_MAX_PAGES + 1];
+  uint32_t paths[PATHS] = {0};
+
+  // Conteúdo da GDDRAM depois de ligar é indefinido
+  for (uint8_t p = 0; p < SSD1306_MAX_PAGES; p++)
+    for (uint8_t x = 0; x < WIDTH; x++)
+      panel.ram[p][x] = next_random();
+  panel.mode = 2;
+
+  host_i2c_write = on_i2c_write;
+  ssd1306_setup(&ssd, WIDTH, HEIGHT, false, DISP_ADDR, NULL);
+  host_dma_channel = DMA_CHANNEL;
+  if (!ssd1306_dma_init(&ssd, on_flush_done) || !host_irq_handler) {
+    printf("ssd1306_dma_init não preparou o DMA\n");
+    return 1;
+  }
+  ssd1306_config(&ssd);
+
+  for (uint32_t frame = 0; frame < FRAMES; frame++) {
+    random_edit();
+    if (next_random() % 50 == 0)
+      ssd1306_invalidate(&ssd);
+
+    uint8_t path = next_random() % PATHS;
+    paths[path]++;
+    memcpy(sent, ssd.ram_buffer, ssd.bufsize);
+
+    switch (path) {
+    case PATH_BLOCKING:
+      ssd1306_send_data(&ssd);
+      check_panel(sent, frame, path);
+      break;
+
+    case PATH_DMA:
+    case PATH_PENDING:
+      if (!ssd1306_flush(&ssd))
+        fail("ssd1306_flush não iniciou com o barramento livre", frame);
+      if (!host_dma_read_addr) {
+        // Nada mudou: nenhuma transferência
+        check_panel(sent, frame, path);
+        break;
+      }
+      // O quadro seguinte é desenhado com o DMA em andamento
+      random_edit();
+      if (path == PATH_PENDING && (ssd1306_flush(&ssd) || !ssd.flush_pending))
+        fail("ssd1306_flush durante o DMA não ficou pendente", frame);
+      run_dma(UINT32_MAX, frame);
+      finish_dma(frame);
+      check_panel(sent, frame, path);
+
+      if (path == PATH_PENDING) {
+        // O DMA terminou, mas a FIFO do I2C ainda está enviando
+        host_i2c_hw.status = I2C_IC_STATUS_MST_ACTIVITY_BITS;
+        if (ssd1306_flush(&ssd) || !ssd.flush_pending)
+          fail("ssd1306_flush com a FIFO do I2C ocupada não ficou pendente", frame);
+        ssd1306_flush_poll(&ssd);
+        host_i2c_hw.status = I2C_IC_STATUS_TFE_BITS;
+
+        memcpy(sent, ssd.ram_buffer, ssd.bufsize);
+        ssd1306_flush_poll(&ssd);
+        if (ssd.flush_pending)
+          fail("ssd1306_flush_poll não enviou o quadro pendente", frame);
+        if (host_dma_read_addr) {
+          run_dma(UINT32_MAX, frame);
+          finish_dma(frame);
+        }
+        check_panel(sent, frame, path);
+      }
+      break;
+
+    case PATH_NACK:
+      ssd1306_flush(&ssd);
+      if (!host_dma_read_addr)
+        break;
+      // O display deixa de responder no meio: a FIFO é descartada
+      run_dma(next_random() % ssd.dma_words, frame);
+      finish_dma(frame);
+      host_i2c_hw.raw_intr_stat |= I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+      if (ssd1306_flush_busy(&ssd) || ssd.shadow_valid)
+        fail("falta de ACK não invalidou o shadow", frame);
+      host_i2c_hw.raw_intr_stat &= ~I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+
+      // O próximo envio (pelo DMA) tem de repor a tela inteira
+      memcpy(sent, ssd.ram_buffer, ssd.bufsize);
+      ssd1306_flush(&ssd);
+      run_dma(UINT32_MAX, frame);
+      finish_dma(frame);
+      check_panel(sent, frame, path);
+      break;
+    }
+
+    if (ssd.flush_busy || ssd.flush_pending)
+      fail("envio ainda em andamento no fim do quadro", frame);
+  }
+
+  printf("%d quadros: %lu bloqueantes, %lu por DMA, %lu com pendente, %lu sem ACK; %lu bytes de dados\n",
+      FRAMES, (unsigned long)paths[PATH_BLOCKING], (unsigned long)paths[PATH_DMA],
+      (unsigned long)paths[PATH_PENDING], (unsigned long)paths[PATH_NACK], (unsigned long)ssd.bytes_sent);
+  printf("%lu falhas\n", (unsigned long)failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+/*
+ Teste no PC do desenho no buffer do display (inc/display/ssd1306.c).
+
+ Uso, a partir da raiz do repositório:
+   gcc -O2 -Wall -Ihost_test/sdk -Iinc/display host_test/ssd1306_render.c \
+       inc/display/ssd1306.c -o ssd1306_render && ./ssd1306_render
+
+ As funções ref_* são as versões originais, pixel a pixel, de
+ ssd1306_fill e ssd1306_draw_char. O programa confere que as versões
+ atuais produzem o mesmo buffer, para todo caractere em toda posição com o
+ caractere inteiro na tela e sobre conteúdo aleatório, e mede o desenho do
+ menu de ssd1306_bench com as duas. Termina com erro se algum buffer
+ diferir. host_test/sdk tem só o necessário do Pico SDK para compilar o
+ driver; o envio ao display é descartado.
+*/
+#include <stdio.h>
+#include <string.h>
+
+#include "ssd1306.h"
+#include "font.h"
+
+// Desenhos do menu medidos
+#define RENDERS 20000
+
+static void ref_fill(ssd1306_t *ssd, bool value) {
+  for (uint8_t y = 0; y < ssd->height; ++y) {
+    for (uint8_t x = 0; x < ssd->width; ++x) {
+      ssd1306_pixel(ssd, x, y, value);
+    }
+  }
+}
+
+static void ref_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y) {
+  uint16_t index = 0;
+
+  if (c >= ' ' && c <= '~')
+    index = (c - ' ') * 8;
+
+  for (uint8_t i = 0; i < 8; ++i) {
+    uint8_t line = font[index + i];
+    for (uint8_t j = 0; j < 8; ++j) {
+      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j));
+    }
+  }
+}
+
+// Mesma quebra de linha de ssd1306_draw_string
+static void ref_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y) {
+  while (*str) {
+    ref_draw_char(ssd, *str++, x, y);
+    x += 8;
+    if (x + 8 >= ssd->width) {
+      x = 0;
+      y += 8;
+    }
+    if (y + 8 >= ssd->height)
+      break;
+  }
+}
+
+static void draw_menu(ssd1306_t *ssd) {
+  ssd1306_fill(ssd, false);
+  ssd1306_draw_string(ssd, "SD: MONTADO", 5, 20);
+  ssd1306_draw_string(ssd, "QTND: 12345", 5, 30);
+  ssd1306_draw_string(ssd, "ARQUIVO: 07", 5, 41);
+}
+
+static void ref_draw_menu(ssd1306_t *ssd) {
+  ref_fill(ssd, false);
+  ref_draw_string(ssd, "SD: MONTADO", 5, 20);
+  ref_draw_string(ssd, "QTND: 12345", 5, 30);
+  ref_draw_string(ssd, "ARQUIVO: 07", 5, 41);
+}
+
+// Mesmo conteúdo pseudoaleatório nos dois buffers
+static void randomize(ssd1306_t *a, ssd1306_t *b, uint32_t *seed) {
+  for (uint16_t i = 1; i < a->bufsize; ++i) {
+    *seed = *seed * 1103515245u + 12345u;
+    a->ram_buffer[i] = b->ram_buffer[i] = *seed >> 16;
+  }
+}
+
+static bool same(const ssd1306_t *a, const ssd1306_t *b) {
+  return memcmp(a->ram_buffer, b->ram_buffer, a->bufsize) == 0;
+}
+
+static double render_us(ssd1306_t *ssd, void (*draw)(ssd1306_t *ssd)) {
+  uint64_t start = time_us_64();
+  for (uint32_t i = 0; i < RENDERS; ++i)
+    draw(ssd);
+  return (double)(time_us_64() - start) / RENDERS;
+}
+
+int main(void) {
+  ssd1306_t cur, ref;
+  uint32_t seed = 7;
+  uint32_t cases = 0, failures = 0;
+
+  ssd1306_setup(&cur, WIDTH, HEIGHT, false, DISP_ADDR, NULL);
+  ssd1306_setup(&ref, WIDTH, HEIGHT, false, DISP_ADDR, NULL);
+
+  // Caracteres fora da tabela (127, controle) viram espaço
+  for (int c = 0; c < 128; ++c) {
+    for (uint8_t y = 0; y + 8 <= HEIGHT; ++y) {
+      for (uint8_t x = 0; x + 8 <= WIDTH; ++x) {
+        randomize(&cur, &ref, &seed);
+        ssd1306_draw_char(&cur, (char)c, x, y);
+        ref_draw_char(&ref, (char)c, x, y);
+        cases++;
+        if (!same(&cur, &ref)) {
+          if (failures++ < 10)
+            printf("caractere %d em (%u, %u): buffers diferentes\n", c, x, y);
+        }
+      }
+    }
+  }
+
+  for (int value = 0; value < 2; ++value) {
+    randomize(&cur, &ref, &seed);
+    ssd1306_fill(&cur, value);
+    ref_fill(&ref, value);
+    cases++;
+    if (!same(&cur, &ref)) {
+      failures++;
+      printf("ssd1306_fill(%d): buffers diferentes\n", value);
+    }
+  }
+
+  randomize(&cur, &ref, &seed);
+  draw_menu(&cur);
+  ref_draw_menu(&ref);
+  cases++;
+  if (!same(&cur, &ref)) {
+    failures++;
+    printf("menu: buffers diferentes\n");
+  }
+
+  printf("%lu casos, %lu diferentes\n", (unsigned long)cases, (unsigned long)failures);
+
+  double before = render_us(&ref, ref_draw_menu);
+  double after = render_us(&cur, draw_menu);
+  printf("Desenho de um menu: %.2f us pixel a pixel -> %.2f us atual (%.1fx)\n",
+    before, after, before / after);
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,135 @@
+/*
+ Teste no PC do resumo por janela (inc/dsp/window_stats.c), para comparar
+ com as frações exatas de data_plot/window_stats_ref.py.
+
+ Uso, a partir da raiz do repositório:
+   gcc -O2 -Wall -Ihost_test/sdk -I. -Iinc/dsp host_test/window_stats.c \
+       inc/dsp/window_stats.c inc/log_codec/csv_format.c -o window_stats
+   ./window_stats ws_in.csv ws_out.csv
+   python3 data_plot/window_stats_ref.py ws_in.csv ws_out.csv
+
+ ws_in.csv recebe as amostras (time_ms e os 6 eixos, em contagens) e
+ ws_out.csv as linhas de wstats_format_line, uma por janela, como no
+ adc_stats.csv da coleta. As janelas cobrem:
+  - tamanhos e valores aleatórios em toda a faixa de int16;
+  - ruído pequeno em torno de 0 com n = 3, 7, 8, 40, 200 e 400, em que
+    a média cai com frequência em um empate no centésimo ou perto dele,
+    dos dois lados do zero;
+  - o pior caso dos limites de 64 bits em window_stats.h: n = 65535
+    alternando -32768 e 32767 (maior variância), primeira amostra -32768
+    e as outras 32767 (maior |d| e |sum|), constantes nos extremos
+    (variância 0) e aleatórias em toda a faixa;
+  - janelas de 1 e 2 amostras.
+ window_stats_ref.py recalcula cada resumo com frações e termina com erro
+ se algum campo diferir do arredondamento exato.
+*/
+#include <stdio.h>
+
+#include "window_stats.h"
+
+#define RANDOM_WINDOWS 400
+#define NOISE_WINDOWS 400
+
+static wstats_t ws;
+static FILE *in_file;
+static FILE *out_file;
+static uint32_t seed = 1;
+static uint32_t time_ms;
+static uint32_t windows;
+static uint32_t failures;
+
+static uint32_t next_random(void) {
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+// Valor de cada eixo na amostra i de uma janela de n amostras
+typedef int16_t (*sample_fn)(uint32_t i, uint32_t n, uint8_t axis);
+
+static void run_window(uint16_t n, sample_fn fn) {
+    char line[WSTATS_LINE_MAX];
+
+    wstats_init(&ws, n);
+    for (uint32_t i = 0; i < n; i++) {
+        int16_t v[WSTATS_AXES];
+        for (uint8_t a = 0; a < WSTATS_AXES; a++) {
+            v[a] = fn(i, n, a);
+        }
+        fprintf(in_file, "%lu,%d,%d,%d,%d,%d,%d\n", (unsigned long)time_ms, v[0], v[1], v[2], v[3], v[4],
+                v[5]);
+        bool done = wstats_push(&ws, time_ms++, &v[0], &v[3]);
+        if (done != (i == n - 1u)) {
+            printf("janela de %u amostras completa na amostra %lu\n", n, (unsigned long)i);
+            failures++;
+        }
+    }
+    fwrite(line, 1, wstats_format_line(&ws, line), out_file);
+    windows++;
+}
+
+static int16_t full_random(uint32_t i, uint32_t n, uint8_t axis) {
+    return (int16_t)next_random();
+}
+
+static int16_t small_noise(uint32_t i, uint32_t n, uint8_t axis) {
+    return (int16_t)(next_random() % 5) - 2;
+}
+
+// Eixos com desvios diferentes em torno de offsets diferentes
+static int16_t sensor_like(uint32_t i, uint32_t n, uint8_t axis) {
+    static const int16_t offset[WSTATS_AXES] = {-120, 310, 16384, -7, 12, 30000};
+    return offset[axis] + (int16_t)(next_random() % (1u << (axis + 4))) - (1 << (axis + 3));
+}
+
+static int16_t alternating(uint32_t i, uint32_t n, uint8_t axis) {
+    return (i + axis) % 2 ? INT16_MAX : INT16_MIN;
+}
+
+static int16_t max_shift(uint32_t i, uint32_t n, uint8_t axis) {
+    int16_t first = axis % 2 ? INT16_MAX : INT16_MIN;
+    return i == 0 ? first : -1 - first;
+}
+
+static int16_t constant(uint32_t i, uint32_t n, uint8_t axis) {
+    return axis % 2 ? INT16_MAX : INT16_MIN;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "uso: window_stats ws_in.csv ws_out.csv\n");
+        return 1;
+    }
+    in_file = fopen(argv[1], "w");
+    out_file = fopen(argv[2], "w");
+    if (!in_file || !out_file) {
+        perror("window_stats");
+        return 1;
+    }
+    fputs("time_ms,accel_x,accel_y,accel_z,giro_x,giro_y,giro_z\n", in_file);
+    fputs(WSTATS_HEADER, out_file);
+
+    static const uint16_t noise_n[] = {3, 7, 8, 40, 200, 400};
+    for (uint32_t k = 0; k < RANDOM_WINDOWS; k++) {
+        run_window(1 + next_random() % 2000, k % 2 ? full_random : sensor_like);
+    }
+    for (uint32_t k = 0; k < NOISE_WINDOWS; k++) {
+        run_window(noise_n[k % 6], small_noise);
+    }
+    for (uint32_t n = 1; n <= 2; n++) {
+        run_window(n, full_random);
+        run_window(n, alternating);
+        run_window(n, max_shift);
+    }
+
+    run_window(WSTATS_MAX_WINDOW, alternating);
+    run_window(WSTATS_MAX_WINDOW - 1, alternating);
+    run_window(WSTATS_MAX_WINDOW, max_shift);
+    run_window(WSTATS_MAX_WINDOW, constant);
+    run_window(WSTATS_MAX_WINDOW, full_random);
+    run_window(WSTATS_MAX_WINDOW, sensor_like);
+
+    fclose(in_file);
+    fclose(out_file);
+    printf("%lu janelas, %lu amostras\n", (unsigned long)windows, (unsigned long)time_ms);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,459 @@
+/*
+ Conversor paralelo de logs com frames para CSV, no computador.
+
+ Compilação, a partir da raiz do repositório (os módulos do firmware são
+ compilados como C e ligados ao conversor):
+   gcc -O2 -Wall -c -Ihost_test/sdk -I. -Iinc/log_codec inc/log_codec/delta_codec.c \
+       inc/log_codec/col_chunk.c inc/log_codec/lz_codec.c inc/log_codec/crc32.c \
+       inc/log_codec/csv_format.c inc/sensors/mpu6050.c
+   g++ -O2 -Wall -std=c++17 -pthread -Ihost_test/sdk -I. -Iinc/log_codec \
+       -Iinc/FatFs_SPI/ff15/source host_tools/log_convert.cpp delta_codec.o \
+       col_chunk.o lz_codec.o crc32.o csv_format.o mpu6050.o -o log_convert
+
+ Uso:
+   ./log_convert [-j N] adc_col_data.blz [saida.csv]
+   ./log_convert --bench [-j N] adc_col_data.blz
+
+ O arquivo é mapeado em memória (mmap) e dividido em faixas de
+ SPLIT_SIZE bytes. O limite real de cada faixa é o primeiro frame
+ íntegro (sincronismo e CRC conferidos) que começa nela: cada tarefa
+ converte os frames que começam na sua faixa, mesmo que terminem na
+ seguinte, e a próxima faixa pula o resto desse frame porque o CRC não
+ fecha no meio dele. Como os registros nunca atravessam frames, as faixas
+ são independentes.
+
+ As tarefas rodam em um conjunto de -j threads; a thread principal grava
+ os trechos na ordem do arquivo, com no máximo 2 faixas por thread
+ convertidas à espera, então a memória não depende do tamanho do log.
+
+ A decodificação usa os mesmos módulos do firmware (inc/log_codec) e as
+ linhas são formatadas por csv_format_line, então o CSV de um log delta
+ ou colunar é idêntico ao que o firmware gravaria no modo CSV. Em relação
+ a data_plot/log_decoder.py, que converte em float, só podem diferir
+ valores a menos de 3e-6 de um empate no arredondamento (ver
+ csv_format.h). Frames de texto (CSV e resumos) são copiados como estão.
+
+ Com --bench o CSV é descartado e a vazão é medida com 1 e com N threads.
+ A meta é BENCH_TARGET_MBPS de CSV gerado com 1 thread (com logs delta
+ e colunares de alguns MB foram medidos ~500 MB/s, cerca de 10 milhões
+ de amostras/s); o programa termina com erro se a conversão ficar abaixo
+ dela.
+*/
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "col_chunk.h"
+#include "crc32.h"
+#include "csv_format.h"
+#include "delta_codec.h"
+#include "inc/log_codec/log_file.h"
+#include "inc/log_writer/log_writer.h"
+#include "inc/sensors/mpu6050.h"
+}
+
+namespace {
+
+// Tamanho das faixas entregues a cada tarefa
+constexpr size_t SPLIT_SIZE = 1 << 20;
+
+// Faixas convertidas à espera da gravação, por thread
+constexpr size_t PENDING_PER_JOB = 2;
+
+// Vazão mínima esperada com 1 thread, em MB/s de CSV gerado (ver --bench).
+// A vazão em MB/s de log depende de quanto o formato e o LZ comprimem.
+constexpr double BENCH_TARGET_MBPS = 200.0;
+
+inline uint16_t get_u16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+inline uint32_t get_u32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t)p[3] << 24;
+}
+
+struct Log {
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    size_t start = 0; // Primeiro byte após o cabeçalho do arquivo
+    uint8_t format = 0;
+    uint8_t channels = 0;
+    uint8_t flags = 0;
+};
+
+// Resultado de uma faixa: texto do CSV, amostras e números dos frames
+struct Chunk {
+    std::string text;
+    uint64_t samples = 0;
+    std::vector<uint32_t> seqs;
+};
+
+bool is_text(uint8_t format) {
+    return format == LOG_FORMAT_CSV || format == LOG_FORMAT_STATS;
+}
+
+// Acrescenta uma amostra como linha do CSV, com a temperatura opcional
+void put_sample(std::string &out, uint64_t time_us, const int16_t accel[3], const int16_t gyro[3],
+                const int32_t *temp) {
+    char line[CSV_LINE_MAX];
+    size_t len = csv_format_line(line, time_us, accel, gyro);
+    if (temp) {
+        int32_t centi = mpu6050_temp_centi((int16_t)*temp);
+        line[len - 1] = ',';
+        char *end = csv_put_centi(line + len, centi, centi < 0);
+        *end++ = '\n';
+        len = end - line;
+    }
+    out.append(line, len);
+}
+
+bool convert_delta(const uint8_t *p, size_t len, Chunk &chunk) {
+    delta_samples_t blk;
+    while (len) {
+        size_t n = delta_block_decode(p, len, &blk);
+        if (!n || blk.channels < 6) {
+            return false;
+        }
+        for (uint16_t s = 0; s < blk.samples; s++) {
+            const int32_t *v = blk.value[s];
+            int16_t accel[3] = {(int16_t)v[0], (int16_t)v[1], (int16_t)v[2]};
+            int16_t gyro[3] = {(int16_t)v[3], (int16_t)v[4], (int16_t)v[5]};
+            put_sample(chunk.text, blk.time_us[s], accel, gyro, blk.channels > 6 ? &v[6] : nullptr);
+        }
+        chunk.samples += blk.samples;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool convert_columnar(const uint8_t *p, size_t len, Chunk &chunk) {
+    col_chunk_view_t view;
+    while (len) {
+        if (!col_chunk_parse(p, len, &view)) {
+            return false;
+        }
+        for (uint16_t i = 0; i < view.samples; i++) {
+            int16_t accel[3], gyro[3];
+            for (uint8_t a = 0; a < 3; a++) {
+                accel[a] = col_chunk_axis(&view, a, i);
+                gyro[a] = col_chunk_axis(&view, a + 3, i);
+            }
+            put_sample(chunk.text, col_chunk_time_us(&view, i), accel, gyro, nullptr);
+        }
+        chunk.samples += view.samples;
+        p += view.size;
+        len -= view.size;
+    }
+    return true;
+}
+
+/*
+ Confere o frame em pos (sincronismo já encontrado). Retorna o tamanho
+ total do frame, ou 0 se o cabeçalho for inconsistente ou o CRC não fechar.
+*/
+size_t check_frame(const Log &log, size_t pos) {
+    if (log.size - pos < LOG_FRAME_HEADER_SIZE) {
+        return 0;
+    }
+    const uint8_t *h = log.data + pos;
+    uint8_t method = h[12];
+    uint16_t data_len = get_u16(h + 16);
+    if ((method != LOG_FRAME_STORED && method != LOG_FRAME_LZ) ||
+        log.size - pos - LOG_FRAME_HEADER_SIZE < data_len) {
+        return 0;
+    }
+    uint32_t crc = crc32_update(0, h, LOG_FRAME_HEADER_SIZE - 4);
+    crc = crc32_update(crc, h + LOG_FRAME_HEADER_SIZE, data_len);
+    return crc == get_u32(h + 20) ? LOG_FRAME_HEADER_SIZE + data_len : 0;
+}
+
+// Próxima ocorrência da palavra de sincronismo em [pos, stop)
+size_t find_sync(const Log &log, size_t pos, size_t stop) {
+    const uint8_t first = LOG_FRAME_SYNC & 0xFF;
+    while (pos < stop) {
+        const void *hit = memchr(log.data + pos, first, stop - pos);
+        if (!hit) {
+            break;
+        }
+        pos = (const uint8_t *)hit - log.data;
+        if (log.size - pos >= 4 && get_u32(log.data + pos) == LOG_FRAME_SYNC) {
+            return pos;
+        }
+        pos++;
+    }
+    return stop;
+}
+
+// Converte os frames íntegros que começam em [start, stop)
+void convert_range(const Log &log, size_t start, size_t stop, Chunk &chunk) {
+    std::vector<uint8_t> raw(LOG_GROUP_SIZE);
+    size_t pos = start;
+
+    while ((pos = find_sync(log, pos, stop)) < stop) {
+        size_t frame_size = check_frame(log, pos);
+        if (!frame_size) {
+            pos++;
+            continue;
+        }
+        const uint8_t *h = log.data + pos;
+        uint32_t seq = get_u32(h + 8);
+        uint8_t format = h[13];
+        uint16_t raw_len = get_u16(h + 14);
+        const uint8_t *body = h + LOG_FRAME_HEADER_SIZE;
+        size_t len = frame_size - LOG_FRAME_HEADER_SIZE;
+        pos += frame_size;
+
+        if (h[12] == LOG_FRAME_LZ) {
+            if (raw_len > raw.size() || !lz_decompress(body, len, raw.data(), raw_len)) {
+                fprintf(stderr, "aviso: frame %u com LZ corrompido\n", seq);
+                continue;
+            }
+            body = raw.data();
+            len = raw_len;
+        }
+        chunk.seqs.push_back(seq);
+
+        bool ok;
+        if (is_text(format)) {
+            chunk.text.append((const char *)body, len);
+            ok = true;
+        } else if (format == LOG_FORMAT_DELTA) {
+            ok = convert_delta(body, len, chunk);
+        } else if (format == LOG_FORMAT_COLUMNAR) {
+            ok = convert_columnar(body, len, chunk);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "aviso: frame %u com dados inválidos (formato %u)\n", seq, format);
+        }
+    }
+}
+
+// Totais de uma conversão
+struct Totals {
+    uint64_t samples = 0;
+    uint64_t bytes = 0; // Bytes de CSV
+};
+
+/*
+ Converte o log com jobs threads e entrega os trechos a out (nullptr
+ descarta) na ordem do arquivo.
+*/
+Totals convert(const Log &log, FILE *out, unsigned jobs) {
+    std::vector<size_t> bounds;
+    for (size_t pos = log.start; pos < log.size; pos += SPLIT_SIZE) {
+        bounds.push_back(pos);
+    }
+    bounds.push_back(log.size);
+    size_t ranges = bounds.size() - 1;
+
+    std::vector<Chunk> chunks(ranges);
+    std::vector<bool> done(ranges, false);
+    std::mutex lock;
+    std::condition_variable ready, space;
+    size_t next = 0, written = 0;
+    size_t window = PENDING_PER_JOB * jobs;
+
+    auto worker = [&]() {
+        for (;;) {
+            size_t i;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                space.wait(guard, [&] { return next >= ranges || next < written + window; });
+                if (next >= ranges) {
+                    return;
+                }
+                i = next++;
+            }
+            Chunk chunk;
+            convert_range(log, bounds[i], bounds[i + 1], chunk);
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                chunks[i] = std::move(chunk);
+                done[i] = true;
+            }
+            ready.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned j = 0; j < jobs; j++) {
+        pool.emplace_back(worker);
+    }
+
+    if (out && !is_text(log.format)) {
+        fputs(log.channels > LOG_BASE_CHANNELS ? CSV_HEADER_TEMP : CSV_HEADER, out);
+    }
+
+    Totals totals;
+    uint32_t expected = 0;
+    for (size_t i = 0; i < ranges; i++) {
+        Chunk chunk;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            ready.wait(guard, [&] { return done[i]; });
+            chunk = std::move(chunks[i]);
+            written = i + 1;
+        }
+        space.notify_all();
+
+        for (uint32_t seq : chunk.seqs) {
+            if (seq != expected) {
+                fprintf(stderr, "aviso: frames %u a %u perdidos ou corrompidos\n", expected, seq - 1);
+            }
+            expected = seq + 1;
+        }
+        if (out) {
+            fwrite(chunk.text.data(), 1, chunk.text.size(), out);
+        }
+        totals.samples += chunk.samples;
+        totals.bytes += chunk.text.size();
+    }
+
+    for (auto &t : pool) {
+        t.join();
+    }
+    return totals;
+}
+
+// Mapeia o arquivo e lê o cabeçalho; as faixas do sensor vão para csv_set_scale
+bool open_log(const char *path, Log &log) {
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(path);
+        return false;
+    }
+    log.size = st.st_size;
+    void *map = log.size ? mmap(nullptr, log.size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "%s: não foi possível mapear o arquivo\n", path);
+        return false;
+    }
+    log.data = (const uint8_t *)map;
+    madvise(map, log.size, MADV_SEQUENTIAL);
+
+    const uint8_t *h = log.data;
+    if (log.size < 10 || memcmp(h, LOG_FILE_MAGIC, 4) != 0) {
+        fprintf(stderr, "%s: arquivo não é um log binário (assinatura inválida)\n", path);
+        return false;
+    }
+    log.start = get_u16(h + 4);
+    log.format = h[7];
+    log.channels = h[8];
+    log.flags = h[9];
+    if (!(log.flags & LOG_FLAG_FRAMED)) {
+        fprintf(stderr, "%s: o arquivo não usa frames; use data_plot/log_decoder.py\n", path);
+        return false;
+    }
+
+    // Arquivos antigos (cabeçalho de 10 bytes) usam ±2 g e ±250 °/s
+    mpu6050_config_t cfg = MPU6050_DEFAULT_CONFIG;
+    if (log.start >= LOG_FILE_HEADER_SIZE && log.size >= LOG_FILE_HEADER_SIZE) {
+        cfg.accel_range = (mpu6050_accel_range_t)(h[10] & 0x03);
+        cfg.gyro_range = (mpu6050_gyro_range_t)(h[11] & 0x03);
+    }
+    mpu6050_scale_t scale;
+    mpu6050_scale(&cfg, &scale);
+    csv_set_scale(scale.accel_shift, scale.gyro_lsb_per_dps_x10);
+    return true;
+}
+
+int bench(const Log &log, unsigned jobs) {
+    double single = 0;
+    std::vector<unsigned> counts = {1};
+    if (jobs > 1) {
+        counts.push_back(jobs);
+    }
+    for (unsigned j : counts) {
+        auto start = std::chrono::steady_clock::now();
+        Totals totals = convert(log, nullptr, j);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        double csv_mbps = totals.bytes / elapsed.count() / 1e6;
+        if (j == 1) {
+            single = csv_mbps;
+        }
+        printf("%2u thread(s): %.3f s, log %.1f MB/s, CSV %.1f MB/s, %.0f mil amostras/s\n", j,
+               elapsed.count(), log.size / elapsed.count() / 1e6, csv_mbps,
+               totals.samples / elapsed.count() / 1e3);
+    }
+    printf("Meta com 1 thread: %.0f MB/s de CSV (%s)\n", BENCH_TARGET_MBPS,
+           single >= BENCH_TARGET_MBPS ? "OK" : "ABAIXO");
+    return single >= BENCH_TARGET_MBPS ? 0 : 1;
+}
+
+void usage() {
+    fprintf(stderr, "uso: log_convert [-j N] entrada [saida.csv]\n"
+                    "     log_convert --bench [-j N] entrada\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    bool bench_mode = false;
+    const char *paths[2] = {nullptr, nullptr};
+    int npaths = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--bench")) {
+            bench_mode = true;
+        } else if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+            jobs = std::max(1, atoi(argv[++i]));
+        } else if (argv[i][0] == '-' && argv[i][1]) {
+            usage();
+            return 1;
+        } else if (npaths < 2) {
+            paths[npaths++] = argv[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (!npaths || (bench_mode && npaths > 1)) {
+        usage();
+        return 1;
+    }
+
+    Log log;
+    if (!open_log(paths[0], log)) {
+        return 1;
+    }
+
+    // A tabela do CRC é montada no primeiro uso: monta antes das threads
+    crc32_update(0, nullptr, 0);
+
+    if (bench_mode) {
+        return bench(log, jobs);
+    }
+
+    FILE *out = paths[1] ? fopen(paths[1], "wb") : stdout;
+    if (!out) {
+        perror(paths[1]);
+        return 1;
+    }
+    static char buffer[1 << 20];
+    setvbuf(out, buffer, _IOFBF, sizeof(buffer));
+    convert(log, out, jobs);
+    if (fflush(out) != 0 || (paths[1] && fclose(out) != 0)) {
+        perror(paths[1] ? paths[1] : "stdout");
+        return 1;
+    }
+    return 0;
+}
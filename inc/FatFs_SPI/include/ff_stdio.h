@@ -12,7 +12,9 @@ CONDITIONS OF ANY KIND, either express or implied. See the License for the
 specific language governing permissions and limitations under the License.
 */
 // For compatibility with FreeRTOS+FAT API
+#pragma once
 #include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
@@ -22,9 +24,7 @@ specific language governing permissions and limitations under the License.
 #include "my_debug.h"
 
 #define BaseType_t int
-#define FF_FILE FIL
 
-#define ff_rewind f_rewind
 #define pvPortMalloc malloc
 #define vPortFree free
 #define ffconfigMAX_FILENAME 250
@@ -37,8 +37,36 @@ specific language governing permissions and limitations under the License.
 #define FF_SEEK_END 2
 #define pdFALSE 0
 #define pdTRUE 1
-#define ff_filelength f_size
-#define ff_feof f_eof
+
+// Default size of the user-space buffer attached to each stream by ff_fopen().
+// Use a multiple of the sector size so full buffers map to whole-sector writes.
+#ifndef ffconfigSTDIO_BUFFER_SIZE
+#define ffconfigSTDIO_BUFFER_SIZE 512
+#endif
+
+// Buffering modes for ff_setvbuf(), same meaning as _IOFBF/_IOLBF/_IONBF
+#define FF_IOFBF 0 /* Fully buffered */
+#define FF_IOLBF 1 /* Line buffered: flushed on every '\n' written */
+#define FF_IONBF 2 /* Unbuffered: every call goes straight to f_read/f_write */
+
+typedef enum {
+    FF_BUF_IDLE = 0, /* Buffer is empty */
+    FF_BUF_READ,     /* Buffer holds read-ahead data from the file */
+    FF_BUF_WRITE     /* Buffer holds data not yet passed to f_write */
+} FF_BufState_t;
+
+// Stream object. The FIL is kept first so a stream can still be passed where
+// a FIL* is expected once ff_fflush() has been called.
+typedef struct {
+    FIL fil;
+    uint8_t *pucBuffer;  /* User-space buffer, NULL when unbuffered */
+    size_t xBufferSize;  /* Capacity of pucBuffer */
+    size_t xBufferPos;   /* Read or write index inside pucBuffer */
+    size_t xBufferLen;   /* Valid bytes in pucBuffer (read mode only) */
+    int iBufferMode;     /* FF_IOFBF, FF_IOLBF or FF_IONBF */
+    FF_BufState_t xState;
+    bool bBufferOwned;   /* pucBuffer was allocated by this layer */
+} FF_FILE;
 
 typedef struct FF_STAT {
     uint32_t st_size; /* Size of the object in number of bytes. */
@@ -75,3 +103,8 @@ FF_FILE *ff_truncate( const char * pcFileName, long lTruncateSize );
 int ff_seteof( FF_FILE *pxStream );
 int ff_rename( const char *pcOldName, const char *pcNewName, int bDeleteIfExists );
 char *ff_fgets(char *pcBuffer, size_t xCount, FF_FILE *pxStream);
+int ff_fflush(FF_FILE *pxStream);
+int ff_setvbuf(FF_FILE *pxStream, char *pcBuffer, int iMode, size_t xSize);
+void ff_rewind(FF_FILE *pxStream);
+long ff_filelength(FF_FILE *pxStream);
+int ff_feof(FF_FILE *pxStream);
@@ -86,6 +86,71 @@ int fresult2errno(FRESULT fr) {
     }
 }
 
+// Passes the pending write buffer to f_write and empties it
+static FRESULT prvFlushWrite(FF_FILE *pxStream) {
+    FRESULT fr = FR_OK;
+    if (pxStream->xBufferPos) {
+        UINT bw = 0;
+        fr = f_write(&pxStream->fil, pxStream->pucBuffer,
+                     pxStream->xBufferPos, &bw);
+        if (FR_OK != fr)
+            TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
+        if (FR_OK == fr && bw != pxStream->xBufferPos) {
+            // Volume full: keep what did not fit at the start of the buffer
+            memmove(pxStream->pucBuffer, pxStream->pucBuffer + bw,
+                    pxStream->xBufferPos - bw);
+            pxStream->xBufferPos -= bw;
+            return FR_DENIED;
+        }
+    }
+    pxStream->xBufferPos = 0;
+    return fr;
+}
+// Brings the FIL back in line with the logical stream position: pending
+// writes are flushed and unread read-ahead is given back with f_lseek
+static FRESULT prvSync(FF_FILE *pxStream) {
+    FRESULT fr = FR_OK;
+    switch (pxStream->xState) {
+        case FF_BUF_WRITE:
+            fr = prvFlushWrite(pxStream);
+            if (FR_OK != fr) return fr;
+            break;
+        case FF_BUF_READ: {
+            size_t xUnread = pxStream->xBufferLen - pxStream->xBufferPos;
+            if (xUnread)
+                fr = f_lseek(&pxStream->fil, f_tell(&pxStream->fil) - xUnread);
+            break;
+        }
+        default:
+            break;
+    }
+    pxStream->xBufferPos = 0;
+    pxStream->xBufferLen = 0;
+    pxStream->xState = FF_BUF_IDLE;
+    return fr;
+}
+static bool prvIsBuffered(FF_FILE *pxStream) {
+    return pxStream->pucBuffer && FF_IONBF != pxStream->iBufferMode;
+}
+static FF_FILE *prvStreamAlloc(void) {
+    FF_FILE *pxStream = calloc(1, sizeof(FF_FILE));
+    if (!pxStream) return NULL;
+    pxStream->iBufferMode = FF_IOFBF;
+    // Without memory for the buffer the stream still works, just unbuffered
+    pxStream->pucBuffer = malloc(ffconfigSTDIO_BUFFER_SIZE);
+    if (pxStream->pucBuffer) {
+        pxStream->xBufferSize = ffconfigSTDIO_BUFFER_SIZE;
+        pxStream->bBufferOwned = true;
+    } else {
+        pxStream->iBufferMode = FF_IONBF;
+    }
+    return pxStream;
+}
+static void prvStreamFree(FF_FILE *pxStream) {
+    if (pxStream->bBufferOwned) free(pxStream->pucBuffer);
+    free(pxStream);
+}
+
 FF_FILE *ff_fopen(const char *pcFile, const char *pcMode) {
     TRACE_PRINTF("%s\n", __func__);
     // FRESULT f_open (FIL* fp, const TCHAR* path, BYTE mode);
@@ -94,16 +159,16 @@ FF_FILE *ff_fopen(const char *pcFile, const char *pcMode) {
     //  const TCHAR* path, /* [IN] File name */
     //  BYTE mode          /* [IN] Mode flags */
     //);
-    FIL *fp = malloc(sizeof(FIL));
+    FF_FILE *fp = prvStreamAlloc();
     if (!fp) {
         errno = ENOMEM;
         return NULL;
     }
-    FRESULT fr = f_open(fp, pcFile, posix2mode(pcMode));
+    FRESULT fr = f_open(&fp->fil, pcFile, posix2mode(pcMode));
     errno = fresult2errno(fr);
     if (FR_OK != fr) {
         TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
-        free(fp);
+        prvStreamFree(fp);
         fp = 0;
     }
     return fp;
@@ -113,11 +178,13 @@ int ff_fclose(FF_FILE *pxStream) {
     // FRESULT f_close (
     //  FIL* fp     /* [IN] Pointer to the file object */
     //);
-    FRESULT fr = f_close(pxStream);
+    FRESULT fr = prvSync(pxStream);
+    FRESULT fr2 = f_close(&pxStream->fil);
+    if (FR_OK == fr) fr = fr2;
     if (FR_OK != fr)
         TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
     errno = fresult2errno(fr);
-    free(pxStream);
+    prvStreamFree(pxStream);
     if (FR_OK == fr)
         return 0;
     else
@@ -152,12 +219,55 @@ size_t ff_fwrite(const void *pvBuffer, size_t xSize, size_t xItems,
     //  UINT* bw          /* [OUT] Pointer to the variable to return number of
     //  bytes written */
     //);
-    UINT bw = 0;
-    FRESULT fr = f_write(pxStream, pvBuffer, xSize * xItems, &bw);
+    size_t xTotal = xSize * xItems;
+    if (!xTotal) return 0;
+    FRESULT fr = FR_OK;
+    if (FF_BUF_WRITE != pxStream->xState) {
+        fr = prvSync(pxStream);
+        if (FR_OK != fr) {
+            errno = fresult2errno(fr);
+            return 0;
+        }
+    }
+    if (!prvIsBuffered(pxStream)) {
+        UINT bw = 0;
+        fr = f_write(&pxStream->fil, pvBuffer, xTotal, &bw);
+        if (FR_OK != fr)
+            TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
+        errno = fresult2errno(fr);
+        return bw / xSize;
+    }
+    pxStream->xState = FF_BUF_WRITE;
+    const uint8_t *pucSrc = pvBuffer;
+    size_t xDone = 0;
+    while (xDone < xTotal && FR_OK == fr) {
+        size_t xLeft = xTotal - xDone;
+        if (0 == pxStream->xBufferPos && xLeft >= pxStream->xBufferSize) {
+            // Large request with an empty buffer: skip the copy and hand
+            // whole buffer-sized multiples straight to FatFs
+            UINT btw = xLeft - xLeft % pxStream->xBufferSize;
+            UINT bw = 0;
+            fr = f_write(&pxStream->fil, pucSrc + xDone, btw, &bw);
+            xDone += bw;
+            if (FR_OK == fr && bw != btw) fr = FR_DENIED;
+            continue;
+        }
+        size_t xChunk = pxStream->xBufferSize - pxStream->xBufferPos;
+        if (xChunk > xLeft) xChunk = xLeft;
+        memcpy(pxStream->pucBuffer + pxStream->xBufferPos, pucSrc + xDone,
+               xChunk);
+        pxStream->xBufferPos += xChunk;
+        xDone += xChunk;
+        if (pxStream->xBufferPos == pxStream->xBufferSize)
+            fr = prvFlushWrite(pxStream);
+    }
+    if (FR_OK == fr && FF_IOLBF == pxStream->iBufferMode &&
+        memchr(pvBuffer, '\n', xTotal))
+        fr = prvFlushWrite(pxStream);
     if (FR_OK != fr)
         TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
     errno = fresult2errno(fr);
-    return bw / xSize;
+    return xDone / xSize;
 }
 size_t ff_fread(void *pvBuffer, size_t xSize, size_t xItems,
                 FF_FILE *pxStream) {
@@ -168,12 +278,56 @@ size_t ff_fread(void *pvBuffer, size_t xSize, size_t xItems,
     //  UINT btr,    /* [IN] Number of bytes to read */
     //  UINT* br     /* [OUT] Number of bytes read */
     //);
-    UINT br = 0;
-    FRESULT fr = f_read(pxStream, pvBuffer, xSize * xItems, &br);
+    size_t xTotal = xSize * xItems;
+    if (!xTotal) return 0;
+    FRESULT fr = FR_OK;
+    if (FF_BUF_READ != pxStream->xState) {
+        fr = prvSync(pxStream);
+        if (FR_OK != fr) {
+            errno = fresult2errno(fr);
+            return 0;
+        }
+    }
+    if (!prvIsBuffered(pxStream)) {
+        UINT br = 0;
+        fr = f_read(&pxStream->fil, pvBuffer, xTotal, &br);
+        if (FR_OK != fr)
+            TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
+        errno = fresult2errno(fr);
+        return br / xSize;
+    }
+    pxStream->xState = FF_BUF_READ;
+    uint8_t *pucDst = pvBuffer;
+    size_t xDone = 0;
+    while (xDone < xTotal) {
+        size_t xAvail = pxStream->xBufferLen - pxStream->xBufferPos;
+        size_t xLeft = xTotal - xDone;
+        if (xAvail) {
+            size_t xChunk = xAvail < xLeft ? xAvail : xLeft;
+            memcpy(pucDst + xDone, pxStream->pucBuffer + pxStream->xBufferPos,
+                   xChunk);
+            pxStream->xBufferPos += xChunk;
+            xDone += xChunk;
+            continue;
+        }
+        UINT br = 0;
+        pxStream->xBufferPos = 0;
+        pxStream->xBufferLen = 0;
+        if (xLeft >= pxStream->xBufferSize) {
+            // Read directly into the caller's buffer; nothing to cache
+            fr = f_read(&pxStream->fil, pucDst + xDone, xLeft, &br);
+            xDone += br;
+            break;
+        }
+        fr = f_read(&pxStream->fil, pxStream->pucBuffer,
+                    pxStream->xBufferSize, &br);
+        pxStream->xBufferLen = br;
+        if (FR_OK != fr || 0 == br) break;
+    }
     if (FR_OK != fr)
         TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
     errno = fresult2errno(fr);
-    return br / xSize;
+    return xDone / xSize;
 }
 int ff_chdir(const char *pcDirectoryName) {
     TRACE_PRINTF("%s\n", __func__);
@@ -230,47 +384,35 @@ int ff_mkdir(const char *pcDirectoryName) {
 }
 int ff_fputc(int iChar, FF_FILE *pxStream) {
     // TRACE_PRINTF("%s(iChar=%c,pxStream=%p)\n", __func__, iChar, pxStream);
-    // FRESULT f_write (
-    //  FIL* fp,          /* [IN] Pointer to the file object structure */
-    //  const void* buff, /* [IN] Pointer to the data to be written */
-    //  UINT btw,         /* [IN] Number of bytes to write */
-    //  UINT* bw          /* [OUT] Pointer to the variable to return number of
-    //  bytes written */
-    //);
-    UINT bw = 0;
+    // Fast path: room left in an active write buffer
+    if (FF_BUF_WRITE == pxStream->xState && prvIsBuffered(pxStream) &&
+        pxStream->xBufferPos + 1 < pxStream->xBufferSize &&
+        !(FF_IOLBF == pxStream->iBufferMode && '\n' == iChar)) {
+        pxStream->pucBuffer[pxStream->xBufferPos++] = iChar;
+        return (uint8_t)iChar;
+    }
     uint8_t buff[1];
     buff[0] = iChar;
-    FRESULT fr = f_write(pxStream, buff, 1, &bw);
-    if (FR_OK != fr)
-        TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
-    errno = fresult2errno(fr);
     // On success the byte written to the file is returned. If any other value
     // is returned then the byte was not written to the file and the task's
     // errno will be set to indicate the reason.
-    if (1 == bw)
-        return iChar;
+    if (1 == ff_fwrite(buff, 1, 1, pxStream))
+        return buff[0];
     else {
         return -1;
     }
 }
 int ff_fgetc(FF_FILE *pxStream) {
     // TRACE_PRINTF("%s(pxStream=%p)\n", __func__, pxStream);
-    // FRESULT f_read (
-    //  FIL* fp,     /* [IN] File object */
-    //  void* buff,  /* [OUT] Buffer to store read data */
-    //  UINT btr,    /* [IN] Number of bytes to read */
-    //  UINT* br     /* [OUT] Number of bytes read */
-    //);
+    // Fast path: unread bytes left in the read-ahead buffer
+    if (FF_BUF_READ == pxStream->xState &&
+        pxStream->xBufferPos < pxStream->xBufferLen)
+        return pxStream->pucBuffer[pxStream->xBufferPos++];
     uint8_t buff[1] = {0};
-    UINT br;
-    FRESULT fr = f_read(pxStream, buff, 1, &br);
-    if (FR_OK != fr)
-        TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
-    errno = fresult2errno(fr);
     // On success the byte read from the file system is returned. If a byte
     // could not be read from the file because the read position is already at
     // the end of the file then FF_EOF is returned.
-    if (1 == br)
+    if (1 == ff_fread(buff, 1, 1, pxStream))
         return buff[0];
     else
         return FF_EOF;
@@ -304,25 +446,48 @@ long ff_ftell(FF_FILE *pxStream) {
     // FSIZE_t f_tell (
     //  FIL* fp   /* [IN] File object */
     //);
-    FSIZE_t pos = f_tell(pxStream);
+    FSIZE_t pos = f_tell(&pxStream->fil);
+    if (FF_BUF_WRITE == pxStream->xState)
+        pos += pxStream->xBufferPos;
+    else if (FF_BUF_READ == pxStream->xState)
+        pos -= pxStream->xBufferLen - pxStream->xBufferPos;
     myASSERT(pos < LONG_MAX);
     return pos;
 }
 int ff_fseek(FF_FILE *pxStream, int iOffset, int iWhence) {
     TRACE_PRINTF("%s\n", __func__);
     FRESULT fr = -1;
+    if (FF_SEEK_CUR == iWhence) {
+        // Convert to an absolute offset before the buffer is dropped
+        long lPos = ff_ftell(pxStream);
+        if (lPos + iOffset < 0) return -1;
+        iOffset += lPos;
+        iWhence = FF_SEEK_SET;
+    }
+    if (FF_SEEK_SET == iWhence && FF_BUF_READ == pxStream->xState &&
+        iOffset >= 0) {
+        // Target still inside the read-ahead buffer: just move the index
+        FSIZE_t xBufStart = f_tell(&pxStream->fil) - pxStream->xBufferLen;
+        if ((FSIZE_t)iOffset >= xBufStart &&
+            (FSIZE_t)iOffset <= f_tell(&pxStream->fil)) {
+            pxStream->xBufferPos = iOffset - xBufStart;
+            errno = 0;
+            return 0;
+        }
+    }
+    fr = prvSync(pxStream);
+    if (FR_OK != fr) {
+        errno = fresult2errno(fr);
+        return -1;
+    }
     switch (iWhence) {
-        case FF_SEEK_CUR:  // The current file position.
-            if ((int)f_tell(pxStream) + iOffset < 0) return -1;
-            fr = f_lseek(pxStream, f_tell(pxStream) + iOffset);
-            break;
         case FF_SEEK_END:  // The end of the file.
-            if ((int)f_size(pxStream) + iOffset < 0) return -1;
-            fr = f_lseek(pxStream, f_size(pxStream) + iOffset);
+            if ((int)f_size(&pxStream->fil) + iOffset < 0) return -1;
+            fr = f_lseek(&pxStream->fil, f_size(&pxStream->fil) + iOffset);
             break;
         case FF_SEEK_SET:  // The beginning of the file.
             if (iOffset < 0) return -1;
-            fr = f_lseek(pxStream, iOffset);
+            fr = f_lseek(&pxStream->fil, iOffset);
             break;
         default:
             myASSERT(!"Bad iWhence");
@@ -389,16 +554,20 @@ int ff_findnext(FF_FindData_t *pxFindData) {
 }
 FF_FILE *ff_truncate(const char *pcFileName, long lTruncateSize) {
     TRACE_PRINTF("%s\n", __func__);
-    FIL *fp = malloc(sizeof(FIL));
-    if (!fp) {
+    FF_FILE *pxStream = prvStreamAlloc();
+    if (!pxStream) {
         errno = ENOMEM;
         return NULL;
     }
+    FIL *fp = &pxStream->fil;
     FRESULT fr = f_open(fp, pcFileName, FA_OPEN_APPEND | FA_WRITE);
     if (FR_OK != fr)
         printf("%s: f_open error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
     errno = fresult2errno(fr);
-    if (FR_OK != fr) return NULL;
+    if (FR_OK != fr) {
+        prvStreamFree(pxStream);
+        return NULL;
+    }
     while (f_tell(fp) < (FSIZE_t)lTruncateSize) {
         UINT bw = 0;
         char c = 0;
@@ -419,13 +588,14 @@ FF_FILE *ff_truncate(const char *pcFileName, long lTruncateSize) {
                fr);
     errno = fresult2errno(fr);
     if (FR_OK == fr)
-        return fp;
+        return pxStream;
     else
         return NULL;
 }
 int ff_seteof(FF_FILE *pxStream) {
     TRACE_PRINTF("%s\n", __func__);
-    FRESULT fr = f_truncate(pxStream);
+    FRESULT fr = prvSync(pxStream);
+    if (FR_OK == fr) fr = f_truncate(&pxStream->fil);
     errno = fresult2errno(fr);
     if (FR_OK == fr)
         return 0;
@@ -451,13 +621,86 @@ int ff_rename(const char *pcOldName, const char *pcNewName,
 }
 char *ff_fgets(char *pcBuffer, size_t xCount, FF_FILE *pxStream) {
     TRACE_PRINTF("%s\n", __func__);
-    TCHAR *p = f_gets(pcBuffer, xCount, pxStream);
+    // Same contract as f_gets(), but served from the stream buffer
+    size_t n = 0;
+    while (n + 1 < xCount) {
+        int c = ff_fgetc(pxStream);
+        if (FF_EOF == c) break;
+        pcBuffer[n++] = c;
+        if ('\n' == c) break;
+    }
+    if (xCount) pcBuffer[n] = 0;
     // On success a pointer to pcBuffer is returned. If there is a read error
     // then NULL is returned and the task's errno is set to indicate the reason.
-    if (p == pcBuffer)
+    if (n)
         return pcBuffer;
     else {
         errno = EIO;
         return NULL;
     }
 }
+int ff_fflush(FF_FILE *pxStream) {
+    TRACE_PRINTF("%s\n", __func__);
+    // Flushes pending writes through FatFs and on to the card. Unread
+    // read-ahead is discarded, as the FIL position is resynchronised.
+    FRESULT fr = prvSync(pxStream);
+    if (FR_OK == fr) fr = f_sync(&pxStream->fil);
+    errno = fresult2errno(fr);
+    if (FR_OK == fr)
+        return 0;
+    else
+        return FF_EOF;
+}
+int ff_setvbuf(FF_FILE *pxStream, char *pcBuffer, int iMode, size_t xSize) {
+    TRACE_PRINTF("%s(iMode=%d,xSize=%zu)\n", __func__, iMode, xSize);
+    // Unlike setvbuf(), this may be called at any time: the current buffer is
+    // flushed first. pcBuffer == NULL with xSize > 0 allocates a new buffer.
+    if ((FF_IOFBF != iMode && FF_IOLBF != iMode && FF_IONBF != iMode) ||
+        (pcBuffer && !xSize)) {
+        errno = EINVAL;
+        return -1;
+    }
+    FRESULT fr = prvSync(pxStream);
+    if (FR_OK != fr) {
+        errno = fresult2errno(fr);
+        return -1;
+    }
+    if (FF_IONBF != iMode && !pcBuffer && !xSize) {
+        // Keep the current buffer, only change the mode
+        pxStream->iBufferMode = pxStream->pucBuffer ? iMode : FF_IONBF;
+        return 0;
+    }
+    if (pxStream->bBufferOwned) free(pxStream->pucBuffer);
+    pxStream->pucBuffer = NULL;
+    pxStream->xBufferSize = 0;
+    pxStream->bBufferOwned = false;
+    pxStream->iBufferMode = FF_IONBF;
+    if (FF_IONBF == iMode) return 0;
+    if (!pcBuffer) {
+        pcBuffer = malloc(xSize);
+        if (!pcBuffer) {
+            errno = ENOMEM;
+            return -1;
+        }
+        pxStream->bBufferOwned = true;
+    }
+    pxStream->pucBuffer = (uint8_t *)pcBuffer;
+    pxStream->xBufferSize = xSize;
+    pxStream->iBufferMode = iMode;
+    return 0;
+}
+void ff_rewind(FF_FILE *pxStream) {
+    ff_fseek(pxStream, 0, FF_SEEK_SET);
+}
+long ff_filelength(FF_FILE *pxStream) {
+    // Buffered writes may extend the file past what FatFs knows about
+    long lSize = f_size(&pxStream->fil);
+    long lPos = ff_ftell(pxStream);
+    return lPos > lSize ? lPos : lSize;
+}
+int ff_feof(FF_FILE *pxStream) {
+    if (FF_BUF_READ == pxStream->xState &&
+        pxStream->xBufferPos < pxStream->xBufferLen)
+        return 0;
+    return (FSIZE_t)ff_ftell(pxStream) >= f_size(&pxStream->fil);
+}
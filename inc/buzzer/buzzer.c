@@ -55,3 +55,38 @@ void buzzer_stop(uint gpio_pin) {
     pwm_set_gpio_level(gpio_pin, 0);
 }
 
+// Inicia count bipes de on_ms com intervalos de off_ms. Uma sequência em
+// andamento no mesmo buzzer é substituída.
+void buzzer_beep(buzzer_beep_t *b, uint gpio_pin, uint frequency, uint8_t count, uint16_t on_ms, uint16_t off_ms) {
+    if (b->on) {
+        buzzer_stop(b->gpio_pin);
+    }
+
+    b->gpio_pin = gpio_pin;
+    b->frequency = frequency;
+    b->remaining = count;
+    b->on = false;
+    b->on_ms = on_ms;
+    b->off_ms = off_ms;
+    b->next_us = time_us_64();
+    buzzer_poll(b);
+}
+
+void buzzer_poll(buzzer_beep_t *b) {
+    uint64_t now = time_us_64();
+
+    if (now < b->next_us || (!b->on && b->remaining == 0)) {
+        return;
+    }
+
+    if (b->on) {
+        buzzer_stop(b->gpio_pin);
+        b->on = false;
+        b->next_us = now + b->off_ms * 1000ull;
+    } else {
+        buzzer_play(b->gpio_pin, b->frequency);
+        b->on = true;
+        b->remaining--;
+        b->next_us = now + b->on_ms * 1000ull;
+    }
+}
@@ -7,9 +7,23 @@
 #define BUZZER_LEFT_PIN 21
 #define BUZZER_RIGHT_PIN 10
 
+// Sequência de bipes tocada sem bloquear: buzzer_beep inicia e
+// buzzer_poll, chamada no laço principal, liga e desliga o som nos tempos
+typedef struct {
+    uint gpio_pin;
+    uint frequency;
+    uint8_t remaining; // Bipes que ainda vão começar
+    bool on;
+    uint16_t on_ms;
+    uint16_t off_ms;
+    uint64_t next_us;  // Próxima troca de estado
+} buzzer_beep_t;
+
 void pwm_set_frequency(uint gpio_pin, float frequency);
 void buzzer_setup(uint gpio_pin);
 void buzzer_play(uint gpio_pin, uint frequency);
 void buzzer_stop(uint gpio_pin);
+void buzzer_beep(buzzer_beep_t *b, uint gpio_pin, uint frequency, uint8_t count, uint16_t on_ms, uint16_t off_ms);
+void buzzer_poll(buzzer_beep_t *b);
 
 #endif
@@ -0,0 +1,9 @@
+#include "cycle_counter.h"
+
+// Configura o SysTick para contar livremente no clock do processador
+void cycle_counter_init() {
+    systick_hw->csr = 0;
+    systick_hw->rvr = CYCLE_COUNTER_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; // ENABLE | CLKSOURCE (clock do processador), sem interrupção
+}
@@ -0,0 +1,23 @@
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+#include "pico/stdlib.h"
+#include "hardware/structs/systick.h"
+
+// O Cortex-M0+ não possui DWT->CYCCNT, então o SysTick é usado como contador
+// de ciclos: 24 bits decrescentes no clock do processador. Trechos medidos
+// devem durar menos de 2^24 ciclos (~134 ms a 125 MHz).
+#define CYCLE_COUNTER_MASK 0x00FFFFFFu
+
+void cycle_counter_init();
+
+static inline uint32_t cycle_counter_get() {
+    return systick_hw->cvr;
+}
+
+// Ciclos decorridos desde start (valor retornado por cycle_counter_get)
+static inline uint32_t cycle_counter_elapsed(uint32_t start) {
+    return (start - systick_hw->cvr) & CYCLE_COUNTER_MASK;
+}
+
+#endif
@@ -0,0 +1,105 @@
+#include <string.h>
+
+#include "notify.h"
+
+void notify_init(notify_t *n, ssd1306_t *ssd, bool color) {
+    n->ssd = ssd;
+    n->color = color;
+    n->head = 0;
+    n->count = 0;
+    n->showing = false;
+    n->until_us = 0;
+}
+
+// Desenha a mensagem do início da fila e marca o fim da exibição
+static void show(notify_t *n) {
+    const notify_msg_t *m = &n->queue[n->head];
+
+    ssd1306_fill(n->ssd, !n->color);
+    ssd1306_draw_string(n->ssd, m->line[0], 5, 20);
+    ssd1306_draw_string(n->ssd, m->line[1], 5, 30);
+    ssd1306_draw_string(n->ssd, m->line[2], 5, 40);
+    ssd1306_flush(n->ssd);
+
+    n->showing = true;
+    n->until_us = time_us_64() + m->duration_ms * 1000ull;
+}
+
+static void pop(notify_t *n) {
+    n->head = (n->head + 1) % NOTIFY_QUEUE_SIZE;
+    n->count--;
+    n->showing = false;
+}
+
+// Remove da fila as mensagens de duração 0 que ainda esperam a vez: elas só
+// valem até a próxima mensagem, que é a que está sendo publicada
+static void drop_waiting_progress(notify_t *n) {
+    uint8_t first = n->showing ? 1 : 0;
+    uint8_t kept = first;
+
+    for (uint8_t i = first; i < n->count; i++) {
+        const notify_msg_t *m = &n->queue[(n->head + i) % NOTIFY_QUEUE_SIZE];
+        if (m->duration_ms != 0) {
+            n->queue[(n->head + kept) % NOTIFY_QUEUE_SIZE] = *m;
+            kept++;
+        }
+    }
+    n->count = kept;
+}
+
+// Enfileira uma mensagem. Sem mensagem na tela ela aparece na hora; uma
+// mensagem de duração 0, na tela ou na fila, é substituída. Retorna false
+// com a fila cheia.
+bool notify_post(notify_t *n, const char *l1, const char *l2, const char *l3, uint32_t duration_ms, int8_t led) {
+    drop_waiting_progress(n);
+    if (n->showing && n->queue[n->head].duration_ms == 0) {
+        pop(n);
+    }
+    if (n->count == NOTIFY_QUEUE_SIZE) {
+        return false;
+    }
+
+    notify_msg_t *m = &n->queue[(n->head + n->count) % NOTIFY_QUEUE_SIZE];
+    const char *lines[3] = {l1, l2, l3};
+    for (uint8_t i = 0; i < 3; i++) {
+        strncpy(m->line[i], lines[i] ? lines[i] : "", NOTIFY_LINE_MAX - 1);
+        m->line[i][NOTIFY_LINE_MAX - 1] = '\0';
+    }
+    m->duration_ms = duration_ms;
+    m->led = led;
+    n->count++;
+
+    if (!n->showing) {
+        show(n);
+    }
+    return true;
+}
+
+// Avança a fila quando o tempo da mensagem atual termina. Retorna true
+// quando a última mensagem sai da tela e a página deve ser redesenhada.
+bool notify_poll(notify_t *n) {
+    if (!n->showing) {
+        return false;
+    }
+
+    const notify_msg_t *m = &n->queue[n->head];
+    if (m->duration_ms == 0 || time_us_64() < n->until_us) {
+        return false;
+    }
+
+    pop(n);
+    if (n->count > 0) {
+        show(n);
+        return false;
+    }
+    return true;
+}
+
+// Há uma mensagem na tela: as páginas não devem desenhar
+bool notify_active(const notify_t *n) {
+    return n->showing;
+}
+
+int8_t notify_led(const notify_t *n) {
+    return n->showing ? n->queue[n->head].led : -1;
+}
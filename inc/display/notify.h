@@ -0,0 +1,41 @@
+#ifndef NOTIFY_H
+#define NOTIFY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ssd1306.h"
+
+#define NOTIFY_QUEUE_SIZE 4
+#define NOTIFY_LINE_MAX 16 // 15 caracteres por linha e o '\0'
+
+/*
+ Mensagens temporárias sobre a tela, sem bloquear o laço principal. As
+ mensagens entram em uma fila e cada uma fica na tela pelo seu tempo;
+ notify_poll, chamada a cada volta do laço, passa para a seguinte. Uma
+ mensagem com duração 0 fica até a próxima ser publicada (usada enquanto
+ uma operação está em andamento, como a montagem do cartão).
+*/
+typedef struct {
+    char line[3][NOTIFY_LINE_MAX];
+    uint32_t duration_ms;
+    int8_t led; // Pino do LED aceso durante a mensagem, -1 sem LED
+} notify_msg_t;
+
+typedef struct {
+    ssd1306_t *ssd;
+    bool color;
+    notify_msg_t queue[NOTIFY_QUEUE_SIZE];
+    uint8_t head;   // Mensagem exibida (ou a próxima)
+    uint8_t count;  // Mensagens na fila, incluindo a exibida
+    bool showing;
+    uint64_t until_us;
+} notify_t;
+
+void notify_init(notify_t *n, ssd1306_t *ssd, bool color);
+bool notify_post(notify_t *n, const char *l1, const char *l2, const char *l3, uint32_t duration_ms, int8_t led);
+bool notify_poll(notify_t *n);
+bool notify_active(const notify_t *n);
+int8_t notify_led(const notify_t *n);
+
+#endif
@@ -1,5 +1,14 @@
+#include <stdio.h>
+#include <string.h>
+
 #include "ssd1306.h"
 #include "font.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+// O tratador da interrupção do DMA não recebe contexto: só um display usa
+// o envio assíncrono
+static ssd1306_t *dma_display;
 
 void ssd1306_setup(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
@@ -11,37 +20,50 @@ void ssd1306_setup(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_
   ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->shadow = calloc(ssd->bufsize - 1, sizeof(uint8_t));
+  ssd->tx_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->bytes_sent = 0;
+  ssd->dma_chan = -1;
+  ssd->dma_buffer = NULL;
+  ssd->flush_busy = false;
+  ssd->flush_pending = false;
+  ssd->flush_done = NULL;
+  ssd1306_invalidate(ssd);
+}
+
+// O conteúdo do display passa a ser desconhecido (após reset, configuração
+// ou um envio interrompido): o próximo ssd1306_send_data envia a tela
+// inteira, começando pelos NOPs que fecham um comando deixado pela metade
+void ssd1306_invalidate(ssd1306_t *ssd) {
+  ssd->shadow_valid = false;
+  ssd->resync = true;
 }
 
+static const uint8_t ssd1306_init_commands[] = {
+  SET_DISP | 0x00,
+  SET_MEM_ADDR, 0x01,
+  SET_DISP_START_LINE | 0x00,
+  SET_SEG_REMAP | 0x01,
+  SET_MUX_RATIO, HEIGHT - 1,
+  SET_COM_OUT_DIR | 0x08,
+  SET_DISP_OFFSET, 0x00,
+  SET_COM_PIN_CFG, 0x12,
+  SET_DISP_CLK_DIV, 0x80,
+  SET_PRECHARGE, 0xF1,
+  SET_VCOM_DESEL, 0x30,
+  SET_CONTRAST, 0xFF,
+  SET_ENTIRE_ON,
+  SET_NORM_INV,
+  SET_CHARGE_PUMP, 0x14,
+  SET_DISP | 0x01
+};
+
 void ssd1306_config(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_DISP | 0x00);
-  ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
-  ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
-  ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
-  ssd1306_command(ssd, SET_MUX_RATIO);
-  ssd1306_command(ssd, HEIGHT - 1);
-  ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
-  ssd1306_command(ssd, SET_DISP_OFFSET);
-  ssd1306_command(ssd, 0x00);
-  ssd1306_command(ssd, SET_COM_PIN_CFG);
-  ssd1306_command(ssd, 0x12);
-  ssd1306_command(ssd, SET_DISP_CLK_DIV);
-  ssd1306_command(ssd, 0x80);
-  ssd1306_command(ssd, SET_PRECHARGE);
-  ssd1306_command(ssd, 0xF1);
-  ssd1306_command(ssd, SET_VCOM_DESEL);
-  ssd1306_command(ssd, 0x30);
-  ssd1306_command(ssd, SET_CONTRAST);
-  ssd1306_command(ssd, 0xFF);
-  ssd1306_command(ssd, SET_ENTIRE_ON);
-  ssd1306_command(ssd, SET_NORM_INV);
-  ssd1306_command(ssd, SET_CHARGE_PUMP);
-  ssd1306_command(ssd, 0x14);
-  ssd1306_command(ssd, SET_DISP | 0x01);
+  ssd1306_command_list(ssd, ssd1306_init_commands, sizeof(ssd1306_init_commands));
 }
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+  ssd1306_flush_wait(ssd);
   ssd->port_buffer[1] = command;
   i2c_write_blocking(
     ssd->i2c_port,
@@ -52,20 +74,345 @@ void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   );
 }
 
-void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
+// Envia uma sequência de comandos em uma única transação: o byte de
+// controle 0x00 (Co = 0, D/C = 0) indica que todos os bytes seguintes são
+// comandos, sem o 0x80 antes de cada um
+void ssd1306_command_list(ssd1306_t *ssd, const uint8_t *commands, size_t count) {
+  uint8_t buf[SSD1306_CMD_LIST_MAX + 1];
+  buf[0] = 0x00;
+
+  ssd1306_flush_wait(ssd);
+
+  while (count > 0) {
+    size_t n = count > SSD1306_CMD_LIST_MAX ? SSD1306_CMD_LIST_MAX : count;
+    memcpy(buf + 1, commands, n);
+    i2c_write_blocking(
+      ssd->i2c_port,
+      ssd->address,
+      buf,
+      n + 1,
+      false
+    );
+    commands += n;
+    count -= n;
+  }
+}
+
+// Compara o buffer com o shadow e marca, em cada página, a faixa de
+// colunas alteradas
+static void ssd1306_find_dirty(ssd1306_t *ssd) {
+  const uint8_t *ram = ssd->ram_buffer + 1;
+
+  for (uint8_t p = 0; p < ssd->pages; ++p) {
+    ssd->dirty_first[p] = ssd->width;
+    ssd->dirty_last[p] = 0;
+  }
+
+  if (!ssd->shadow_valid) {
+    for (uint8_t p = 0; p < ssd->pages; ++p) {
+      ssd->dirty_first[p] = 0;
+      ssd->dirty_last[p] = ssd->width - 1;
+    }
+    return;
+  }
+
+  for (uint8_t x = 0; x < ssd->width; ++x) {
+    const uint8_t *col = ram + x * ssd->pages;
+    const uint8_t *old = ssd->shadow + x * ssd->pages;
+    for (uint8_t p = 0; p < ssd->pages; ++p) {
+      if (col[p] != old[p]) {
+        if (ssd->dirty_first[p] > x)
+          ssd->dirty_first[p] = x;
+        ssd->dirty_last[p] = x;
+      }
+    }
+  }
+}
+
+// Envia a janela de colunas x0..x1 e páginas p0..p1. No modo vertical os
+// dados seguem coluna a coluna, então a janela é montada em tx_buffer.
+static void ssd1306_send_window(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  uint8_t *dst = ssd->tx_buffer;
+  *dst++ = 0x40;
+  for (uint8_t x = x0; x <= x1; ++x) {
+    const uint8_t *col = ssd->ram_buffer + 1 + x * ssd->pages;
+    uint8_t *old = ssd->shadow + x * ssd->pages;
+    for (uint8_t p = p0; p <= p1; ++p) {
+      *dst++ = col[p];
+      old[p] = col[p];
+    }
+  }
+
+  const uint8_t window[] = {SSD1306_NOP, SSD1306_NOP, SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, p0, p1};
+  uint8_t skip = ssd->resync ? 0 : 2;
+  ssd->resync = false;
+  ssd1306_command_list(ssd, window + skip, sizeof(window) - skip);
   i2c_write_blocking(
     ssd->i2c_port,
     ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
+    ssd->tx_buffer,
+    dst - ssd->tx_buffer,
     false
   );
+  ssd->bytes_sent += dst - ssd->tx_buffer - 1;
+}
+
+// Percorre as janelas a enviar. Páginas consecutivas alteradas são
+// agrupadas em uma janela quando isso custa menos que uma janela a mais.
+static void ssd1306_for_each_window(ssd1306_t *ssd,
+    void (*emit)(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1)) {
+  ssd1306_find_dirty(ssd);
+
+  uint8_t p = 0;
+  while (p < ssd->pages) {
+    if (ssd->dirty_first[p] > ssd->dirty_last[p]) {
+      ++p;
+      continue;
+    }
+
+    uint8_t p0 = p;
+    uint8_t x0 = ssd->dirty_first[p];
+    uint8_t x1 = ssd->dirty_last[p];
+    uint16_t cost = x1 - x0 + 1; // Bytes enviados pelas janelas separadas
+
+    while (p + 1 < ssd->pages && ssd->dirty_first[p + 1] <= ssd->dirty_last[p + 1]) {
+      uint8_t nx0 = ssd->dirty_first[p + 1] < x0 ? ssd->dirty_first[p + 1] : x0;
+      uint8_t nx1 = ssd->dirty_last[p + 1] > x1 ? ssd->dirty_last[p + 1] : x1;
+      uint16_t next = ssd->dirty_last[p + 1] - ssd->dirty_first[p + 1] + 1;
+      uint16_t merged = (nx1 - nx0 + 1) * (p + 2 - p0);
+      if (merged > cost + next + SSD1306_WINDOW_COST)
+        break;
+      x0 = nx0;
+      x1 = nx1;
+      cost = merged;
+      ++p;
+    }
+
+    emit(ssd, x0, x1, p0, p);
+    ++p;
+  }
+
+  ssd->shadow_valid = true;
+}
+
+// Envia ao display apenas o que mudou desde o último envio
+void ssd1306_send_data(ssd1306_t *ssd) {
+  ssd1306_flush_wait(ssd);
+  ssd->flush_pending = false;
+  ssd1306_for_each_window(ssd, ssd1306_send_window);
+}
+
+// Palavra do registrador IC_DATA_CMD: byte de dados com STOP no último byte
+// de cada transação. Depois de um STOP, o próximo byte da FIFO inicia uma
+// nova transação para o mesmo endereço.
+static inline void dma_put(ssd1306_t *ssd, uint8_t byte, bool stop) {
+  ssd->dma_buffer[ssd->dma_words++] = byte | (stop ? I2C_IC_DATA_CMD_STOP_BITS : 0);
+}
+
+// Acrescenta a janela ao buffer do DMA: a lista de comandos de endereço e
+// os dados, como em ssd1306_send_window
+static void ssd1306_queue_window(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  const uint8_t window[] = {SSD1306_NOP, SSD1306_NOP, SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, p0, p1};
+  uint8_t skip = ssd->resync ? 0 : 2;
+  ssd->resync = false;
+  dma_put(ssd, 0x00, false);
+  for (uint8_t i = skip; i < sizeof(window); ++i)
+    dma_put(ssd, window[i], i == sizeof(window) - 1);
+
+  dma_put(ssd, 0x40, false);
+  for (uint8_t x = x0; x <= x1; ++x) {
+    const uint8_t *col = ssd->ram_buffer + 1 + x * ssd->pages;
+    uint8_t *old = ssd->shadow + x * ssd->pages;
+    for (uint8_t p = p0; p <= p1; ++p) {
+      dma_put(ssd, col[p], x == x1 && p == p1);
+      old[p] = col[p];
+    }
+  }
+  ssd->bytes_sent += (x1 - x0 + 1) * (p1 - p0 + 1);
+}
+
+static void ssd1306_dma_irq_handler(void) {
+  ssd1306_t *ssd = dma_display;
+  if (!ssd || !dma_channel_get_irq1_status(ssd->dma_chan))
+    return;
+  dma_channel_acknowledge_irq1(ssd->dma_chan);
+
+  ssd->flush_us = time_us_64() - ssd->flush_start_us;
+  ssd->flush_busy = false;
+  if (ssd->flush_done)
+    ssd->flush_done();
+}
+
+// Prepara o envio assíncrono: um canal de DMA alimenta a FIFO de
+// transmissão do I2C a partir de um buffer próprio, montado no início de
+// cada envio. done (pode ser NULL) é chamado na interrupção do DMA, quando
+// o último byte foi entregue à FIFO. Retorna false sem canal ou memória;
+// nesse caso ssd1306_flush continua usando o envio bloqueante.
+bool ssd1306_dma_init(ssd1306_t *ssd, void (*done)(void)) {
+  int chan = dma_claim_unused_channel(false);
+  if (chan < 0)
+    return false;
+
+  // Pior caso: todos os bytes e uma janela por página, com os NOPs
+  ssd->dma_buffer = calloc(ssd->bufsize - 1 + ssd->pages * 8 + 2, sizeof(uint16_t));
+  if (!ssd->dma_buffer) {
+    dma_channel_unclaim(chan);
+    return false;
+  }
+
+  ssd->dma_chan = chan;
+  ssd->flush_done = done;
+  ssd->flush_busy = false;
+  ssd->flush_pending = false;
+  dma_display = ssd;
+
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  dma_channel_config cfg = dma_channel_get_default_config(chan);
+  channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+  channel_config_set_read_increment(&cfg, true);
+  channel_config_set_write_increment(&cfg, false);
+  channel_config_set_dreq(&cfg, i2c_hw_index(ssd->i2c_port) ? DREQ_I2C1_TX : DREQ_I2C0_TX);
+  dma_channel_configure(chan, &cfg, &hw->data_cmd, ssd->dma_buffer, 0, false);
+
+  // O cartão SD usa o DMA_IRQ_0
+  dma_channel_set_irq1_enabled(chan, true);
+  irq_add_shared_handler(DMA_IRQ_1, ssd1306_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+  irq_set_enabled(DMA_IRQ_1, true);
+  return true;
+}
+
+// Envio em andamento: DMA ativo ou bytes ainda na FIFO do I2C
+bool ssd1306_flush_busy(ssd1306_t *ssd) {
+  if (ssd->dma_chan < 0)
+    return false;
+  if (ssd->flush_busy)
+    return true;
+
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  if (!(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS))
+    return true;
+
+  // Sem ACK do display a FIFO é descartada: o conteúdo passa a ser
+  // desconhecido e o próximo envio é completo
+  if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+    (void)hw->clr_tx_abrt;
+    ssd1306_invalidate(ssd);
+  }
+  return false;
+}
+
+void ssd1306_flush_wait(ssd1306_t *ssd) {
+  while (ssd1306_flush_busy(ssd))
+    tight_loop_contents();
+}
+
+// Envia o que mudou sem bloquear. As alterações são copiadas para o buffer
+// do DMA, então o ram_buffer pode ser redesenhado logo em seguida. Com um
+// envio em andamento o quadro fica pendente e sai em ssd1306_flush_poll.
+// Retorna true quando o envio foi iniciado.
+bool ssd1306_flush(ssd1306_t *ssd) {
+  if (ssd->dma_chan < 0) {
+    ssd1306_send_data(ssd);
+    return true;
+  }
+  if (ssd1306_flush_busy(ssd)) {
+    ssd->flush_pending = true;
+    return false;
+  }
+
+  ssd->flush_pending = false;
+  ssd->dma_words = 0;
+  ssd1306_for_each_window(ssd, ssd1306_queue_window);
+  if (ssd->dma_words == 0)
+    return true;
+
+  // Endereço do display, como em i2c_write_blocking
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  hw->enable = 0;
+  hw->tar = ssd->address;
+  hw->enable = 1;
+  hw->dma_cr = I2C_IC_DMA_CR_TDMAE_BITS;
+
+  ssd->flush_busy = true;
+  ssd->flush_start_us = time_us_64();
+  dma_channel_transfer_from_buffer_now(ssd->dma_chan, ssd->dma_buffer, ssd->dma_words);
+  return true;
+}
+
+// Chamada no laço principal: inicia o quadro pendente quando o envio
+// anterior termina
+void ssd1306_flush_poll(ssd1306_t *ssd) {
+  if (ssd->flush_pending && !ssd1306_flush_busy(ssd))
+    ssd1306_flush(ssd);
+}
+
+// Mede o tempo de barramento da inicialização e de uma atualização com um
+// comando por transação e com a lista de comandos, o desenho de um menu no
+// buffer e o tempo de CPU de um envio por DMA. O display é reconfigurado e
+// redesenhado por completo.
+void ssd1306_bench(ssd1306_t *ssd) {
+  const uint8_t window[] = {SET_COL_ADDR, 0, 0, SET_PAGE_ADDR, 0, 0};
+  uint64_t start;
+
+  start = time_us_64();
+  for (size_t i = 0; i < sizeof(ssd1306_init_commands); ++i)
+    ssd1306_command(ssd, ssd1306_init_commands[i]);
+  uint32_t init_single = time_us_64() - start;
+
+  start = time_us_64();
+  ssd1306_config(ssd);
+  uint32_t init_list = time_us_64() - start;
+
+  // Janela de uma coluna em uma página com um byte de dados (o mesmo que
+  // já está no display, então a imagem não muda)
+  uint8_t one[2] = {0x40, ssd->shadow[0]};
+
+  start = time_us_64();
+  for (size_t i = 0; i < sizeof(window); ++i)
+    ssd1306_command(ssd, window[i]);
+  i2c_write_blocking(ssd->i2c_port, ssd->address, one, 2, false);
+  uint32_t update_single = time_us_64() - start;
+
+  start = time_us_64();
+  ssd1306_command_list(ssd, window, sizeof(window));
+  i2c_write_blocking(ssd->i2c_port, ssd->address, one, 2, false);
+  uint32_t update_list = time_us_64() - start;
+
+  ssd1306_invalidate(ssd);
+  start = time_us_64();
+  ssd1306_send_data(ssd);
+  uint32_t full = time_us_64() - start;
+
+  printf("OLED inicialização: %lu us (um comando por transação) -> %lu us (lista)\n",
+    (unsigned long)init_single, (unsigned long)init_list);
+  printf("OLED atualização mínima: %lu us -> %lu us (economia de %lu us por janela)\n",
+    (unsigned long)update_single, (unsigned long)update_list, (unsigned long)(update_single - update_list));
+  printf("OLED tela completa: %lu us\n", (unsigned long)full);
+
+  // Desenho de um menu completo no buffer (sem envio), média de 100. O
+  // quadro atual é guardado em tx_buffer, livre fora de ssd1306_send_window.
+  const uint16_t renders = 100;
+  memcpy(ssd->tx_buffer, ssd->ram_buffer, ssd->bufsize);
+  start = time_us_64();
+  for (uint16_t i = 0; i < renders; ++i) {
+    ssd1306_fill(ssd, false);
+    ssd1306_draw_string(ssd, "SD: MONTADO", 5, 20);
+    ssd1306_draw_string(ssd, "QTND: 12345", 5, 30);
+    ssd1306_draw_string(ssd, "ARQUIVO: 07", 5, 41);
+  }
+  printf("OLED desenho de um menu: %lu us\n", (unsigned long)((time_us_64() - start) / renders));
+  memcpy(ssd->ram_buffer, ssd->tx_buffer, ssd->bufsize);
+
+  if (ssd->dma_chan >= 0) {
+    ssd1306_invalidate(ssd);
+    start = time_us_64();
+    ssd1306_flush(ssd);
+    uint32_t cpu = time_us_64() - start;
+    ssd1306_flush_wait(ssd);
+    uint32_t total = time_us_64() - start;
+    printf("OLED tela completa por DMA: %lu us de CPU, %lu us até o fim do envio\n",
+      (unsigned long)cpu, (unsigned long)total);
+  }
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
@@ -78,12 +425,8 @@ void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
 }
 
 void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
-    }
+    // Cada byte do buffer são 8 pixels de uma coluna
+    memset(ssd->ram_buffer + 1, value ? 0xFF : 0x00, ssd->bufsize - 1);
 }
 
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
@@ -139,9 +482,29 @@ void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value
     ssd1306_pixel(ssd, x, y, value);
 }
 
+// Segmento vertical escrito por página: um byte com máscara em cada página
+// coberta, em vez de um ssd1306_pixel por linha
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+  if (y0 > y1) {
+    uint8_t t = y0;
+    y0 = y1;
+    y1 = t;
+  }
+  if (x >= ssd->width || y0 >= ssd->height)
+    return;
+  if (y1 >= ssd->height)
+    y1 = ssd->height - 1;
+
+  uint8_t *col = ssd->ram_buffer + 1 + x * ssd->pages;
+  for (uint8_t page = y0 >> 3; page <= (y1 >> 3); ++page) {
+    uint8_t top = page == (y0 >> 3) ? (y0 & 0b111) : 0;
+    uint8_t bottom = page == (y1 >> 3) ? (y1 & 0b111) : 7;
+    uint8_t mask = (uint8_t)(0xFF << top) & (uint8_t)(0xFF >> (7 - bottom));
+    if (value)
+      col[page] |= mask;
+    else
+      col[page] &= ~mask;
+  }
 }
 
 // Função para desenhar um caractere
@@ -160,14 +523,24 @@ void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
     index = 0; // Índice 0 corresponde ao caractere "nada" (espaço)
   }
 
-  // Desenha o caractere na tela
-  for (uint8_t i = 0; i < 8; ++i)
+  // Cada byte da fonte é uma coluna do caractere com o bit 0 no topo, o
+  // mesmo formato do buffer. Com y múltiplo de 8 a coluna é copiada para
+  // uma página; senão é dividida entre duas páginas com deslocamento e
+  // máscara. O que sai da tela é descartado.
+  uint8_t page = y >> 3;
+  uint8_t shift = y & 0b111;
+  uint8_t mask_lo = 0xFF << shift;
+  uint8_t mask_hi = ~mask_lo;
+
+  for (uint8_t i = 0; i < 8 && x + i < ssd->width; ++i)
   {
-    uint8_t line = font[index + i]; // Acessa a linha correspondente do caractere na fonte
-    for (uint8_t j = 0; j < 8; ++j)
-    {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j)); // Desenha cada pixel do caractere
-    }
+    uint8_t line = font[index + i];
+    uint8_t *col = ssd->ram_buffer + 1 + (x + i) * ssd->pages;
+
+    if (page < ssd->pages)
+      col[page] = (col[page] & ~mask_lo) | (uint8_t)(line << shift);
+    if (shift && page + 1 < ssd->pages)
+      col[page + 1] = (col[page + 1] & ~mask_hi) | (line >> (8 - shift));
   }
 }
 
@@ -9,6 +9,21 @@
 #define HEIGHT 64
 #define DISP_ADDR 0x3C
 
+#define SSD1306_MAX_PAGES 8
+
+// Custo fixo de uma janela de atualização em bytes no barramento: endereço,
+// byte de controle e seis comandos em uma transação, mais endereço e
+// controle da escrita dos dados. Páginas vizinhas são enviadas na mesma
+// janela quando os bytes a mais custam menos que isso.
+#define SSD1306_WINDOW_COST 10
+
+// Comandos enviados por transação em ssd1306_command_list
+#define SSD1306_CMD_LIST_MAX 32
+
+// Comando sem efeito. Dois deles completam qualquer comando de janela que
+// um envio interrompido tenha deixado pela metade no controlador.
+#define SSD1306_NOP 0xE3
+
 typedef enum {
   SET_CONTRAST = 0x81,
   SET_ENTIRE_ON = 0xA4,
@@ -29,6 +44,15 @@ typedef enum {
   SET_CHARGE_PUMP = 0x8D
 } ssd1306_command_t;
 
+/*
+ O ram_buffer segue o modo de endereçamento vertical: byte de controle
+ 0x40 e depois, para cada coluna, um byte por página. shadow guarda o que
+ já foi enviado ao display; ssd1306_send_data só transmite as faixas de
+ colunas que mudaram em cada página (dirty_first/dirty_last), com a
+ janela SET_COL_ADDR/SET_PAGE_ADDR correspondente. ssd1306_flush faz o
+ mesmo sem bloquear, com as janelas copiadas para dma_buffer e enviadas
+ por DMA.
+*/
 typedef struct {
   uint8_t width, height, pages, address;
   i2c_inst_t *i2c_port;
@@ -36,13 +60,36 @@ typedef struct {
   uint8_t *ram_buffer;
   size_t bufsize;
   uint8_t port_buffer[2];
+  uint8_t *shadow;                          // Conteúdo atual do display (sem o byte de controle)
+  uint8_t *tx_buffer;                       // Janela montada para envio
+  bool shadow_valid;                        // false: o próximo envio é completo
+  bool resync;                              // Próxima janela precedida de SSD1306_NOP
+  uint8_t dirty_first[SSD1306_MAX_PAGES];   // Faixa alterada por página;
+  uint8_t dirty_last[SSD1306_MAX_PAGES];    // first > last: página sem mudança
+  uint32_t bytes_sent;                      // Bytes de dados enviados desde o início
+  int dma_chan;                             // -1: sem envio assíncrono
+  uint16_t *dma_buffer;                     // Palavras de IC_DATA_CMD do envio atual
+  uint16_t dma_words;
+  volatile bool flush_busy;                 // DMA em andamento
+  bool flush_pending;                       // Quadro aguardando o fim do envio anterior
+  void (*flush_done)(void);                 // Chamada na interrupção do DMA
+  uint64_t flush_start_us;
+  volatile uint32_t flush_us;               // Duração do último envio assíncrono
 } ssd1306_t;
 
 void ssd1306_setup(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
+void ssd1306_command_list(ssd1306_t *ssd, const uint8_t *commands, size_t count);
 void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_invalidate(ssd1306_t *ssd);
+bool ssd1306_dma_init(ssd1306_t *ssd, void (*done)(void));
+bool ssd1306_flush(ssd1306_t *ssd);
+bool ssd1306_flush_busy(ssd1306_t *ssd);
+void ssd1306_flush_wait(ssd1306_t *ssd);
+void ssd1306_flush_poll(ssd1306_t *ssd);
 void ssd1306_initialize(ssd1306_t *ssd);
+void ssd1306_bench(ssd1306_t *ssd);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
@@ -0,0 +1,141 @@
+#include "strip_chart.h"
+
+void strip_chart_init(strip_chart_t *s, uint8_t width, uint16_t decim) {
+    s->width = width > STRIP_MAX_COLUMNS ? STRIP_MAX_COLUMNS : width;
+    s->decim = decim ? decim : 1;
+    strip_chart_reset(s);
+}
+
+// Apaga o histórico, mantendo a largura e a decimação
+void strip_chart_reset(strip_chart_t *s) {
+    s->count = 0;
+    s->columns = 0;
+    s->drawn = 0;
+    s->lo = -STRIP_MIN_SPAN / 2;
+    s->span = STRIP_MIN_SPAN;
+    s->full_redraw = true;
+}
+
+// Nova escala a partir das colunas visíveis: faixa em potência de 2 com
+// folga de 25%, centrada no sinal
+static void rescale(strip_chart_t *s) {
+    uint32_t visible = s->columns < s->width ? s->columns : s->width;
+    int32_t vmin = INT16_MAX;
+    int32_t vmax = INT16_MIN;
+
+    for (uint32_t i = 0; i < visible; i++) {
+        if (s->min[i] < vmin) {
+            vmin = s->min[i];
+        }
+        if (s->max[i] > vmax) {
+            vmax = s->max[i];
+        }
+    }
+
+    int32_t range = vmax - vmin;
+    int32_t span = STRIP_MIN_SPAN;
+    while (span < range + range / 4 + 1) {
+        span <<= 1;
+    }
+
+    s->span = span;
+    s->lo = (vmin + vmax) / 2 - span / 2;
+    s->full_redraw = true;
+}
+
+// Acrescenta uma amostra. Retorna true quando uma coluna foi completada.
+bool strip_chart_push(strip_chart_t *s, int16_t value) {
+    if (s->count == 0) {
+        s->cur_min = value;
+        s->cur_max = value;
+    } else if (value < s->cur_min) {
+        s->cur_min = value;
+    } else if (value > s->cur_max) {
+        s->cur_max = value;
+    }
+
+    if (++s->count < s->decim) {
+        return false;
+    }
+    s->count = 0;
+
+    uint8_t x = s->columns % s->width;
+    s->min[x] = s->cur_min;
+    s->max[x] = s->cur_max;
+    s->columns++;
+
+    if (s->cur_min < s->lo || s->cur_max > s->lo + s->span) {
+        rescale(s);
+    } else if (x == s->width - 1 && s->span > STRIP_MIN_SPAN) {
+        // Fim de uma varredura: contrai a escala se o sinal diminuiu
+        int32_t vmin = INT16_MAX;
+        int32_t vmax = INT16_MIN;
+        for (uint8_t i = 0; i < s->width; i++) {
+            if (s->min[i] < vmin) {
+                vmin = s->min[i];
+            }
+            if (s->max[i] > vmax) {
+                vmax = s->max[i];
+            }
+        }
+        if ((vmax - vmin) * 4 < s->span) {
+            rescale(s);
+        }
+    }
+
+    return true;
+}
+
+// Há colunas novas (ou um redesenho completo) a desenhar
+bool strip_chart_pending(const strip_chart_t *s) {
+    return s->full_redraw || s->columns != s->drawn;
+}
+
+// A área do gráfico foi apagada por outra tela: o próximo desenho é completo
+void strip_chart_invalidate(strip_chart_t *s) {
+    s->full_redraw = true;
+}
+
+static uint8_t to_row(const strip_chart_t *s, int32_t v, uint8_t top, uint8_t bottom) {
+    int32_t rows = bottom - top;
+    int32_t r = (v - s->lo) * rows / s->span;
+    if (r < 0) {
+        r = 0;
+    } else if (r > rows) {
+        r = rows;
+    }
+    return bottom - r;
+}
+
+static void draw_column(const strip_chart_t *s, ssd1306_t *ssd, uint32_t k, uint8_t top, uint8_t bottom) {
+    uint8_t x = k % s->width;
+    ssd1306_vline(ssd, x, top, bottom, false);
+    ssd1306_vline(ssd, x, to_row(s, s->max[x], top, bottom), to_row(s, s->min[x], top, bottom), true);
+}
+
+// Desenha as colunas novas entre as linhas top e bottom do display. Depois
+// de uma mudança de escala (ou de strip_chart_invalidate) todas as colunas
+// visíveis são redesenhadas.
+void strip_chart_draw(strip_chart_t *s, ssd1306_t *ssd, uint8_t top, uint8_t bottom) {
+    uint32_t first = s->drawn;
+
+    if (s->full_redraw || s->columns - s->drawn > s->width) {
+        for (uint8_t x = 0; x < s->width; x++) {
+            ssd1306_vline(ssd, x, top, bottom, false);
+        }
+        first = s->columns > s->width ? s->columns - s->width : 0;
+        s->full_redraw = false;
+    }
+
+    for (uint32_t k = first; k < s->columns; k++) {
+        draw_column(s, ssd, k, top, bottom);
+    }
+
+    // Cursor da varredura: as duas colunas mais antigas ficam apagadas
+    if (s->columns >= s->width) {
+        ssd1306_vline(ssd, s->columns % s->width, top, bottom, false);
+        ssd1306_vline(ssd, (s->columns + 1) % s->width, top, bottom, false);
+    }
+
+    s->drawn = s->columns;
+}
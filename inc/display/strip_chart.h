@@ -0,0 +1,48 @@
+#ifndef STRIP_CHART_H
+#define STRIP_CHART_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ssd1306.h"
+
+#define STRIP_MAX_COLUMNS 128
+#define STRIP_DEFAULT_DECIM 10
+#define STRIP_MIN_SPAN 64 // Menor faixa vertical, em contagens do sensor
+
+/*
+ Gráfico de um eixo em modo varredura. Cada coluna guarda o mínimo e o
+ máximo de 'decim' amostras, então o desenho custa O(largura) qualquer que
+ seja a taxa de amostragem. A coluna k do anel é sempre a coluna
+ k % width do display: a cada quadro só as colunas novas e o cursor à
+ frente delas mudam, e o envio por regiões alteradas do ssd1306 transmite
+ apenas essas colunas. Rolar a imagem mudaria todas as colunas a cada
+ quadro.
+
+ A escala vertical [lo, lo + span] se expande assim que um valor sai dela
+ e se contrai quando a varredura volta ao início com o sinal ocupando
+ menos de um quarto da faixa; nos dois casos o gráfico é redesenhado.
+*/
+typedef struct {
+    uint16_t decim;
+    uint16_t count;          // Amostras na coluna em formação
+    int16_t cur_min;
+    int16_t cur_max;
+    uint8_t width;
+    int16_t min[STRIP_MAX_COLUMNS];
+    int16_t max[STRIP_MAX_COLUMNS];
+    uint32_t columns;        // Colunas completas desde o reset
+    uint32_t drawn;          // Colunas já desenhadas
+    int32_t lo;
+    int32_t span;
+    bool full_redraw;
+} strip_chart_t;
+
+void strip_chart_init(strip_chart_t *s, uint8_t width, uint16_t decim);
+void strip_chart_reset(strip_chart_t *s);
+bool strip_chart_push(strip_chart_t *s, int16_t value);
+bool strip_chart_pending(const strip_chart_t *s);
+void strip_chart_invalidate(strip_chart_t *s);
+void strip_chart_draw(strip_chart_t *s, ssd1306_t *ssd, uint8_t top, uint8_t bottom);
+
+#endif
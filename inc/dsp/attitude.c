@@ -0,0 +1,171 @@
+#include <stdio.h>
+
+#include "attitude.h"
+#include "fixed_math.h"
+#include "inc/cycle_counter/cycle_counter.h"
+#include "inc/log_codec/csv_format.h"
+
+// Intervalos maiores (pausas na coleta) são limitados para não integrar
+// uma taxa antiga por muito tempo
+#define ATT_MAX_DT_MS 1000
+
+#define CORDIC_ITERATIONS 24
+#define CORDIC_INPUT_SHIFT 12
+
+// atan(2^-i) em BAM
+static const int32_t cordic_atan_table[CORDIC_ITERATIONS] = {
+    536870912, 316933406, 167458907, 85004756, 42667331, 21354465, 10679838, 5340245,
+    2670163, 1335087, 667544, 333772, 166886, 83443, 41722, 20861,
+    10430, 5215, 2608, 1304, 652, 326, 163, 81
+};
+
+// atan2(y, x) em BAM por CORDIC no modo vetorização. As entradas devem ter
+// módulo menor que 2^17; só deslocamentos e somas, sem multiplicação.
+int32_t cordic_atan2(int32_t y, int32_t x) {
+    int32_t angle = 0;
+
+    x <<= CORDIC_INPUT_SHIFT;
+    y <<= CORDIC_INPUT_SHIFT;
+
+    // Leva o vetor para o semiplano x >= 0 girando 180°
+    if (x < 0) {
+        x = -x;
+        y = -y;
+        angle = INT32_MIN;
+    }
+
+    for (uint8_t i = 0; i < CORDIC_ITERATIONS; i++) {
+        int32_t xs = x >> i;
+        int32_t ys = y >> i;
+        if (y > 0) {
+            x += ys;
+            y -= xs;
+            angle += cordic_atan_table[i];
+        } else {
+            x -= ys;
+            y += xs;
+            angle -= cordic_atan_table[i];
+        }
+    }
+
+    return angle;
+}
+
+void attitude_init(attitude_t *att, uint32_t tau_ms) {
+    att->tau_ms = tau_ms;
+    attitude_reset(att);
+}
+
+// Ajusta o filtro às faixas do sensor. Faixa aceita para |a|²: (0.75 g)² a
+// (1.25 g)². Contagem do giroscópio * ms -> BAM:
+// 2^32 / (lsb * 1000 * 360) em Q16, com lsb = gyro_lsb_x10 / 10.
+void attitude_set_scale(attitude_t *att, uint16_t accel_lsb_per_g, uint16_t gyro_lsb_x10) {
+    uint32_t g2_16 = (uint32_t)accel_lsb_per_g * accel_lsb_per_g / 16;
+    att->acc_min2 = g2_16 * 9;
+    att->acc_max2 = g2_16 * 25;
+    att->gyro_bam_q16 = (int32_t)((10ull << 48) / (gyro_lsb_x10 * 360000ull));
+}
+
+void attitude_reset(attitude_t *att) {
+    att->roll = 0;
+    att->pitch = 0;
+    att->yaw = 0;
+    att->last_ms = 0;
+    att->started = false;
+}
+
+static inline int32_t gyro_to_bam(int16_t rate, uint32_t dt_ms, int32_t bam_q16) {
+    return (int32_t)(((int64_t)(rate * (int32_t)dt_ms) * bam_q16) >> 16);
+}
+
+// Aproxima angle de target com peso w (shift bits fracionários). A
+// diferença em BAM já está em (-180°, 180°], então o caminho é sempre o
+// mais curto.
+static inline int32_t blend(int32_t angle, int32_t target, int32_t w, uint8_t shift) {
+    int32_t diff = (int32_t)((uint32_t)target - (uint32_t)angle);
+    return (int32_t)((uint32_t)angle + (uint32_t)(((int64_t)diff * w) >> shift));
+}
+
+void attitude_update(attitude_t *att, uint32_t time_ms, const int16_t accel[3], const int16_t gyro[3]) {
+    int32_t ax = accel[0];
+    int32_t ay = accel[1];
+    int32_t az = accel[2];
+    uint32_t norm2 = (uint32_t)(ax * ax) + (uint32_t)(ay * ay) + (uint32_t)(az * az);
+    bool accel_ok = norm2 > att->acc_min2 && norm2 < att->acc_max2;
+
+    if (!att->started) {
+        // Primeira amostra: a atitude inicial vem só do acelerômetro
+        att->roll = cordic_atan2(ay, az);
+        att->pitch = cordic_atan2(-ax, isqrt32((uint32_t)(ay * ay) + (uint32_t)(az * az)));
+        att->yaw = 0;
+        att->last_ms = time_ms;
+        att->started = true;
+        return;
+    }
+
+    uint32_t dt = time_ms - att->last_ms;
+    att->last_ms = time_ms;
+    if (dt > ATT_MAX_DT_MS) {
+        dt = ATT_MAX_DT_MS;
+    }
+
+    // Integração do giroscópio (soma em BAM, o estouro é a volta de 360°)
+    att->roll = (int32_t)((uint32_t)att->roll + (uint32_t)gyro_to_bam(gyro[0], dt, att->gyro_bam_q16));
+    att->pitch = (int32_t)((uint32_t)att->pitch + (uint32_t)gyro_to_bam(gyro[1], dt, att->gyro_bam_q16));
+    att->yaw = (int32_t)((uint32_t)att->yaw + (uint32_t)gyro_to_bam(gyro[2], dt, att->gyro_bam_q16));
+
+    if (!accel_ok || dt == 0) {
+        return;
+    }
+
+    // Peso do acelerômetro: dt / (tau + dt) com o máximo de bits
+    // fracionários que cabe em 32 bits (divisor em hardware). Com 16 bits
+    // fixos o truncamento chegava a 0,7% do peso com dt = 1 ms e tau = 1 s.
+    uint8_t shift = __builtin_clz(dt) - 1;
+    int32_t w = (int32_t)((dt << shift) / (att->tau_ms + dt));
+    att->roll = blend(att->roll, cordic_atan2(ay, az), w, shift);
+    att->pitch = blend(att->pitch, cordic_atan2(-ax, isqrt32((uint32_t)(ay * ay) + (uint32_t)(az * az))), w, shift);
+}
+
+// BAM -> centésimos de grau, arredondado
+int32_t attitude_centideg(int32_t bam) {
+    int32_t v = (bam >> 16) * 36000;
+    return (v + (v < 0 ? -32768 : 32768)) / 65536;
+}
+
+static char *put_angle(char *p, int32_t bam) {
+    int32_t centi = attitude_centideg(bam);
+    return csv_put_centi(p, centi, centi < 0);
+}
+
+// Linha "time_s,roll,pitch,yaw" em graus com duas casas decimais
+size_t attitude_format_line(const attitude_t *att, uint32_t time_ms, char *dst) {
+    char *p = csv_put_time(dst, time_ms);
+    *p++ = ',';
+    p = put_angle(p, att->roll);
+    *p++ = ',';
+    p = put_angle(p, att->pitch);
+    *p++ = ',';
+    p = put_angle(p, att->yaw);
+    *p++ = '\n';
+    return p - dst;
+}
+
+// Mede o custo de uma atualização com dados sintéticos
+void attitude_bench() {
+    attitude_t att;
+    const uint32_t updates = 1000;
+    uint32_t cycles = 0;
+
+    attitude_init(&att, ATTITUDE_DEFAULT_TAU_MS);
+    attitude_set_scale(&att, 16384, 1310);
+    for (uint32_t i = 0; i < updates; i++) {
+        int16_t accel[3] = {(int16_t)(i * 7) - 3500, 2000 - (int16_t)(i * 3), 16000};
+        int16_t gyro[3] = {(int16_t)(i % 200) - 100, 50, -(int16_t)(i % 64)};
+        uint32_t start = cycle_counter_get();
+        attitude_update(&att, i * 10, accel, gyro);
+        cycles += cycle_counter_elapsed(start);
+    }
+
+    printf("Atitude: %lu ciclos/atualização\n", (unsigned long)(cycles / updates));
+}
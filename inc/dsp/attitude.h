@@ -0,0 +1,50 @@
+#ifndef ATTITUDE_H
+#define ATTITUDE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Constante de tempo padrão do filtro complementar
+#define ATTITUDE_DEFAULT_TAU_MS 1000
+
+// Linha: tempo e três ângulos com até 8 caracteres cada
+#define ATTITUDE_LINE_MAX 48
+#define ATTITUDE_HEADER "time_s,roll,pitch,yaw\n"
+
+/*
+ Estimador de atitude por filtro complementar, todo em inteiros.
+
+ Os ângulos são guardados como BAM (binary angle measurement): int32 em que
+ 2^32 corresponde a 360°, de modo que a volta de +180° para -180° é o
+ próprio estouro da soma. Roll e pitch integram o giroscópio e são
+ corrigidos em direção ao ângulo do vetor gravidade medido pelo
+ acelerômetro (atan2 por CORDIC), com peso dt / (tau + dt). A correção é
+ suspensa quando |a| se afasta mais de 25% de 1 g (movimento brusco). Sem
+ magnetômetro, o yaw é só a integral do giroscópio e deriva com o tempo.
+
+ Convenção: roll = atan2(ay, az), pitch = atan2(-ax, sqrt(ay² + az²)),
+ taxas gx, gy e gz, respectivamente.
+*/
+typedef struct {
+    int32_t roll;
+    int32_t pitch;
+    int32_t yaw;
+    uint32_t tau_ms;
+    uint32_t acc_min2;    // Faixa de |a|² (contagens²) em que o acelerômetro é usado
+    uint32_t acc_max2;
+    int32_t gyro_bam_q16; // Contagem * ms -> BAM, em Q16
+    uint32_t last_ms;
+    bool started;
+} attitude_t;
+
+void attitude_init(attitude_t *att, uint32_t tau_ms);
+void attitude_reset(attitude_t *att);
+void attitude_set_scale(attitude_t *att, uint16_t accel_lsb_per_g, uint16_t gyro_lsb_x10);
+void attitude_update(attitude_t *att, uint32_t time_ms, const int16_t accel[3], const int16_t gyro[3]);
+int32_t attitude_centideg(int32_t bam);
+int32_t cordic_atan2(int32_t y, int32_t x);
+size_t attitude_format_line(const attitude_t *att, uint32_t time_ms, char *dst);
+void attitude_bench();
+
+#endif
@@ -0,0 +1,137 @@
+#include <string.h>
+
+#include "decimator.h"
+#include "filter_bank.h"
+
+#define HIST_MASK (DECIM_HIST - 1)
+
+bool decim_stage_init(decim_stage_t *s, uint16_t factor, uint32_t later) {
+    if (factor < 2 || factor > DECIM_MAX_FACTOR || later == 0) {
+        return false;
+    }
+
+    memset(s, 0, sizeof(*s));
+    s->factor = factor;
+
+    // Cerca de 4 coeficientes por fator, limitado ao tamanho do histórico
+    // (o que define DECIM_MAX_FACTOR)
+    uint16_t taps = 4 * factor + 1;
+    s->taps = taps > DECIM_MAX_TAPS ? DECIM_MAX_TAPS : taps;
+
+    // Corte na nova frequência de Nyquist (fs / 2 / factor), com a banda de
+    // rejeição a partir de 1,7 vez ela. Num estágio seguido de outros com
+    // fator 'later', o que fica entre fs / factor - 1,7 vez a Nyquist final
+    // e fs / factor rebate para abaixo de 1,7 vez a Nyquist final, onde os
+    // estágios seguintes não atenuam; a rejeição deste estágio tem de
+    // começar antes disso, então o corte desce para (1,3 - 1,7 / later)
+    // vez a nova Nyquist quando isso é menor que 1.
+    float scale = later > 1 ? 1.3f - 1.7f / later : 1.0f;
+    fir_design_lowpass(s->coef, s->taps, (scale < 1.0f ? scale : 1.0f) * 0.5f / factor);
+    decim_stage_reset(s);
+    return true;
+}
+
+// Descarta o histórico, mantendo os coeficientes. A primeira saída sai
+// quando a primeira amostra chega ao centro da janela, então as saídas
+// correspondem às amostras 0, factor, 2 * factor, ... da entrada.
+void decim_stage_reset(decim_stage_t *s) {
+    s->pos = 0;
+    s->phase = s->factor - 1 - s->taps / 2;
+    s->primed = false;
+}
+
+// Acrescenta uma amostra. Retorna true quando uma nova saída está em s->out.
+bool decim_stage_push(decim_stage_t *s, uint32_t time_ms, const int16_t in[DECIM_AXES]) {
+    // A primeira amostra preenche o histórico para evitar o transitório inicial
+    uint8_t copies = s->primed ? 1 : DECIM_HIST;
+    for (uint8_t k = 0; k < copies; k++) {
+        for (uint8_t a = 0; a < DECIM_AXES; a++) {
+            s->hist[a][s->pos] = in[a];
+        }
+        s->time[s->pos] = time_ms;
+        s->pos = (s->pos + 1) & HIST_MASK;
+    }
+    s->primed = true;
+
+    if (++s->phase < s->factor) {
+        return false;
+    }
+    s->phase = 0;
+
+    // A amostra mais recente está em pos - 1. Como a soma de |coef| fica bem
+    // abaixo de 2.0 em Q15, o acumulador de 32 bits não transborda.
+    uint8_t newest = (s->pos - 1) & HIST_MASK;
+    for (uint8_t a = 0; a < DECIM_AXES; a++) {
+        const int16_t *x = s->hist[a];
+        int32_t acc = 1 << 14;
+        for (uint8_t k = 0; k < s->taps; k++) {
+            acc += (int32_t)s->coef[k] * x[(newest - k) & HIST_MASK];
+        }
+        acc >>= 15;
+        s->out[a] = acc > INT16_MAX ? INT16_MAX : acc < INT16_MIN ? INT16_MIN : acc;
+    }
+
+    // Filtro de fase linear: a saída corresponde à amostra central da janela
+    s->out_time = s->time[(newest - s->taps / 2) & HIST_MASK];
+    return true;
+}
+
+// Configura a cascata com count fatores. count == 0 desliga a decimação.
+bool decim_chain_config(decim_chain_t *c, const uint16_t *factors, uint8_t count) {
+    if (count > DECIM_MAX_STAGES) {
+        return false;
+    }
+
+    // Fator dos estágios seguintes a cada um
+    uint32_t later[DECIM_MAX_STAGES];
+    uint32_t product = 1;
+    for (uint8_t i = count; i-- > 0;) {
+        later[i] = product;
+        product *= factors[i];
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (!decim_stage_init(&c->stage[i], factors[i], later[i])) {
+            c->stages = 0;
+            return false;
+        }
+    }
+
+    c->stages = count;
+    return true;
+}
+
+void decim_chain_reset(decim_chain_t *c) {
+    for (uint8_t i = 0; i < c->stages; i++) {
+        decim_stage_reset(&c->stage[i]);
+    }
+}
+
+// Passa a amostra pela cascata. Retorna uma máscara com um bit por estágio
+// que produziu saída nesta chamada.
+uint8_t decim_chain_push(decim_chain_t *c, uint32_t time_ms, const int16_t accel[3], const int16_t gyro[3]) {
+    int16_t in[DECIM_AXES] = {accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2]};
+    const int16_t *x = in;
+    uint8_t mask = 0;
+
+    for (uint8_t i = 0; i < c->stages; i++) {
+        decim_stage_t *s = &c->stage[i];
+        if (!decim_stage_push(s, time_ms, x)) {
+            break;
+        }
+        mask |= 1u << i;
+        time_ms = s->out_time;
+        x = s->out;
+    }
+
+    return mask;
+}
+
+// Fator acumulado até o estágio indicado (taxa bruta / taxa do estágio)
+uint32_t decim_chain_total_factor(const decim_chain_t *c, uint8_t stage) {
+    uint32_t total = 1;
+    for (uint8_t i = 0; i <= stage && i < c->stages; i++) {
+        total *= c->stage[i].factor;
+    }
+    return total;
+}
@@ -0,0 +1,61 @@
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Eixos filtrados: acel x/y/z e giro x/y/z (contagens do sensor)
+#define DECIM_AXES 6
+
+// Histórico de cada estágio (potência de 2) e número máximo de coeficientes
+#define DECIM_HIST 32
+#define DECIM_MAX_TAPS (DECIM_HIST - 1)
+
+#define DECIM_MAX_STAGES 3
+// Com DECIM_MAX_TAPS coeficientes o FIR atenua mais de 30 dB a partir de
+// 1,7 vez a nova frequência de Nyquist só até o fator 8. Reduções maiores
+// usam estágios em cascata (1 kHz -> 10 Hz: "decim 5 5 4").
+#define DECIM_MAX_FACTOR 8
+
+/*
+ Cada estágio aplica um FIR passa-baixas (sinc janelado, coeficientes em
+ Q15) e mantém uma saída a cada 'factor' entradas. O filtro só é calculado
+ quando há saída, então o custo por amostra de entrada é o de copiar a
+ amostra para o histórico.
+
+ Os estágios ficam em cascata: a saída do estágio k é a entrada do k+1,
+ e a taxa final do estágio k é a taxa bruta dividida pelo produto dos
+ fatores até ele. Os estágios intermediários cortam abaixo da própria
+ Nyquist quando preciso (decim_stage_init) para que a cascata mantenha os
+ 30 dB a partir de 1,7 vez a Nyquist final; host_test/decimator.c confere.
+*/
+typedef struct {
+    uint16_t factor;
+    uint8_t taps;
+    uint8_t pos;       // Próxima posição livre no histórico
+    int16_t phase;     // Entradas desde a última saída (negativa até a primeira)
+    bool primed;       // Histórico já preenchido com a primeira amostra
+    int16_t coef[DECIM_MAX_TAPS];
+    int16_t hist[DECIM_AXES][DECIM_HIST];
+    uint32_t time[DECIM_HIST];
+
+    // Última saída produzida
+    uint32_t out_time;
+    int16_t out[DECIM_AXES];
+} decim_stage_t;
+
+typedef struct {
+    uint8_t stages;
+    decim_stage_t stage[DECIM_MAX_STAGES];
+} decim_chain_t;
+
+bool decim_stage_init(decim_stage_t *s, uint16_t factor, uint32_t later);
+void decim_stage_reset(decim_stage_t *s);
+bool decim_stage_push(decim_stage_t *s, uint32_t time_ms, const int16_t in[DECIM_AXES]);
+
+bool decim_chain_config(decim_chain_t *c, const uint16_t *factors, uint8_t count);
+void decim_chain_reset(decim_chain_t *c);
+uint8_t decim_chain_push(decim_chain_t *c, uint32_t time_ms, const int16_t accel[3], const int16_t gyro[3]);
+uint32_t decim_chain_total_factor(const decim_chain_t *c, uint8_t stage);
+
+#endif
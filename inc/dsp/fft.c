@@ -0,0 +1,86 @@
+#include <math.h>
+#include <stdbool.h>
+
+#include "fft.h"
+
+// cos e -sin de 2*pi*k/FFT_MAX_N em Q15, e a janela de Hann para FFT_MAX_N
+static int16_t twiddle_cos[FFT_MAX_N / 2];
+static int16_t twiddle_sin[FFT_MAX_N / 2];
+static int16_t hann[FFT_MAX_N];
+static bool fft_ready = false;
+
+static int16_t to_q15(float v) {
+    int32_t q = lroundf(v * 32768.0f);
+    return q > INT16_MAX ? INT16_MAX : q < INT16_MIN ? INT16_MIN : q;
+}
+
+// Calcula as tabelas uma única vez (float só na inicialização)
+void fft_init() {
+    if (fft_ready) {
+        return;
+    }
+
+    for (uint16_t k = 0; k < FFT_MAX_N / 2; k++) {
+        float a = 2.0f * (float)M_PI * k / FFT_MAX_N;
+        twiddle_cos[k] = to_q15(cosf(a));
+        twiddle_sin[k] = to_q15(-sinf(a));
+    }
+    for (uint16_t k = 0; k < FFT_MAX_N; k++) {
+        hann[k] = to_q15(0.5f - 0.5f * cosf(2.0f * (float)M_PI * k / FFT_MAX_N));
+    }
+    fft_ready = true;
+}
+
+// Janela de Hann periódica com FFT_MAX_N pontos; para n pontos use o passo
+// FFT_MAX_N / n
+const int16_t *fft_hann_table() {
+    fft_init();
+    return hann;
+}
+
+static void bit_reverse(cq15_t *x, uint16_t n) {
+    uint16_t j = 0;
+    for (uint16_t i = 0; i < n - 1; i++) {
+        if (i < j) {
+            cq15_t t = x[i];
+            x[i] = x[j];
+            x[j] = t;
+        }
+        uint16_t bit = n >> 1;
+        while (j & bit) {
+            j ^= bit;
+            bit >>= 1;
+        }
+        j |= bit;
+    }
+}
+
+void fft_q15(cq15_t *x, uint16_t n) {
+    fft_init();
+    bit_reverse(x, n);
+
+    for (uint16_t half = 1; half < n; half <<= 1) {
+        uint16_t step = FFT_MAX_N / (2 * half);
+
+        for (uint16_t k = 0; k < half; k++) {
+            int32_t wr = twiddle_cos[k * step];
+            int32_t wi = twiddle_sin[k * step];
+
+            for (uint16_t i = k; i < n; i += 2 * half) {
+                cq15_t *a = &x[i];
+                cq15_t *b = &x[i + half];
+
+                // t = b * w em Q15; a soma final é dividida por 2 (escala do estágio)
+                int32_t tr = (b->re * wr - b->im * wi) >> 15;
+                int32_t ti = (b->re * wi + b->im * wr) >> 15;
+                int32_t ar = a->re;
+                int32_t ai = a->im;
+
+                a->re = (ar + tr) >> 1;
+                a->im = (ai + ti) >> 1;
+                b->re = (ar - tr) >> 1;
+                b->im = (ai - ti) >> 1;
+            }
+        }
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <stdint.h>
+
+// Maior transformada suportada; as tabelas são calculadas para este tamanho
+#define FFT_MAX_LOG2 9
+#define FFT_MAX_N (1 << FFT_MAX_LOG2)
+#define FFT_MIN_N 64
+
+typedef struct {
+    int16_t re;
+    int16_t im;
+} cq15_t;
+
+/*
+ FFT radix-2 com decimação no tempo, no lugar, em Q15. Cada estágio divide
+ o resultado por 2, então a saída é X[k] / n e não há estouro para
+ qualquer entrada em Q15. Os fatores de giro vêm de uma tabela de
+ FFT_MAX_N / 2 entradas, percorrida com passo FFT_MAX_N / n para
+ transformadas menores.
+*/
+void fft_init();
+void fft_q15(cq15_t *x, uint16_t n);
+const int16_t *fft_hann_table();
+
+#endif
@@ -0,0 +1,273 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "filter_bank.h"
+#include "inc/cycle_counter/cycle_counter.h"
+#include "hardware/clocks.h"
+
+#define FIR_MASK (FILTER_MAX_FIR - 1)
+#define BIQUAD_ONE (1 << BIQUAD_COEF_SHIFT)
+
+static inline int16_t sat16(int32_t v) {
+    return v > INT16_MAX ? INT16_MAX : v < INT16_MIN ? INT16_MIN : v;
+}
+
+static int32_t to_q30(double v) {
+    double q = round(v * BIQUAD_ONE);
+    return q > INT32_MAX ? INT32_MAX : q < INT32_MIN ? INT32_MIN : (int32_t)q;
+}
+
+// Pesos da realimentação do erro pela posição dos polos (-a1 = 2 r cos θ):
+// perto de z = 1 o ruído é moldado por (1 - z^-1)^2, na faixa baixa por
+// (1 - z^-1), no meio não é moldado e perto de z = -1 por (1 + z^-1).
+// Escolha feita com data_plot/filter_ref.py em cortes de 0,0005 a 0,45 fs.
+static void error_feedback_taps(biquad_coef_t *c) {
+    int32_t minus_a1 = -c->a1;
+    if (minus_a1 > BIQUAD_ONE + BIQUAD_ONE / 2) {
+        c->k1 = 2;
+        c->k2 = -1;
+    } else if (minus_a1 > 0) {
+        c->k1 = 1;
+        c->k2 = 0;
+    } else if (minus_a1 > -BIQUAD_ONE) {
+        c->k1 = 0;
+        c->k2 = 0;
+    } else {
+        c->k1 = -1;
+        c->k2 = 0;
+    }
+}
+
+static float windowed_sinc(uint8_t i, uint8_t taps, float fc) {
+    float n = i - (taps - 1) / 2.0f;
+    float sinc = (n == 0.0f) ? 2.0f * fc : sinf(2.0f * (float)M_PI * fc * n) / ((float)M_PI * n);
+    float window = taps > 1 ? 0.54f - 0.46f * cosf(2.0f * (float)M_PI * i / (taps - 1)) : 1.0f;
+    return sinc * window;
+}
+
+// FIR passa-baixas por sinc janelado (Hamming), fc em ciclos por amostra.
+// Coeficientes em Q15 com soma exatamente 32768 (ganho unitário em DC).
+// Os valores são calculados duas vezes para não precisar de um buffer de
+// floats na pilha.
+void fir_design_lowpass(int16_t *coef, uint8_t taps, float fc) {
+    float sum = 0.0f;
+    for (uint8_t i = 0; i < taps; i++) {
+        sum += windowed_sinc(i, taps, fc);
+    }
+
+    // O erro de arredondamento vai para o coeficiente central
+    int32_t total = 0;
+    for (uint8_t i = 0; i < taps; i++) {
+        coef[i] = (int16_t)lroundf(windowed_sinc(i, taps, fc) / sum * 32768.0f);
+        total += coef[i];
+    }
+    coef[taps / 2] += 32768 - total;
+}
+
+// Projeta uma cascata Butterworth de ordem 2 * sections (fórmulas do RBJ
+// Audio EQ Cookbook). Só roda na configuração; o float não afeta a coleta.
+bool filter_bank_set_biquads(filter_bank_t *f, filter_type_t type, float fc_hz, float fs_hz, uint8_t sections) {
+    if (sections > FILTER_MAX_BIQUADS || fc_hz <= 0.0f || fc_hz >= fs_hz / 2.0f) {
+        return false;
+    }
+
+    double w0 = 2.0 * M_PI * fc_hz / fs_hz;
+    double cw = cos(w0);
+    uint8_t order = 2 * sections;
+
+    for (uint8_t k = 0; k < sections; k++) {
+        double q = 1.0 / (2.0 * cos(M_PI * (2 * k + 1) / (2.0 * order)));
+        double alpha = sin(w0) / (2.0 * q);
+        double a0 = 1.0 + alpha;
+        biquad_coef_t *c = &f->coef[k];
+
+        c->a1 = to_q30(-2.0 * cw / a0);
+        c->a2 = to_q30((1.0 - alpha) / a0);
+
+        // b1 é ajustado depois da quantização para que o ganho em DC seja
+        // exatamente 1 (passa-baixas) ou exatamente 0 (passa-altas)
+        if (type == FILTER_LOWPASS) {
+            c->b0 = to_q30((1.0 - cw) / 2.0 / a0);
+            c->b2 = c->b0;
+            c->b1 = (int32_t)((int64_t)BIQUAD_ONE + c->a1 + c->a2 - c->b0 - c->b2);
+        } else {
+            c->b0 = to_q30((1.0 + cw) / 2.0 / a0);
+            c->b2 = c->b0;
+            c->b1 = -(c->b0 + c->b2);
+        }
+        error_feedback_taps(c);
+    }
+
+    f->biquads = sections;
+    filter_bank_reset(f);
+    return true;
+}
+
+bool filter_bank_set_fir(filter_bank_t *f, uint8_t taps, float fc_hz, float fs_hz) {
+    if (taps > FILTER_MAX_FIR || (taps > 0 && (fc_hz <= 0.0f || fc_hz >= fs_hz / 2.0f))) {
+        return false;
+    }
+
+    if (taps > 0) {
+        fir_design_lowpass(f->fir_coef, taps, fc_hz / fs_hz);
+    }
+    f->fir_taps = taps;
+    filter_bank_reset(f);
+    return true;
+}
+
+void filter_bank_clear(filter_bank_t *f) {
+    memset(f, 0, sizeof(*f));
+}
+
+// Zera o estado dos filtros, mantendo os coeficientes
+void filter_bank_reset(filter_bank_t *f) {
+    memset(f->state, 0, sizeof(f->state));
+    memset(f->fir_hist, 0, sizeof(f->fir_hist));
+    f->fir_pos = 0;
+}
+
+// coef * x = (coef >> 16) * x * 2^16 + (coef & 0xFFFF) * x. As duas partes
+// cabem em 32 bits (|coef & 0xFFFF| * |x| < 2^31) e são acumuladas à parte.
+#define BIQUAD_MAC(hi, lo, c, x) do {           \
+        hi += (int32_t)((c) >> 16) * (x);       \
+        lo += (int32_t)((c) & 0xFFFF) * (x);    \
+    } while (0)
+
+#define BIQUAD_MSC(hi, lo, c, x) do {           \
+        hi -= (int32_t)((c) >> 16) * (x);       \
+        lo -= (int32_t)((c) & 0xFFFF) * (x);    \
+    } while (0)
+
+int16_t biquad_process(const biquad_coef_t *c, biquad_state_t *s, int16_t x) {
+    int64_t hi = 0;
+    int64_t lo = 0;
+    BIQUAD_MAC(hi, lo, c->b0, x);
+    BIQUAD_MAC(hi, lo, c->b1, s->x1);
+    BIQUAD_MAC(hi, lo, c->b2, s->x2);
+    BIQUAD_MSC(hi, lo, c->a1, s->y1);
+    BIQUAD_MSC(hi, lo, c->a2, s->y2);
+
+    // Com k em [-1, 2] e os restos em [0, 2^30) a soma cabe em 32 bits
+    int32_t feedback = c->k1 * s->err1 + c->k2 * s->err2;
+    int64_t acc = hi * 65536 + lo + feedback;
+    int64_t q = acc >> BIQUAD_COEF_SHIFT;
+    s->err2 = s->err1;
+    s->err1 = (int32_t)(acc - (q << BIQUAD_COEF_SHIFT));
+
+    int16_t y = sat16(q > INT32_MAX ? INT32_MAX : q < INT32_MIN ? INT32_MIN : (int32_t)q);
+    if (y != q) {
+        s->err1 = 0; // Sem realimentação do erro quando há saturação
+    }
+
+    s->x2 = s->x1;
+    s->x1 = x;
+    s->y2 = s->y1;
+    s->y1 = y;
+    return y;
+}
+
+// Filtra as amostras no lugar: biquads em cascata e depois o FIR
+void filter_bank_process(filter_bank_t *f, int16_t accel[3], int16_t gyro[3]) {
+    int16_t *axis[FILTER_AXES] = {&accel[0], &accel[1], &accel[2], &gyro[0], &gyro[1], &gyro[2]};
+
+    for (uint8_t a = 0; a < FILTER_AXES; a++) {
+        int16_t x = *axis[a];
+
+        for (uint8_t k = 0; k < f->biquads; k++) {
+            x = biquad_process(&f->coef[k], &f->state[a][k], x);
+        }
+
+        if (f->fir_taps > 0) {
+            // A soma de |coef| de um passa-baixas janelado fica abaixo de 2.0
+            // em Q15, então o acumulador de 32 bits não transborda
+            int16_t *hist = f->fir_hist[a];
+            hist[f->fir_pos] = x;
+
+            int32_t acc = 1 << 14;
+            for (uint8_t k = 0; k < f->fir_taps; k++) {
+                acc += (int32_t)f->fir_coef[k] * hist[(f->fir_pos - k) & FIR_MASK];
+            }
+            x = sat16(acc >> 15);
+        }
+
+        *axis[a] = x;
+    }
+
+    f->fir_pos = (f->fir_pos + 1) & FIR_MASK;
+}
+
+void filter_bank_print(const filter_bank_t *f) {
+    if (f->biquads == 0 && f->fir_taps == 0) {
+        printf("Filtros desligados\n");
+        return;
+    }
+
+    for (uint8_t k = 0; k < f->biquads; k++) {
+        const biquad_coef_t *c = &f->coef[k];
+        printf("Biquad %d (Q30): b = %ld %ld %ld, a = %ld %ld, erro %d %d\n", k + 1, (long)c->b0,
+            (long)c->b1, (long)c->b2, (long)c->a1, (long)c->a2, c->k1, c->k2);
+    }
+    if (f->fir_taps > 0) {
+        printf("FIR %d coeficientes (Q15):", f->fir_taps);
+        for (uint8_t k = 0; k < f->fir_taps; k++) {
+            printf(" %d", f->fir_coef[k]);
+        }
+        printf("\n");
+    }
+}
+
+// Mede a carga de cada tipo de filtro e da configuração atual
+void filter_bank_bench(const filter_bank_t *f) {
+    static filter_bank_t test;
+    const uint32_t samples = 512;
+    uint32_t cycles;
+
+    // Um biquad em um canal
+    filter_bank_clear(&test);
+    filter_bank_set_biquads(&test, FILTER_LOWPASS, 5.0f, 100.0f, 1);
+    cycles = 0;
+    for (uint32_t i = 0; i < samples; i++) {
+        int16_t x = (i & 32) ? 12000 : -12000;
+        uint32_t start = cycle_counter_get();
+        biquad_process(&test.coef[0], &test.state[0][0], x);
+        cycles += cycle_counter_elapsed(start);
+    }
+    uint32_t biquad_cycles = cycles / samples;
+
+    // FIR completo nos seis canais, dividido por canal e por coeficiente
+    filter_bank_clear(&test);
+    filter_bank_set_fir(&test, FILTER_MAX_FIR, 5.0f, 100.0f);
+    cycles = 0;
+    for (uint32_t i = 0; i < samples; i++) {
+        int16_t accel[3] = {i, -i, 2 * i};
+        int16_t gyro[3] = {-2 * i, 3 * i, -3 * i};
+        uint32_t start = cycle_counter_get();
+        filter_bank_process(&test, accel, gyro);
+        cycles += cycle_counter_elapsed(start);
+    }
+    uint32_t fir_cycles = cycles / samples / FILTER_AXES;
+
+    // Configuração atual, sobre uma cópia para não alterar o estado
+    test = *f;
+    cycles = 0;
+    for (uint32_t i = 0; i < samples; i++) {
+        int16_t accel[3] = {i, -i, 2 * i};
+        int16_t gyro[3] = {-2 * i, 3 * i, -3 * i};
+        uint32_t start = cycle_counter_get();
+        filter_bank_process(&test, accel, gyro);
+        cycles += cycle_counter_elapsed(start);
+    }
+    uint32_t total_cycles = cycles / samples;
+    uint32_t clk = clock_get_hz(clk_sys);
+
+    printf("Biquad: %lu ciclos/amostra/canal por seção\n", (unsigned long)biquad_cycles);
+    printf("FIR %d coef: %lu ciclos/amostra/canal (%lu por coef)\n", FILTER_MAX_FIR,
+        (unsigned long)fir_cycles, (unsigned long)(fir_cycles / FILTER_MAX_FIR));
+    printf("Atual (%d biquads, FIR %d): %lu ciclos/amostra nos %d canais\n", f->biquads, f->fir_taps,
+        (unsigned long)total_cycles, FILTER_AXES);
+    if (total_cycles > 0) {
+        printf("Taxa máxima com 50%% da CPU: %lu Hz\n", (unsigned long)(clk / 2 / total_cycles));
+    }
+}
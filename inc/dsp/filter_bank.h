@@ -0,0 +1,68 @@
+#ifndef FILTER_BANK_H
+#define FILTER_BANK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Eixos filtrados: acel x/y/z e giro x/y/z (contagens do sensor)
+#define FILTER_AXES 6
+
+#define FILTER_MAX_BIQUADS 4
+#define FILTER_MAX_FIR 16 // Potência de 2: o histórico é um buffer circular
+
+// Coeficientes dos biquads em Q2.30 (faixa ±2), os do FIR em Q15
+#define BIQUAD_COEF_SHIFT 30
+
+typedef enum {
+    FILTER_LOWPASS,
+    FILTER_HIGHPASS
+} filter_type_t;
+
+/*
+ Biquad na forma direta I:
+   y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+ Com cortes baixos (fc < 0.01 fs) os polos ficam perto de z = 1 e
+ coeficientes de 16 bits deslocam a resposta de forma visível, por isso
+ eles têm 32 bits. O M0+ não tem multiplicação 32x32->64, então cada
+ produto coef * x é feito em duas metades de 16 bits com o MULS de 32 bits
+ e somado em 64 bits (só ADDS/ADCS). Os restos dos dois últimos
+ deslocamentos são realimentados (error feedback) com pesos inteiros k1 e
+ k2, escolhidos pela posição dos polos: com polos perto de z = 1 (corte
+ baixo) o ruído de arredondamento passaria pelo ganho alto de 1/A(z) em
+ baixas frequências, e (2, -1) cancela esse ganho. O erro em relação à
+ precisão dupla fica abaixo de 2 LSB por seção, de 0,001 a 0,45 fs
+ (data_plot/filter_ref.py).
+*/
+typedef struct {
+    int32_t b0, b1, b2, a1, a2;
+    int8_t k1, k2; // Pesos da realimentação do erro
+} biquad_coef_t;
+
+typedef struct {
+    int16_t x1, x2, y1, y2;
+    int32_t err1, err2; // Restos dos últimos deslocamentos, em [0, 2^30)
+} biquad_state_t;
+
+// Cascata de biquads seguida de um FIR curto, aplicada aos seis eixos
+typedef struct {
+    uint8_t biquads;
+    uint8_t fir_taps;
+    uint8_t fir_pos;
+    biquad_coef_t coef[FILTER_MAX_BIQUADS];
+    int16_t fir_coef[FILTER_MAX_FIR];
+    biquad_state_t state[FILTER_AXES][FILTER_MAX_BIQUADS];
+    int16_t fir_hist[FILTER_AXES][FILTER_MAX_FIR];
+} filter_bank_t;
+
+void fir_design_lowpass(int16_t *coef, uint8_t taps, float fc);
+
+bool filter_bank_set_biquads(filter_bank_t *f, filter_type_t type, float fc_hz, float fs_hz, uint8_t sections);
+bool filter_bank_set_fir(filter_bank_t *f, uint8_t taps, float fc_hz, float fs_hz);
+void filter_bank_clear(filter_bank_t *f);
+void filter_bank_reset(filter_bank_t *f);
+int16_t biquad_process(const biquad_coef_t *c, biquad_state_t *s, int16_t x);
+void filter_bank_process(filter_bank_t *f, int16_t accel[3], int16_t gyro[3]);
+void filter_bank_print(const filter_bank_t *f);
+void filter_bank_bench(const filter_bank_t *f);
+
+#endif
@@ -0,0 +1,210 @@
+#include <stdio.h>
+
+#include "spectrum.h"
+#include "fixed_math.h"
+#include "inc/cycle_counter/cycle_counter.h"
+#include "inc/log_codec/csv_format.h"
+#include "hardware/clocks.h"
+
+static const char *spectrum_axis_name[SPECTRUM_AXES] = {"ax", "ay", "az", "gx", "gy", "gz"};
+
+// Área de trabalho da FFT, compartilhada pelos eixos
+static cq15_t fft_buf[FFT_MAX_N];
+
+bool spectrum_init(spectrum_t *s, uint16_t n) {
+    if (n < FFT_MIN_N || n > FFT_MAX_N || (n & (n - 1)) != 0) {
+        return false;
+    }
+    s->n = n;
+    spectrum_reset(s);
+    fft_init();
+    return true;
+}
+
+// Inicia uma nova janela, mantendo o tamanho configurado
+void spectrum_reset(spectrum_t *s) {
+    s->count = 0;
+    s->first_ms = 0;
+    s->last_ms = 0;
+}
+
+// Acrescenta uma amostra. Retorna true quando a janela está completa; o
+// chamador chama spectrum_process, grava as linhas e chama spectrum_reset.
+bool spectrum_push(spectrum_t *s, uint32_t time_ms, const int16_t accel[3], const int16_t gyro[3]) {
+    if (s->count == 0) {
+        s->first_ms = time_ms;
+    }
+    s->last_ms = time_ms;
+
+    s->samples[0][s->count] = accel[0];
+    s->samples[1][s->count] = accel[1];
+    s->samples[2][s->count] = accel[2];
+    s->samples[3][s->count] = gyro[0];
+    s->samples[4][s->count] = gyro[1];
+    s->samples[5][s->count] = gyro[2];
+
+    return ++s->count >= s->n;
+}
+
+static inline uint32_t bin_power(const cq15_t *x) {
+    return (uint32_t)(x->re * x->re) + (uint32_t)(x->im * x->im);
+}
+
+// Desfaz o deslocamento aplicado antes da FFT (shift == -1: entrada dividida por 2)
+static uint32_t unscale(uint32_t v, int8_t shift) {
+    if (shift < 0) {
+        return v << 1;
+    }
+    return shift ? (v + (1u << (shift - 1))) >> shift : v;
+}
+
+static void process_axis(spectrum_t *s, const int16_t *x, spectrum_result_t *r) {
+    const int16_t *hann = fft_hann_table();
+    uint16_t n = s->n;
+    uint16_t step = FFT_MAX_N / n;
+
+    // Média e maior desvio da janela
+    int32_t sum = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        sum += x[i];
+    }
+    int32_t mean = (sum + (sum < 0 ? -(int32_t)(n / 2) : n / 2)) / n;
+
+    uint32_t max_dev = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        int32_t d = x[i] - mean;
+        uint32_t ad = d < 0 ? -d : d;
+        if (ad > max_dev) {
+            max_dev = ad;
+        }
+    }
+
+    // Deslocamento que leva o maior desvio para perto de 2^15 (desvios
+    // acima de 32767 só existem com o sensor em fundo de escala)
+    int8_t shift = 0;
+    if (max_dev > INT16_MAX) {
+        shift = -1;
+    } else if (max_dev > 0) {
+        while (shift < 15 && (max_dev << (shift + 1)) <= INT16_MAX) {
+            shift++;
+        }
+    }
+
+    for (uint16_t i = 0; i < n; i++) {
+        int32_t d = x[i] - mean;
+        fft_buf[i].re = (int16_t)((d * hann[i * step]) >> (15 - shift));
+        fft_buf[i].im = 0;
+    }
+
+    fft_q15(fft_buf, n);
+
+    // Saída da FFT = X[k] / n. Com a janela de Hann, uma senoide de
+    // amplitude A gera |X[k]| / n = A / 4 no bin central, e o RMS da faixa é
+    // sqrt(16 / 3 * soma |X[k] / n|²) (ganho de potência da janela = 3 / 8)
+    uint16_t half = n / 2;
+    uint16_t band_width = half / SPECTRUM_BANDS;
+    uint64_t band_sum = 0;
+    uint32_t peak_power = 0;
+    uint16_t peak = 1;
+
+    for (uint16_t k = 1; k < half; k++) {
+        uint32_t p = bin_power(&fft_buf[k]);
+        band_sum += p;
+        if (p > peak_power) {
+            peak_power = p;
+            peak = k;
+        }
+        if ((k + 1) % band_width == 0) {
+            r->band_rms[k / band_width] = unscale(isqrt64(band_sum * 160000 / 3), shift);
+            band_sum = 0;
+        }
+    }
+
+    // Interpolação parabólica com os bins vizinhos, em 1/256 de bin
+    int32_t m0 = isqrt32(bin_power(&fft_buf[peak - 1]));
+    int32_t m1 = isqrt32(peak_power);
+    int32_t m2 = isqrt32(bin_power(&fft_buf[peak + 1]));
+    int32_t den = 2 * m1 - m0 - m2;
+    int32_t bin_q8 = peak * 256;
+    if (den > 0) {
+        bin_q8 += (m2 - m0) * 128 / den;
+    }
+
+    r->peak_hz = (uint32_t)(((uint64_t)bin_q8 * s->fs_centi + (n * 128)) / (n * 256));
+
+    // Amplitude pela energia do pico e dos dois vizinhos, que contêm quase
+    // toda a energia de uma senoide (A² / 2 = 16 / 3 * soma), o que evita a
+    // perda de até 1.4 dB quando a frequência cai entre dois bins
+    uint64_t peak_energy = (uint64_t)bin_power(&fft_buf[peak - 1]) + peak_power + bin_power(&fft_buf[peak + 1]);
+    r->peak_amp = unscale(isqrt64(peak_energy * 320000 / 3), shift);
+}
+
+// Calcula o espectro dos seis eixos da janela completa
+void spectrum_process(spectrum_t *s) {
+    uint32_t span = s->last_ms - s->first_ms;
+    s->fs_centi = span ? (uint32_t)(((uint64_t)(s->count - 1) * 100000 + span / 2) / span) : 0;
+
+    for (uint8_t a = 0; a < SPECTRUM_AXES; a++) {
+        process_axis(s, s->samples[a], &s->result[a]);
+    }
+}
+
+// Linha de um eixo: "time_s,fs_hz,axis,peak_hz,peak_amp,band1..band4"
+size_t spectrum_format_line(const spectrum_t *s, uint8_t axis, char *dst) {
+    const spectrum_result_t *r = &s->result[axis];
+    char *p = csv_put_time(dst, s->first_ms);
+
+    *p++ = ',';
+    p = csv_put_centi(p, s->fs_centi, false);
+    *p++ = ',';
+    for (const char *name = spectrum_axis_name[axis]; *name; name++) {
+        *p++ = *name;
+    }
+    *p++ = ',';
+    p = csv_put_centi(p, r->peak_hz, false);
+    *p++ = ',';
+    p = csv_put_centi(p, r->peak_amp, false);
+    for (uint8_t b = 0; b < SPECTRUM_BANDS; b++) {
+        *p++ = ',';
+        p = csv_put_centi(p, r->band_rms[b], false);
+    }
+
+    *p++ = '\n';
+    return p - dst;
+}
+
+// Mede a FFT e o processamento completo da janela para cada tamanho, e a
+// taxa de amostragem que deixa metade da CPU para a coleta e o cartão SD
+void spectrum_bench() {
+    static spectrum_t test;
+    uint32_t clk = clock_get_hz(clk_sys);
+
+    for (uint16_t n = FFT_MIN_N; n <= FFT_MAX_N; n <<= 1) {
+        spectrum_init(&test, n);
+        for (uint16_t i = 0; i < n; i++) {
+            int16_t v = (int16_t)((i * 2654435761u) >> 20) - 2048;
+            int16_t accel[3] = {v, -v, 16384 + v / 2};
+            int16_t gyro[3] = {v / 4, 3 * v, -v};
+            spectrum_push(&test, i * 10, accel, gyro);
+        }
+
+        for (uint16_t i = 0; i < n; i++) {
+            fft_buf[i].re = test.samples[0][i];
+            fft_buf[i].im = 0;
+        }
+        uint32_t start = cycle_counter_get();
+        fft_q15(fft_buf, n);
+        uint32_t fft_cycles = cycle_counter_elapsed(start);
+
+        start = cycle_counter_get();
+        spectrum_process(&test);
+        uint32_t cycles = cycle_counter_elapsed(start);
+
+        printf("FFT %3d pontos: %6lu ciclos/eixo, janela %7lu ciclos (%lu us, %lu ciclos/amostra)\n", n,
+            (unsigned long)fft_cycles, (unsigned long)cycles, (unsigned long)((uint64_t)cycles * 1000000 / clk),
+            (unsigned long)(cycles / n));
+        if (cycles > 0) {
+            printf("  Taxa máxima com 50%% da CPU: %lu Hz\n", (unsigned long)((uint64_t)clk / 2 * n / cycles));
+        }
+    }
+}
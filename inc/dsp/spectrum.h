@@ -0,0 +1,56 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "fft.h"
+
+// Eixos analisados: acel x/y/z e giro x/y/z (contagens do sensor)
+#define SPECTRUM_AXES 6
+#define SPECTRUM_BANDS 4
+#define SPECTRUM_DEFAULT_N 256
+
+// Linha: tempo, fs, eixo, pico (Hz e amplitude) e as bandas
+#define SPECTRUM_LINE_MAX 112
+#define SPECTRUM_HEADER "time_s,fs_hz,axis,peak_hz,peak_amp,band1,band2,band3,band4\n"
+
+// Resultado de um eixo. Frequências em centésimos de Hz, amplitudes em
+// centésimos de contagem do sensor.
+typedef struct {
+    uint32_t peak_hz;
+    uint32_t peak_amp;
+    uint32_t band_rms[SPECTRUM_BANDS];
+} spectrum_result_t;
+
+/*
+ Espectro por janelas consecutivas (sem sobreposição) de n amostras. Ao
+ completar a janela, cada eixo tem a média removida, recebe a janela de
+ Hann e passa pela FFT em Q15. Antes da FFT as amostras são deslocadas
+ para ocupar a faixa de 16 bits (ponto flutuante por bloco), o que mantém
+ a resolução de sinais pequenos; o deslocamento é desfeito nos resultados.
+
+ Para cada eixo são gravados o pico (excluindo o DC, com interpolação
+ parabólica entre bins) e o RMS de SPECTRUM_BANDS faixas de largura igual
+ entre 0 e fs / 2. A amplitude do pico é a de uma senoide; o RMS das
+ faixas já compensa a energia retirada pela janela.
+*/
+typedef struct {
+    uint16_t n;
+    uint16_t count;
+    uint32_t first_ms;
+    uint32_t last_ms;
+    uint32_t fs_centi; // Taxa estimada pelos tempos da janela
+    int16_t samples[SPECTRUM_AXES][FFT_MAX_N];
+    spectrum_result_t result[SPECTRUM_AXES];
+} spectrum_t;
+
+bool spectrum_init(spectrum_t *s, uint16_t n);
+void spectrum_reset(spectrum_t *s);
+bool spectrum_push(spectrum_t *s, uint32_t time_ms, const int16_t accel[3], const int16_t gyro[3]);
+void spectrum_process(spectrum_t *s);
+size_t spectrum_format_line(const spectrum_t *s, uint8_t axis, char *dst);
+void spectrum_bench();
+
+#endif
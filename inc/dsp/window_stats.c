@@ -0,0 +1,150 @@
+#include <string.h>
+
+#include "window_stats.h"
+#include "fixed_math.h"
+#include "inc/log_codec/csv_format.h"
+
+bool wstats_init(wstats_t *w, uint16_t window) {
+    if (window == 0) {
+        return false;
+    }
+    w->window = window;
+    wstats_reset(w);
+    return true;
+}
+
+// Inicia uma nova janela, mantendo o tamanho configurado
+void wstats_reset(wstats_t *w) {
+    w->count = 0;
+    w->start_ms = 0;
+    memset(w->axis, 0, sizeof(w->axis));
+}
+
+// Acrescenta uma amostra. Retorna true quando a janela está completa; o
+// chamador grava o resumo e chama wstats_reset.
+bool wstats_push(wstats_t *w, uint32_t time_ms, const int16_t accel[3], const int16_t gyro[3]) {
+    const int16_t in[WSTATS_AXES] = {accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2]};
+
+    if (w->count == 0) {
+        w->start_ms = time_ms;
+        for (uint8_t a = 0; a < WSTATS_AXES; a++) {
+            w->axis[a].ref = in[a];
+            w->axis[a].min = in[a];
+            w->axis[a].max = in[a];
+        }
+    }
+
+    for (uint8_t a = 0; a < WSTATS_AXES; a++) {
+        wstats_axis_t *s = &w->axis[a];
+        int32_t d = in[a] - s->ref;
+
+        s->sum += d;
+        s->sumsq += (uint64_t)((int64_t)d * d);
+        if (in[a] < s->min) {
+            s->min = in[a];
+        }
+        if (in[a] > s->max) {
+            s->max = in[a];
+        }
+    }
+
+    return ++w->count >= w->window;
+}
+
+// Divisão com arredondamento para o mais próximo (empate para longe do zero)
+static int64_t div_round(int64_t a, uint32_t n) {
+    return a >= 0 ? (a + n / 2) / n : -((-a + n / 2) / n);
+}
+
+void wstats_result(const wstats_t *w, uint8_t axis, wstats_result_t *r) {
+    const wstats_axis_t *s = &w->axis[axis];
+    uint32_t n = w->count ? w->count : 1;
+
+    // Média em centésimos: 100 * (n * ref + sum) / n, arredondada de uma
+    // vez para que os empates não dependam do sinal de ref
+    r->mean = (int32_t)div_round(((int64_t)s->ref * n + s->sum) * 100, n);
+    r->min = s->min;
+    r->max = s->max;
+
+    // n² * var = n * sumsq - sum², exato em 64 bits (ver window_stats.h).
+    // var * 100 = m / n² * 100 é dividido em duas etapas, e o resto das duas
+    // decide o arredondamento, sem passar de 64 bits.
+    uint64_t abs_sum = s->sum < 0 ? -s->sum : s->sum;
+    uint64_t m = n * s->sumsq - abs_sum * abs_sum;
+    uint64_t t = m % n * 100;
+    uint64_t p = m / n * 100 + t / n; // floor(100 * m / n)
+    uint64_t frac = p % n * n + t % n; // Resto de 100 * m por n²
+    r->var = p / n + (2 * frac >= (uint64_t)n * n);
+
+    // rms² = soma de x² / n, com x = ref + d: em centésimos,
+    // rms100 = sqrt(10000 * sumx2 / n), arredondado ao mais próximo
+    uint64_t sumx2 = (uint64_t)((int64_t)s->ref * s->ref * n + 2 * (int64_t)s->ref * s->sum) + s->sumsq;
+    uint32_t rms = isqrt64(sumx2 * 10000 / n);
+    if (sumx2 * 40000 >= n * (4 * (uint64_t)rms * rms + 4 * (uint64_t)rms + 1)) {
+        rms++;
+    }
+    r->rms = rms;
+}
+
+static char *put_u64(char *dst, uint64_t v) {
+    char tmp[20];
+    int n = 0;
+
+    do {
+        tmp[n++] = '0' + v % 10;
+        v /= 10;
+    } while (v);
+
+    while (n) {
+        *dst++ = tmp[--n];
+    }
+    return dst;
+}
+
+// Valor em centésimos com duas casas decimais
+static char *put_fixed2(char *dst, int64_t centi) {
+    if (centi < 0) {
+        *dst++ = '-';
+        centi = -centi;
+    }
+    dst = put_u64(dst, (uint64_t)centi / 100);
+    uint8_t frac = (uint64_t)centi % 100;
+    *dst++ = '.';
+    *dst++ = '0' + frac / 10;
+    *dst++ = '0' + frac % 10;
+    return dst;
+}
+
+static char *put_int(char *dst, int32_t v) {
+    if (v < 0) {
+        *dst++ = '-';
+        v = -v;
+    }
+    return put_u64(dst, (uint32_t)v);
+}
+
+// Monta a linha de resumo da janela atual e retorna o seu tamanho
+size_t wstats_format_line(const wstats_t *w, char *dst) {
+    char *p = csv_put_time(dst, w->start_ms);
+    *p++ = ',';
+    p = put_u64(p, w->count);
+
+    for (uint8_t a = 0; a < WSTATS_AXES; a++) {
+        wstats_result_t r;
+        wstats_result(w, a, &r);
+
+        *p++ = ',';
+        p = put_fixed2(p, r.mean);
+        *p++ = ',';
+        p = put_fixed2(p, (int64_t)r.var);
+        *p++ = ',';
+        p = put_int(p, r.min);
+        *p++ = ',';
+        p = put_int(p, r.max);
+        *p++ = ',';
+        p = put_fixed2(p, r.rms);
+    }
+
+    *p++ = '\n';
+    return p - dst;
+}
@@ -0,0 +1,71 @@
+#ifndef WINDOW_STATS_H
+#define WINDOW_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Eixos agregados: acel x/y/z e giro x/y/z (contagens do sensor)
+#define WSTATS_AXES 6
+#define WSTATS_MAX_WINDOW 65535
+#define WSTATS_DEFAULT_WINDOW 100
+
+// Uma linha: tempo, n e 5 campos por eixo com até 16 caracteres cada
+#define WSTATS_LINE_MAX 512
+
+/*
+ Resumo por janela, em contagens do sensor (a escala é aplicada no
+ computador, como nos formatos binários). Colunas da linha:
+   time_s, n, e para cada eixo: mean, var, min, max, rms
+ mean, var (populacional) e rms com duas casas decimais.
+*/
+#define WSTATS_HEADER \
+    "time_s,n," \
+    "accel_x_mean,accel_x_var,accel_x_min,accel_x_max,accel_x_rms," \
+    "accel_y_mean,accel_y_var,accel_y_min,accel_y_max,accel_y_rms," \
+    "accel_z_mean,accel_z_var,accel_z_min,accel_z_max,accel_z_rms," \
+    "giro_x_mean,giro_x_var,giro_x_min,giro_x_max,giro_x_rms," \
+    "giro_y_mean,giro_y_var,giro_y_min,giro_y_max,giro_y_rms," \
+    "giro_z_mean,giro_z_var,giro_z_min,giro_z_max,giro_z_rms\n"
+
+/*
+ Somas deslocadas: cada eixo acumula d = x - ref, com ref = primeira
+ amostra da janela. Com |d| < 2^16 e n < 2^16, sum cabe em 33 bits com
+ sinal e sum², sumsq e n * sumsq em 64 bits sem sinal sem estouro, então
+ a variância
+   n² * var = n * sumsq - sum²
+ é calculada em inteiros, sem o cancelamento do método ingênuo em float.
+ mean, var e rms saem arredondados ao centésimo mais próximo do valor
+ exato (host_test/window_stats.c confere contra frações exatas).
+*/
+typedef struct {
+    int16_t ref;
+    int16_t min;
+    int16_t max;
+    int64_t sum;
+    uint64_t sumsq;
+} wstats_axis_t;
+
+typedef struct {
+    uint16_t window;
+    uint16_t count;
+    uint32_t start_ms;
+    wstats_axis_t axis[WSTATS_AXES];
+} wstats_t;
+
+// Resultado de um eixo; mean, var e rms multiplicados por 100
+typedef struct {
+    int32_t mean;
+    uint64_t var;
+    int16_t min;
+    int16_t max;
+    uint32_t rms;
+} wstats_result_t;
+
+bool wstats_init(wstats_t *w, uint16_t window);
+void wstats_reset(wstats_t *w);
+bool wstats_push(wstats_t *w, uint32_t time_ms, const int16_t accel[3], const int16_t gyro[3]);
+void wstats_result(const wstats_t *w, uint8_t axis, wstats_result_t *r);
+size_t wstats_format_line(const wstats_t *w, char *dst);
+
+#endif
@@ -0,0 +1,128 @@
+#include <string.h>
+
+#include "col_chunk.h"
+
+static inline void put_u16(uint8_t *dst, uint16_t v) {
+    dst[0] = v & 0xFF;
+    dst[1] = v >> 8;
+}
+
+static inline void put_u32(uint8_t *dst, uint32_t v) {
+    dst[0] = v & 0xFF;
+    dst[1] = (v >> 8) & 0xFF;
+    dst[2] = (v >> 16) & 0xFF;
+    dst[3] = v >> 24;
+}
+
+// Esvazia o chunk. As colunas são zeradas para que o preenchimento do
+// último chunk seja determinístico.
+void col_chunk_reset(col_chunk_t *chunk) {
+    memset(chunk, 0, sizeof(*chunk));
+}
+
+bool col_chunk_full(const col_chunk_t *chunk) {
+    return chunk->samples >= COL_CHUNK_SAMPLES;
+}
+
+// Adiciona uma amostra nas colunas e atualiza o min/max de cada canal. A
+// primeira amostra do chunk define a âncora de tempo.
+bool col_chunk_push(col_chunk_t *chunk, uint32_t index, uint32_t period_us, uint64_t time_us,
+    const int16_t accel[3], const int16_t gyro[3]) {
+    if (col_chunk_full(chunk)) {
+        return false;
+    }
+
+    uint16_t i = chunk->samples;
+    int32_t values[COL_CHANNELS] = {
+        index,
+        accel[0], accel[1], accel[2],
+        gyro[0], gyro[1], gyro[2]
+    };
+
+    if (i == 0) {
+        chunk->period_us = period_us;
+        chunk->time_us = time_us;
+    }
+    chunk->index[i] = index;
+    for (int a = 0; a < COL_AXES; a++) {
+        chunk->axis[a][i] = values[a + 1];
+    }
+
+    for (int c = 0; c < COL_CHANNELS; c++) {
+        if (i == 0 || values[c] < chunk->min[c]) {
+            chunk->min[c] = values[c];
+        }
+        if (i == 0 || values[c] > chunk->max[c]) {
+            chunk->max[c] = values[c];
+        }
+    }
+
+    chunk->samples++;
+    return true;
+}
+
+// Monta o cabeçalho do chunk. As colunas são gravadas em seguida direto
+// de chunk->index e chunk->axis (o RP2040 é little-endian).
+size_t col_chunk_header(const col_chunk_t *chunk, uint8_t *dst) {
+    dst[0] = COL_CHUNK_TAG_ANCHOR;
+    dst[1] = COL_CHANNELS;
+    put_u16(dst + 2, chunk->samples);
+    put_u16(dst + 4, COL_CHUNK_SAMPLES);
+    put_u16(dst + 6, COL_CHUNK_SIZE);
+
+    for (int c = 0; c < COL_CHANNELS; c++) {
+        put_u32(dst + 8 + c * 8, chunk->min[c]);
+        put_u32(dst + 12 + c * 8, chunk->max[c]);
+    }
+
+    put_u32(dst + 64, chunk->index[0]);
+    put_u32(dst + 68, chunk->period_us);
+    put_u32(dst + 72, (uint32_t)chunk->time_us);
+    put_u32(dst + 76, (uint32_t)(chunk->time_us >> 32));
+
+    return COL_CHUNK_HEADER_SIZE;
+}
+
+static inline uint16_t get_u16(const uint8_t *src) {
+    return src[0] | (src[1] << 8);
+}
+
+static inline uint32_t get_u32(const uint8_t *src) {
+    return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+// Cabeçalho dos chunks COL_CHUNK_TAG: o de agora sem a âncora
+#define COL_CHUNK_HEADER_SIZE_V2 64
+
+// Lê o chunk no início de src (len bytes disponíveis). Retorna false se o
+// tag for desconhecido ou se as colunas não couberem no chunk ou em src.
+bool col_chunk_parse(const uint8_t *src, size_t len, col_chunk_view_t *view) {
+    if (len < COL_CHUNK_HEADER_SIZE_V2 || src[1] != COL_CHANNELS) {
+        return false;
+    }
+
+    size_t header_size;
+    if (src[0] == COL_CHUNK_TAG_ANCHOR) {
+        header_size = COL_CHUNK_HEADER_SIZE;
+        if (len < header_size) {
+            return false;
+        }
+        view->index = get_u32(src + 64);
+        view->period_us = get_u32(src + 68);
+        view->time_us = get_u32(src + 72) | (uint64_t)get_u32(src + 76) << 32;
+    } else if (src[0] == COL_CHUNK_TAG) {
+        header_size = COL_CHUNK_HEADER_SIZE_V2;
+        view->index = 0;
+        view->period_us = 1000;
+        view->time_us = 0;
+    } else {
+        return false;
+    }
+
+    view->samples = get_u16(src + 2);
+    view->capacity = get_u16(src + 4);
+    view->size = get_u16(src + 6);
+    view->columns = src + header_size;
+    return view->samples <= view->capacity && view->size <= len &&
+        header_size + (size_t)view->capacity * COL_SAMPLE_SIZE <= view->size;
+}
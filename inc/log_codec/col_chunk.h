@@ -0,0 +1,92 @@
+#ifndef COL_CHUNK_H
+#define COL_CHUNK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Canais: índice da amostra (u32) seguido de acel x/y/z e giro x/y/z (i16, contagens)
+#define COL_CHANNELS 7
+#define COL_AXES 6
+
+// Cada chunk ocupa sempre COL_CHUNK_SIZE bytes. O cabeçalho do arquivo (e,
+// com frames, o cabeçalho de cada frame) desloca os chunks, então eles não
+// começam em limites de setor: o tamanho fixo só garante um passo constante.
+#define COL_CHUNK_SIZE 4096
+#define COL_CHUNK_HEADER_SIZE 80
+#define COL_SAMPLE_SIZE (4 + COL_AXES * 2)
+#define COL_CHUNK_SAMPLES ((COL_CHUNK_SIZE - COL_CHUNK_HEADER_SIZE) / COL_SAMPLE_SIZE)
+
+// Chunks com âncora de tempo. Os de COL_CHUNK_TAG (versão 2 do arquivo)
+// tinham cabeçalho de 64 bytes e o tempo em ms na primeira coluna.
+#define COL_CHUNK_TAG 0x43
+#define COL_CHUNK_TAG_ANCHOR 0x63
+
+/*
+ Formato de um chunk (little-endian):
+   u8  tag       = COL_CHUNK_TAG_ANCHOR
+   u8  channels  = COL_CHANNELS
+   u16 samples   - amostras válidas (o último chunk pode estar incompleto)
+   u16 capacity  = COL_CHUNK_SAMPLES
+   u16 size      = COL_CHUNK_SIZE
+   i32 min, max  - por canal, na ordem dos canais (56 bytes)
+   u32 index     - âncora: posição da primeira amostra na grade,
+   u32 period_us   intervalo da grade e instante medido da primeira
+   u64 time_us     amostra desde o início
+   colunas       - u32 index[capacity], depois i16 eixo[capacity] para cada
+                   eixo. Entradas além de samples são zero.
+
+ A amostra com índice n está em time_us + (n - index) * period_us.
+
+ Como o tamanho e a capacidade são fixos, a coluna c do chunk k de um
+ arquivo sem frames está em header_size + k * COL_CHUNK_SIZE mais um
+ deslocamento constante, e um leitor pode buscar apenas as colunas de
+ interesse, ou pular chunks pelo min/max.
+*/
+typedef struct {
+    uint16_t samples;
+    int32_t min[COL_CHANNELS];
+    int32_t max[COL_CHANNELS];
+    uint32_t period_us;
+    uint64_t time_us;
+    uint32_t index[COL_CHUNK_SAMPLES];
+    int16_t axis[COL_AXES][COL_CHUNK_SAMPLES];
+} col_chunk_t;
+
+/*
+ Chunk lido de um arquivo, para os conversores no computador: os campos
+ do cabeçalho e as colunas no próprio buffer. Nos chunks COL_CHUNK_TAG a
+ primeira coluna é o tempo em ms, o que equivale a âncora 0 com período de
+ 1000 us, e é assim que eles são apresentados.
+*/
+typedef struct {
+    uint16_t samples;
+    uint16_t capacity;
+    uint16_t size;
+    uint32_t index;
+    uint32_t period_us;
+    uint64_t time_us;
+    const uint8_t *columns;
+} col_chunk_view_t;
+
+void col_chunk_reset(col_chunk_t *chunk);
+bool col_chunk_push(col_chunk_t *chunk, uint32_t index, uint32_t period_us, uint64_t time_us,
+    const int16_t accel[3], const int16_t gyro[3]);
+bool col_chunk_full(const col_chunk_t *chunk);
+size_t col_chunk_header(const col_chunk_t *chunk, uint8_t *dst);
+bool col_chunk_parse(const uint8_t *src, size_t len, col_chunk_view_t *view);
+
+// Instante em us da amostra i de um chunk lido com col_chunk_parse
+static inline uint64_t col_chunk_time_us(const col_chunk_view_t *view, uint16_t i) {
+    const uint8_t *p = view->columns + 4 * i;
+    uint32_t n = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    return view->time_us + (uint64_t)(((int64_t)n - view->index) * view->period_us);
+}
+
+// Contagem do eixo (0 a COL_AXES - 1) da amostra i
+static inline int16_t col_chunk_axis(const col_chunk_view_t *view, uint8_t axis, uint16_t i) {
+    const uint8_t *p = view->columns + 4 * view->capacity + 2 * (axis * view->capacity + i);
+    return (int16_t)(p[0] | (p[1] << 8));
+}
+
+#endif
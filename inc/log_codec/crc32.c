@@ -0,0 +1,33 @@
+#include <stdbool.h>
+
+#include "crc32.h"
+
+// Tabela de 256 entradas gerada no primeiro uso (fica em RAM, mais rápida
+// que ler da flash pelo XIP)
+static uint32_t crc32_table[256];
+static bool crc32_ready = false;
+
+static void crc32_init() {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        crc32_table[i] = c;
+    }
+    crc32_ready = true;
+}
+
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len) {
+    const uint8_t *p = data;
+
+    if (!crc32_ready) {
+        crc32_init();
+    }
+
+    crc = ~crc;
+    while (len--) {
+        crc = crc32_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
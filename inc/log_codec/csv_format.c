@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "csv_format.h"
+#include "inc/cycle_counter/cycle_counter.h"
+
+// Faixas do sensor usadas na conversão (padrão: ±2 g e ±250 °/s)
+static uint8_t csv_accel_shift = 0;
+static uint16_t csv_gyro_lsb_x10 = 1310;
+
+void csv_set_scale(uint8_t accel_shift, uint16_t gyro_lsb_x10) {
+    csv_accel_shift = accel_shift;
+    csv_gyro_lsb_x10 = gyro_lsb_x10;
+}
+
+// Escreve v em decimal e retorna o ponteiro após o último dígito
+static char *put_uint(char *dst, uint32_t v) {
+    char tmp[10];
+    int n = 0;
+
+    do {
+        tmp[n++] = '0' + v % 10;
+        v /= 10;
+    } while (v);
+
+    while (n) {
+        *dst++ = tmp[--n];
+    }
+    return dst;
+}
+
+// Escreve |centi| / 100 com duas casas decimais. O sinal é passado à parte
+// para reproduzir o "-0.00" que o printf gera para valores negativos pequenos.
+char *csv_put_centi(char *dst, int32_t centi, bool negative) {
+    uint32_t v = centi < 0 ? -centi : centi;
+
+    if (negative) {
+        *dst++ = '-';
+    }
+    dst = put_uint(dst, v / 100);
+    v %= 100;
+    *dst++ = '.';
+    *dst++ = '0' + v / 10;
+    *dst++ = '0' + v % 10;
+    return dst;
+}
+
+// Arredonda v para 24 bits significativos (empate para o par), como na
+// conversão de inteiro para float
+static uint32_t round_to_float(uint32_t v, uint8_t *shift) {
+    uint8_t s = 0;
+    while ((v >> s) >= (1u << 24)) {
+        s++;
+    }
+    *shift = s;
+    if (s == 0) {
+        return v;
+    }
+
+    uint32_t m = v >> s;
+    uint32_t rem = v & ((1u << s) - 1);
+    uint32_t half = 1u << (s - 1);
+    if (rem > half || (rem == half && (m & 1))) {
+        m++;
+    }
+    return m;
+}
+
+/*
+ Escreve o tempo em segundos com duas casas, idêntico a
+ printf("%.2f", elapsed_ms / 1000.0f). Fora dos empates (ms terminado em 5)
+ e abaixo de 2^24 ms (~4,6 h) o resultado é o arredondamento direto; nos
+ demais casos o quociente em float é reproduzido exatamente com inteiros.
+*/
+char *csv_put_time(char *dst, uint32_t elapsed_ms) {
+    if (elapsed_ms < (1u << 24) && elapsed_ms % 10 != 5) {
+        return csv_put_centi(dst, (elapsed_ms + 5) / 10, false);
+    }
+
+    // ms convertido para float: mant * 2^shift
+    uint8_t shift;
+    uint64_t mant = round_to_float(elapsed_ms, &shift);
+
+    // q = RN(mant * 2^shift / 1000) com 24 bits: q = m / 2^k
+    uint8_t k = 0;
+    uint64_t num = mant << shift;
+    while ((num << k) < (1000ull << 23)) {
+        k++;
+    }
+    uint64_t scaled = num << k;
+    uint64_t m = scaled / 1000;
+    uint64_t rem = scaled % 1000;
+    if (rem > 500 || (rem == 500 && (m & 1))) {
+        m++;
+    }
+
+    // Centésimos de q, com empate para o par como no printf
+    uint64_t c = m * 100;
+    uint64_t centi = c >> k;
+    uint64_t frac = c & ((1ull << k) - 1);
+    uint64_t half = 1ull << (k - 1);
+    if (frac > half || (frac == half && (centi & 1))) {
+        centi++;
+    }
+
+    return csv_put_centi(dst, (int32_t)centi, false);
+}
+
+// Tempo em segundos com seis casas (resolução de 1 us). Abaixo de 2^32 us
+// (~71 min) só usa a divisão de 32 bits do divisor em hardware.
+char *csv_put_time_us(char *dst, uint64_t elapsed_us) {
+    uint32_t sec;
+    uint32_t frac;
+
+    if (elapsed_us < (1ull << 32)) {
+        sec = (uint32_t)elapsed_us / 1000000;
+        frac = (uint32_t)elapsed_us % 1000000;
+    } else {
+        sec = (uint32_t)(elapsed_us / 1000000);
+        frac = (uint32_t)(elapsed_us % 1000000);
+    }
+
+    dst = put_uint(dst, sec);
+    *dst++ = '.';
+    for (int i = 5; i >= 0; i--) {
+        dst[i] = '0' + frac % 10;
+        frac /= 10;
+    }
+    return dst + 6;
+}
+
+// Monta uma linha do CSV sem usar float. Retorna o número de caracteres.
+size_t csv_format_line(char *dst, uint64_t elapsed_us, const int16_t accel[3], const int16_t gyro[3]) {
+    char *p = csv_put_time_us(dst, elapsed_us);
+
+    for (int i = 0; i < 3; i++) {
+        *p++ = ',';
+        p = csv_put_centi(p, accel_to_centi(accel[i], csv_accel_shift), accel[i] < 0);
+    }
+    for (int i = 0; i < 3; i++) {
+        *p++ = ',';
+        p = csv_put_centi(p, gyro_to_centi(gyro[i], csv_gyro_lsb_x10), gyro[i] < 0);
+    }
+    *p++ = '\n';
+    *p = '\0';
+
+    return p - dst;
+}
+
+// Caminho anterior: conversão em float/double e sprintf, com os divisores
+// da faixa atual
+static size_t csv_format_line_float(char *dst, uint64_t elapsed_us, const int16_t accel[3], const int16_t gyro[3]) {
+    float lsb_g = (float)(16384 >> csv_accel_shift);
+    float lsb_dps = csv_gyro_lsb_x10 / 10.0f;
+    return sprintf(dst, "%.6f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n",
+        elapsed_us / 1000000.0,
+        (float)((accel[0] / lsb_g) * 9.81), (float)((accel[1] / lsb_g) * 9.81),
+        (float)((accel[2] / lsb_g) * 9.81),
+        gyro[0] / lsb_dps, gyro[1] / lsb_dps, gyro[2] / lsb_dps
+    );
+}
+
+// Compara o custo em ciclos dos dois caminhos e confere se as saídas são
+// idênticas para uma varredura dos valores brutos
+void csv_format_bench() {
+    char a[CSV_LINE_MAX];
+    char b[CSV_LINE_MAX];
+    uint32_t cycles_float = 0;
+    uint32_t cycles_int = 0;
+    uint32_t mismatches = 0;
+    uint32_t lines = 0;
+
+    for (int32_t raw = -32768; raw < 32768; raw += 97) {
+        int16_t accel[3] = {raw, -raw / 2, raw / 3};
+        int16_t gyro[3] = {-raw, raw / 5, raw / 7};
+        uint64_t elapsed_us = (uint64_t)(raw + 32768) * 131071;
+
+        uint32_t start = cycle_counter_get();
+        csv_format_line_float(a, elapsed_us, accel, gyro);
+        cycles_float += cycle_counter_elapsed(start);
+
+        start = cycle_counter_get();
+        csv_format_line(b, elapsed_us, accel, gyro);
+        cycles_int += cycle_counter_elapsed(start);
+
+        if (strcmp(a, b) != 0) {
+            if (mismatches == 0) {
+                printf("Divergencia:\n  %s  %s", a, b);
+            }
+            mismatches++;
+        }
+        lines++;
+    }
+
+    printf("CSV float/sprintf: %lu ciclos/linha\n", (unsigned long)(cycles_float / lines));
+    printf("CSV inteiro:       %lu ciclos/linha\n", (unsigned long)(cycles_int / lines));
+    printf("Linhas divergentes: %lu de %lu\n", (unsigned long)mismatches, (unsigned long)lines);
+}
@@ -0,0 +1,48 @@
+#ifndef CSV_FORMAT_H
+#define CSV_FORMAT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Tamanho máximo de uma linha: tempo com até 17 caracteres, 7 campos (com a
+// temperatura opcional) de até 11 caracteres e separadores
+#define CSV_LINE_MAX 112
+
+#define CSV_HEADER "time_s,accel_x,accel_y,accel_z,giro_x,giro_y,giro_z\n"
+#define CSV_HEADER_TEMP "time_s,accel_x,accel_y,accel_z,giro_x,giro_y,giro_z,temp_c\n"
+
+/*
+ Conversão das contagens do MPU6050 para centésimos da unidade gravada no
+ CSV, arredondando para o mais próximo (empate para longe do zero). A
+ faixa do acelerômetro entra como deslocamento (±2 g << shift) e a do
+ giroscópio como LSB/(°/s) * 10. Na faixa padrão (±2 g, ±250 °/s) o
+ resultado é idêntico ao caminho anterior em float:
+   (raw / 16384.0f) * 9.81  e  raw / 131.0f  impressos com "%.2f"
+ (verificado para todos os 65536 valores de raw). Nas outras faixas só
+ diferem valores em um empate ou a menos de 3e-6 dele (no máximo 20 de
+ 65536), em que o float é que arredonda errado (host_test/csv_format.c).
+*/
+
+// m/s² * 100 = raw * 981 * 2^shift / 16384: multiplicação e deslocamento
+static inline int32_t accel_to_centi(int16_t raw, uint8_t shift) {
+    int32_t v = raw < 0 ? -raw : raw;
+    v = ((v * 981 * 2 << shift) + 16384) >> 15;
+    return raw < 0 ? -v : v;
+}
+
+// °/s * 100 = raw * 1000 / lsb_x10: usa o divisor em hardware do RP2040
+static inline int32_t gyro_to_centi(int16_t raw, uint16_t lsb_x10) {
+    int32_t v = raw < 0 ? -raw : raw;
+    v = (v * 2000 + lsb_x10) / (2 * lsb_x10);
+    return raw < 0 ? -v : v;
+}
+
+char *csv_put_centi(char *dst, int32_t centi, bool negative);
+char *csv_put_time(char *dst, uint32_t elapsed_ms);
+char *csv_put_time_us(char *dst, uint64_t elapsed_us);
+void csv_set_scale(uint8_t accel_shift, uint16_t gyro_lsb_x10);
+size_t csv_format_line(char *dst, uint64_t elapsed_us, const int16_t accel[3], const int16_t gyro[3]);
+void csv_format_bench();
+
+#endif
@@ -0,0 +1,441 @@
+#include <stdio.h>
+
+#include "delta_codec.h"
+
+// Grava v em base 128 (7 bits por byte, bit 7 indica continuação)
+size_t varint_put(uint8_t *dst, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        dst[n++] = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    dst[n++] = (uint8_t)v;
+    return n;
+}
+
+size_t varint_size(uint32_t v) {
+    size_t n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        n++;
+    }
+    return n;
+}
+
+static inline void put_u32(uint8_t *dst, uint32_t v) {
+    dst[0] = v & 0xFF;
+    dst[1] = (v >> 8) & 0xFF;
+    dst[2] = (v >> 16) & 0xFF;
+    dst[3] = v >> 24;
+}
+
+// Número de bits necessários para representar v (0 para v == 0)
+static uint8_t bit_width(uint32_t v) {
+    uint8_t n = 0;
+    while (v) {
+        v >>= 1;
+        n++;
+    }
+    return n;
+}
+
+// Acrescenta v com width bits ao acumulador e descarrega os bytes completos
+// em dst. Retorna o número de bytes escritos.
+static inline size_t put_bits(uint8_t *dst, uint64_t *acc, uint8_t *acc_bits, uint32_t v, uint8_t width) {
+    size_t n = 0;
+    *acc |= (uint64_t)v << *acc_bits;
+    *acc_bits += width;
+    while (*acc_bits >= 8) {
+        dst[n++] = (uint8_t)*acc;
+        *acc >>= 8;
+        *acc_bits -= 8;
+    }
+    return n;
+}
+
+void delta_block_init(delta_block_t *blk, uint8_t channels) {
+    blk->channels = channels > DELTA_MAX_CHANNELS ? DELTA_MAX_CHANNELS : channels;
+    delta_block_reset(blk);
+}
+
+// Descarta o conteúdo atual; a próxima amostra será um key-frame
+void delta_block_reset(delta_block_t *blk) {
+    blk->samples = 0;
+    blk->anchored = false;
+    blk->varint_size = 0;
+    for (uint8_t c = 0; c < DELTA_MAX_CHANNELS; c++) {
+        blk->bits_mask[c] = 0;
+    }
+}
+
+bool delta_block_full(const delta_block_t *blk) {
+    return blk->samples >= DELTA_BLOCK_SAMPLES;
+}
+
+// Indica se a amostra na posição index da grade pode entrar no bloco: ele
+// não está cheio e a amostra vem depois da última (ou o bloco está vazio).
+// Posições puladas não encerram o bloco.
+bool delta_block_accepts(const delta_block_t *blk, uint32_t index) {
+    return !delta_block_full(blk) && (blk->samples == 0 || index > blk->last_index);
+}
+
+// Acrescenta uma amostra sem canal de tempo. A primeira amostra do bloco
+// define a âncora; para as demais é guardado o número de posições da grade
+// puladas desde a anterior.
+bool delta_block_push_at(delta_block_t *blk, uint32_t index, uint32_t period_us, uint64_t time_us,
+    const int32_t *sample) {
+    if (!delta_block_accepts(blk, index)) {
+        return false;
+    }
+
+    if (blk->samples == 0) {
+        blk->anchored = true;
+        blk->index = index;
+        blk->period_us = period_us;
+        blk->time_us = time_us;
+    } else {
+        blk->skipped[blk->samples - 1] = index - blk->last_index - 1;
+    }
+    blk->last_index = index;
+    return delta_block_push(blk, sample);
+}
+
+// Adiciona uma amostra ao bloco. Retorna false se o bloco já estiver cheio.
+bool delta_block_push(delta_block_t *blk, const int32_t *sample) {
+    if (delta_block_full(blk)) {
+        return false;
+    }
+
+    if (blk->samples == 0) {
+        for (uint8_t c = 0; c < blk->channels; c++) {
+            blk->key[c] = sample[c];
+            blk->prev[c] = sample[c];
+        }
+    } else {
+        uint32_t *residual = blk->residual[blk->samples - 1];
+        for (uint8_t c = 0; c < blk->channels; c++) {
+            uint32_t zz = zigzag_encode(sample[c] - blk->prev[c]);
+            residual[c] = zz;
+            blk->bits_mask[c] |= zz;
+            blk->varint_size += varint_size(zz);
+            blk->prev[c] = sample[c];
+        }
+    }
+
+    blk->samples++;
+    return true;
+}
+
+// Codifica o bloco em dst (até DELTA_BLOCK_MAX_SIZE bytes) e retorna o tamanho
+size_t delta_block_encode(const delta_block_t *blk, uint8_t *dst) {
+    uint8_t widths[DELTA_MAX_CHANNELS];
+    size_t bits = 0;
+
+    for (uint8_t c = 0; c < blk->channels; c++) {
+        widths[c] = bit_width(blk->bits_mask[c]);
+        bits += widths[c];
+    }
+    size_t residuals = blk->samples ? blk->samples - 1 : 0;
+
+    // Posições puladas: o valor antes da amostra 1 vai no key-frame e os
+    // resíduos são as variações a partir dele. Com a grade seguida a cada
+    // k posições todos os resíduos são 0.
+    uint32_t skipped_zz[DELTA_BLOCK_SAMPLES - 1];
+    uint32_t skipped_base = residuals ? blk->skipped[0] : 0;
+    uint32_t skipped_mask = 0;
+    size_t skipped_varint = 0;
+    if (blk->anchored) {
+        uint32_t prev = skipped_base;
+        for (size_t s = 0; s < residuals; s++) {
+            skipped_zz[s] = zigzag_encode((int32_t)(blk->skipped[s] - prev));
+            skipped_mask |= skipped_zz[s];
+            skipped_varint += varint_size(skipped_zz[s]);
+            prev = blk->skipped[s];
+        }
+    }
+    uint8_t skipped_width = bit_width(skipped_mask);
+    if (blk->anchored) {
+        bits += skipped_width;
+    }
+
+    size_t packed_size = blk->channels + blk->anchored + (bits * residuals + 7) / 8;
+    uint8_t packing = packed_size < blk->varint_size + skipped_varint ? DELTA_PACK_BITS : DELTA_PACK_VARINT;
+
+    size_t n = DELTA_BLOCK_HEADER_SIZE;
+    if (blk->anchored) {
+        put_u32(dst + n, blk->index);
+        put_u32(dst + n + 4, blk->period_us);
+        put_u32(dst + n + 8, (uint32_t)blk->time_us);
+        put_u32(dst + n + 12, (uint32_t)(blk->time_us >> 32));
+        n += DELTA_ANCHOR_SIZE;
+    }
+    size_t start = n;
+
+    if (blk->anchored) {
+        n += varint_put(dst + n, skipped_base);
+    }
+    for (uint8_t c = 0; c < blk->channels; c++) {
+        n += varint_put(dst + n, zigzag_encode(blk->key[c]));
+    }
+
+    if (packing == DELTA_PACK_VARINT) {
+        for (size_t s = 0; s < residuals; s++) {
+            if (blk->anchored) {
+                n += varint_put(dst + n, skipped_zz[s]);
+            }
+            for (uint8_t c = 0; c < blk->channels; c++) {
+                n += varint_put(dst + n, blk->residual[s][c]);
+            }
+        }
+    } else {
+        if (blk->anchored) {
+            dst[n++] = skipped_width;
+        }
+        for (uint8_t c = 0; c < blk->channels; c++) {
+            dst[n++] = widths[c];
+        }
+
+        // Acumulador de 64 bits: sempre cabe um valor de até 32 bits após
+        // descarregar os bytes completos
+        uint64_t acc = 0;
+        uint8_t acc_bits = 0;
+        for (size_t s = 0; s < residuals; s++) {
+            if (blk->anchored) {
+                n += put_bits(dst + n, &acc, &acc_bits, skipped_zz[s], skipped_width);
+            }
+            for (uint8_t c = 0; c < blk->channels; c++) {
+                n += put_bits(dst + n, &acc, &acc_bits, blk->residual[s][c], widths[c]);
+            }
+        }
+        if (acc_bits) {
+            dst[n++] = (uint8_t)acc;
+        }
+    }
+
+    uint16_t payload = n - start;
+    dst[0] = blk->anchored ? DELTA_BLOCK_TAG_GRID : DELTA_BLOCK_TAG;
+    dst[1] = blk->channels;
+    dst[2] = blk->samples & 0xFF;
+    dst[3] = blk->samples >> 8;
+    dst[4] = payload & 0xFF;
+    dst[5] = payload >> 8;
+    dst[6] = packing;
+
+    return n;
+}
+
+static inline uint32_t get_u32(const uint8_t *src) {
+    return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+// Lê um varint de até 5 bytes sem passar de end
+static bool get_varint(const uint8_t **p, const uint8_t *end, uint32_t *v) {
+    uint32_t result = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        if (*p >= end) {
+            return false;
+        }
+        uint8_t b = *(*p)++;
+        result |= (uint32_t)(b & 0x7F) << shift;
+        if (b < 0x80) {
+            *v = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Lê width bits do fluxo (a partir do bit menos significativo)
+static inline bool get_bits(const uint8_t **p, const uint8_t *end, uint64_t *acc, uint8_t *acc_bits,
+    uint8_t width, uint32_t *v) {
+    while (*acc_bits < width) {
+        if (*p >= end) {
+            return false;
+        }
+        *acc |= (uint64_t)*(*p)++ << *acc_bits;
+        *acc_bits += 8;
+    }
+    *v = (uint32_t)(*acc & ((1ull << width) - 1));
+    *acc >>= width;
+    *acc_bits -= width;
+    return true;
+}
+
+/*
+ Decodifica o bloco no início de src (len bytes disponíveis) em out.
+ Retorna o tamanho do bloco, ou 0 se ele estiver truncado ou inválido.
+ Aceita os três tipos de bloco; nos antigos o canal 0 é o tempo em ms e
+ sai dos canais.
+*/
+size_t delta_block_decode(const uint8_t *src, size_t len, delta_samples_t *out) {
+    if (len < DELTA_BLOCK_HEADER_SIZE) {
+        return 0;
+    }
+    uint8_t tag = src[0];
+    uint8_t channels = src[1];
+    uint16_t samples = src[2] | (src[3] << 8);
+    uint16_t payload = src[4] | (src[5] << 8);
+    uint8_t packing = src[6];
+    bool anchored = tag == DELTA_BLOCK_TAG_ANCHOR || tag == DELTA_BLOCK_TAG_GRID;
+    bool grid = tag == DELTA_BLOCK_TAG_GRID;
+
+    if ((!anchored && tag != DELTA_BLOCK_TAG) || channels > DELTA_MAX_CHANNELS ||
+        (!anchored && channels == 0) || samples > DELTA_BLOCK_SAMPLES) {
+        return 0;
+    }
+    size_t start = DELTA_BLOCK_HEADER_SIZE + (anchored ? DELTA_ANCHOR_SIZE : 0);
+    size_t size = start + payload;
+    if (size > len) {
+        return 0;
+    }
+
+    uint32_t period_us = 0;
+    uint64_t steps = 0; // Posições da grade desde a âncora
+    uint64_t time_us = 0;
+    if (anchored) {
+        period_us = get_u32(src + DELTA_BLOCK_HEADER_SIZE + 4);
+        time_us = get_u32(src + DELTA_BLOCK_HEADER_SIZE + 8) |
+            (uint64_t)get_u32(src + DELTA_BLOCK_HEADER_SIZE + 12) << 32;
+    }
+
+    const uint8_t *p = src + start;
+    const uint8_t *end = src + size;
+    uint32_t skipped = 0;
+    uint32_t zz;
+    if (grid && !get_varint(&p, end, &skipped)) {
+        return 0;
+    }
+
+    // Os canais são acumulados em 32 bits sem sinal, como a diferença
+    // calculada no codificador
+    uint32_t prev[DELTA_MAX_CHANNELS];
+    for (uint8_t c = 0; c < channels; c++) {
+        if (!get_varint(&p, end, &zz)) {
+            return 0;
+        }
+        prev[c] = (uint32_t)zigzag_decode(zz);
+    }
+
+    uint8_t widths[DELTA_MAX_CHANNELS];
+    uint8_t skipped_width = 0;
+    uint64_t acc = 0;
+    uint8_t acc_bits = 0;
+    if (packing == DELTA_PACK_BITS) {
+        if (end - p < grid + channels) {
+            return 0;
+        }
+        if (grid) {
+            skipped_width = *p++;
+        }
+        for (uint8_t c = 0; c < channels; c++) {
+            widths[c] = *p++;
+            if (widths[c] > 32) {
+                return 0;
+            }
+        }
+        if (skipped_width > 32) {
+            return 0;
+        }
+    } else if (packing != DELTA_PACK_VARINT) {
+        return 0;
+    }
+
+    for (uint16_t s = 0; s < samples; s++) {
+        if (s > 0) {
+            if (grid) {
+                bool ok = packing == DELTA_PACK_BITS ?
+                    get_bits(&p, end, &acc, &acc_bits, skipped_width, &zz) : get_varint(&p, end, &zz);
+                if (!ok) {
+                    return 0;
+                }
+                skipped += zigzag_decode(zz);
+            }
+            steps += 1 + (uint64_t)skipped;
+            for (uint8_t c = 0; c < channels; c++) {
+                bool ok = packing == DELTA_PACK_BITS ?
+                    get_bits(&p, end, &acc, &acc_bits, widths[c], &zz) : get_varint(&p, end, &zz);
+                if (!ok) {
+                    return 0;
+                }
+                prev[c] += (uint32_t)zigzag_decode(zz);
+            }
+        }
+
+        if (anchored) {
+            out->time_us[s] = time_us + steps * period_us;
+            for (uint8_t c = 0; c < channels; c++) {
+                out->value[s][c] = (int32_t)prev[c];
+            }
+        } else {
+            out->time_us[s] = (uint64_t)((int64_t)(int32_t)prev[0] * 1000);
+            for (uint8_t c = 1; c < channels; c++) {
+                out->value[s][c - 1] = (int32_t)prev[c];
+            }
+        }
+    }
+
+    if (p != end) {
+        return 0;
+    }
+    out->channels = anchored ? channels : channels - 1;
+    out->samples = samples;
+    return size;
+}
+
+// Tamanho médio por amostra de DELTA_BENCH_SAMPLES amostras em repouso
+// (ruído de ±20 contagens, 1 g em z), com a grade seguida a cada 'stride'
+// posições e uma posição extra pulada a cada 'jitter' amostras (0: nunca)
+#define DELTA_BENCH_SAMPLES 4096
+
+static uint32_t bench_bytes(uint32_t stride, uint32_t jitter) {
+    static delta_block_t blk;
+    static uint8_t buf[DELTA_BLOCK_MAX_SIZE];
+    uint32_t seed = 12345;
+    uint32_t index = 0;
+    uint32_t bytes = 0;
+
+    delta_block_init(&blk, 7);
+    for (uint32_t i = 0; i < DELTA_BENCH_SAMPLES; i++) {
+        int32_t sample[7];
+        for (uint8_t c = 0; c < 6; c++) {
+            seed = seed * 1103515245u + 12345u;
+            sample[c] = (c == 2 ? 16384 : 0) + (int32_t)((seed >> 16) % 41) - 20;
+        }
+        sample[6] = -2000;
+
+        if (!delta_block_accepts(&blk, index)) {
+            bytes += delta_block_encode(&blk, buf);
+            delta_block_reset(&blk);
+        }
+        delta_block_push_at(&blk, index, 1000, (uint64_t)index * 1000, sample);
+        index += stride + (jitter && i % jitter == jitter - 1);
+    }
+    return bytes + delta_block_encode(&blk, buf);
+}
+
+// Compara o tamanho dos blocos com e sem posições perdidas na grade. As
+// perdas não devem custar mais que 10% sobre a grade contínua.
+void delta_block_bench() {
+    static const struct {
+        const char *name;
+        uint16_t stride;
+        uint16_t jitter;
+    } cases[] = {
+        {"continua", 1, 0},
+        {"1 perda a cada 20", 1, 20},
+        {"1 perda a cada 3", 1, 3},
+        {"a cada 480 posicoes", 480, 0},
+        {"a cada 480, 1 perda a cada 20", 480, 20},
+    };
+
+    uint32_t base = bench_bytes(1, 0);
+    bool ok = true;
+    for (uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        uint32_t bytes = bench_bytes(cases[i].stride, cases[i].jitter);
+        printf("Delta, grade %s: %lu.%02lu bytes/amostra\n", cases[i].name,
+            (unsigned long)(bytes / DELTA_BENCH_SAMPLES),
+            (unsigned long)(bytes % DELTA_BENCH_SAMPLES * 100 / DELTA_BENCH_SAMPLES));
+        ok = ok && bytes * 10 <= base * 11;
+    }
+    printf("Custo das perdas: %s\n", ok ? "OK (ate 10%)" : "ACIMA DE 10%");
+}
@@ -0,0 +1,116 @@
+#ifndef DELTA_CODEC_H
+#define DELTA_CODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Número máximo de canais por amostra (tempo + 3 acel + 3 giro + temperatura;
+// nos blocos com âncora o tempo não ocupa canal)
+#define DELTA_MAX_CHANNELS 8
+
+// Amostras por bloco. Cada bloco começa com um key-frame.
+#define DELTA_BLOCK_SAMPLES 32
+
+// Identificador do tipo de bloco e tamanho do cabeçalho de cada bloco.
+// Blocos com âncora têm a âncora de tempo logo após o cabeçalho. Os de
+// DELTA_BLOCK_TAG_ANCHOR (só posições consecutivas da grade) não são mais
+// gravados, mas continuam válidos na versão 3 do arquivo.
+#define DELTA_BLOCK_TAG 0x44
+#define DELTA_BLOCK_TAG_ANCHOR 0x54
+#define DELTA_BLOCK_TAG_GRID 0x47
+#define DELTA_BLOCK_HEADER_SIZE 7
+#define DELTA_ANCHOR_SIZE 16
+
+// Forma de empacotamento dos resíduos escolhida para o bloco
+#define DELTA_PACK_VARINT 0
+#define DELTA_PACK_BITS 1
+
+// Pior caso de um bloco codificado: âncora, key-frame e resíduos (com as
+// posições puladas) como varints de 5 bytes. As larguras do modo BITS
+// nunca passam do que o modo VARINT ocuparia.
+#define DELTA_BLOCK_MAX_SIZE \
+    (DELTA_BLOCK_HEADER_SIZE + DELTA_ANCHOR_SIZE + DELTA_BLOCK_SAMPLES * (DELTA_MAX_CHANNELS + 1) * 5)
+
+/*
+ Formato de um bloco (little-endian):
+   u8  tag       = DELTA_BLOCK_TAG, DELTA_BLOCK_TAG_ANCHOR ou DELTA_BLOCK_TAG_GRID
+   u8  channels
+   u16 samples   - número de amostras no bloco
+   u16 length    - bytes de payload após o cabeçalho (e a âncora)
+   u8  packing   - DELTA_PACK_VARINT ou DELTA_PACK_BITS
+   âncora (só em DELTA_BLOCK_TAG_ANCHOR e DELTA_BLOCK_TAG_GRID):
+     u32 index     - posição da primeira amostra na grade de amostragem
+     u32 period_us - intervalo da grade
+     u64 time_us   - instante medido da primeira amostra desde o início
+   payload:
+     key-frame   - valores absolutos da amostra 0 (zigzag + varint)
+     resíduos    - diferença para a amostra anterior de cada canal,
+                   mapeada com zigzag, para as amostras 1..samples-1:
+       VARINT:   um varint por valor, amostra a amostra
+       BITS:     u8 largura[channels] seguido dos valores com largura
+                 fixa por canal, empacotados a partir do bit menos
+                 significativo, amostra a amostra
+
+ Cada bloco começa com um key-frame, então pode ser decodificado sozinho.
+ O empacotamento é escolhido por bloco, o que resultar em menos bytes.
+
+ Nos blocos com âncora o tempo não é um canal. DELTA_BLOCK_TAG_GRID tem
+ um canal extra, antes dos outros, com o número de posições da grade
+ puladas antes de cada amostra: o key-frame começa com o valor (varint,
+ sem zigzag) da amostra 1, e cada resíduo começa com a diferença (zigzag)
+ para o valor da amostra anterior, partindo do key-frame. No modo BITS
+ ele tem a primeira largura de largura[], que então tem channels + 1
+ entradas. Sem perdas, ou com perdas a intervalo fixo, os resíduos desse
+ canal são sempre 0 e ocupam 0 bits. A amostra na posição n da grade está em
+ time_us + (n - index) * period_us. Nos blocos DELTA_BLOCK_TAG_ANCHOR as
+ posições são sempre consecutivas.
+*/
+typedef struct {
+    uint8_t channels;
+    uint16_t samples;
+    bool anchored;
+    uint32_t index;     // Âncora da primeira amostra (blocos com âncora)
+    uint32_t last_index; // Posição da última amostra na grade
+    uint32_t period_us;
+    uint64_t time_us;
+    int32_t key[DELTA_MAX_CHANNELS];
+    int32_t prev[DELTA_MAX_CHANNELS];
+    uint32_t residual[DELTA_BLOCK_SAMPLES - 1][DELTA_MAX_CHANNELS];
+    uint32_t skipped[DELTA_BLOCK_SAMPLES - 1];  // Posições puladas antes de cada amostra
+    uint32_t bits_mask[DELTA_MAX_CHANNELS]; // OR dos resíduos de cada canal
+    size_t varint_size;                      // Tamanho dos resíduos em varint
+} delta_block_t;
+
+// Amostras de um bloco decodificado. O tempo fica fora dos canais: vem da
+// âncora nos blocos com âncora e do canal 0 (em ms) nos blocos antigos.
+typedef struct {
+    uint8_t channels;
+    uint16_t samples;
+    uint64_t time_us[DELTA_BLOCK_SAMPLES];
+    int32_t value[DELTA_BLOCK_SAMPLES][DELTA_MAX_CHANNELS];
+} delta_samples_t;
+
+void delta_block_init(delta_block_t *blk, uint8_t channels);
+void delta_block_reset(delta_block_t *blk);
+bool delta_block_push(delta_block_t *blk, const int32_t *sample);
+bool delta_block_push_at(delta_block_t *blk, uint32_t index, uint32_t period_us, uint64_t time_us,
+    const int32_t *sample);
+bool delta_block_full(const delta_block_t *blk);
+bool delta_block_accepts(const delta_block_t *blk, uint32_t index);
+size_t delta_block_encode(const delta_block_t *blk, uint8_t *dst);
+size_t delta_block_decode(const uint8_t *src, size_t len, delta_samples_t *out);
+void delta_block_bench();
+
+static inline uint32_t zigzag_encode(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t zigzag_decode(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+size_t varint_put(uint8_t *dst, uint32_t v);
+size_t varint_size(uint32_t v);
+
+#endif
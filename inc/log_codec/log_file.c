@@ -0,0 +1,34 @@
+#include <string.h>
+
+#include "log_file.h"
+
+// Monta o cabeçalho do arquivo em dst e retorna o seu tamanho
+size_t log_file_header(uint8_t *dst, log_format_t format, uint8_t channels, uint8_t flags,
+    const log_sensor_info_t *sensor) {
+    memcpy(dst, LOG_FILE_MAGIC, 4);
+    dst[4] = LOG_FILE_HEADER_SIZE & 0xFF;
+    dst[5] = LOG_FILE_HEADER_SIZE >> 8;
+    dst[6] = LOG_FILE_VERSION;
+    dst[7] = format;
+    dst[8] = channels;
+    dst[9] = flags;
+    dst[10] = sensor->accel_range;
+    dst[11] = sensor->gyro_range;
+    dst[12] = sensor->dlpf;
+    dst[13] = sensor->smplrt_div;
+
+    // O RP2040 é little-endian: os floats são copiados como estão
+    memcpy(dst + 14, &sensor->accel_scale, 4);
+    memcpy(dst + 18, &sensor->gyro_scale, 4);
+
+    return LOG_FILE_HEADER_SIZE;
+}
+
+// Empacota a configuração do sensor e o canal de temperatura em 16 bits
+uint16_t log_frame_info(const log_sensor_info_t *sensor, uint8_t channels) {
+    return (sensor->accel_range & 0x03) |
+        (sensor->gyro_range & 0x03) << 2 |
+        (sensor->dlpf & 0x07) << 4 |
+        (channels > LOG_BASE_CHANNELS) << 7 |
+        (uint16_t)sensor->smplrt_div << 8;
+}
@@ -0,0 +1,70 @@
+#ifndef LOG_FILE_H
+#define LOG_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Assinatura no início de todo arquivo de log binário
+#define LOG_FILE_MAGIC "DLOG"
+#define LOG_FILE_VERSION 3
+#define LOG_FILE_HEADER_SIZE 22
+
+// Bits do campo flags
+#define LOG_FLAG_LZ 0x01     // Frames podem estar comprimidos com LZ
+#define LOG_FLAG_FRAMED 0x02 // Dados gravados em frames com CRC (log_writer)
+
+// Formatos de gravação das amostras no cartão SD
+typedef enum {
+    LOG_FORMAT_CSV = 0,
+    LOG_FORMAT_DELTA = 1,
+    LOG_FORMAT_COLUMNAR = 2,
+    LOG_FORMAT_STATS = 3, // Uma linha de resumo (texto) por janela
+    LOG_FORMAT_MAX
+} log_format_t;
+
+// Configuração do sensor durante a coleta, gravada no cabeçalho
+typedef struct {
+    uint8_t accel_range; // AFS_SEL: ±2 g << accel_range
+    uint8_t gyro_range;  // FS_SEL: ±250 °/s << gyro_range
+    uint8_t dlpf;        // DLPF_CFG
+    uint8_t smplrt_div;  // SMPLRT_DIV
+    float accel_scale;   // m/s² por contagem
+    float gyro_scale;    // °/s por contagem
+} log_sensor_info_t;
+
+/*
+ Cabeçalho do arquivo binário (little-endian):
+   char magic[4]    = "DLOG"
+   u16  header_size - permite estender o cabeçalho mantendo compatibilidade
+   u8   version
+   u8   format      - log_format_t
+   u8   channels    - canais por amostra (tempo, acel x/y/z, giro x/y/z e
+                      a temperatura opcional)
+   u8   flags       - LOG_FLAG_*
+   u8   accel_range, gyro_range, dlpf, smplrt_div
+   f32  accel_scale - m/s² por contagem
+   f32  gyro_scale  - °/s por contagem
+ Arquivos antigos têm header_size = 10 e usam ±2 g e ±250 °/s. A partir da
+ versão 3 o tempo vem de âncoras em us nos blocos delta e nos chunks
+ colunares (a versão 2 gravava o tempo em ms em cada amostra).
+*/
+size_t log_file_header(uint8_t *dst, log_format_t format, uint8_t channels, uint8_t flags,
+    const log_sensor_info_t *sensor);
+
+/*
+ Resumo da configuração gravado em cada frame (campo info do log_writer),
+ para que a recuperação de uma imagem do cartão, sem o cabeçalho do
+ arquivo, saiba decodificar os dados:
+   bits 0-1  accel_range
+   bits 2-3  gyro_range
+   bits 4-6  dlpf
+   bit  7    canal de temperatura (channels = LOG_BASE_CHANNELS + 1)
+   bits 8-15 smplrt_div
+ Os fatores de escala são derivados das faixas. Frames antigos têm 0, que
+ corresponde a ±2 g, ±250 °/s e sem temperatura, como os arquivos antigos.
+*/
+#define LOG_BASE_CHANNELS 7 // tempo, acel x/y/z e giro x/y/z
+
+uint16_t log_frame_info(const log_sensor_info_t *sensor, uint8_t channels);
+
+#endif
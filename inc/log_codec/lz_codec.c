@@ -0,0 +1,163 @@
+#include <string.h>
+
+#include "lz_codec.h"
+
+#define LZ_MIN_MATCH 4
+#define LZ_LAST_LITERALS 5   // Os últimos 5 bytes são sempre literais
+#define LZ_MF_LIMIT 12       // Um match não pode começar nos últimos 12 bytes
+#define LZ_EMPTY 0xFFFF
+
+// Leitura de 32 bits byte a byte (o M0+ não faz acesso desalinhado)
+static inline uint32_t read32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint32_t hash32(uint32_t v) {
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// Grava a parte do comprimento que não coube no nibble do token
+static inline uint8_t *put_length(uint8_t *op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+static uint8_t *put_literals(uint8_t *op, uint8_t *token, const uint8_t *lit, size_t len) {
+    *token = (len >= 15 ? 15 : len) << 4;
+    if (len >= 15) {
+        op = put_length(op, len - 15);
+    }
+    memcpy(op, lit, len);
+    return op + len;
+}
+
+size_t lz_compress(const uint8_t *src, size_t len, uint8_t *dst, uint16_t *table) {
+    uint8_t *op = dst;
+    size_t anchor = 0;
+    size_t ip = 0;
+
+    if (len >= LZ_MF_LIMIT + 1) {
+        size_t mf_limit = len - LZ_MF_LIMIT;
+        size_t match_limit = len - LZ_LAST_LITERALS;
+
+        memset(table, 0xFF, LZ_HASH_SIZE * sizeof(uint16_t));
+
+        while (ip < mf_limit) {
+            uint32_t seq = read32(src + ip);
+            uint32_t h = hash32(seq);
+            size_t ref = table[h];
+            table[h] = ip;
+
+            if (ref == LZ_EMPTY || ip - ref > 0xFFFF || read32(src + ref) != seq) {
+                ip++;
+                continue;
+            }
+
+            // Estende o match para trás sobre os literais pendentes
+            while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+                ip--;
+                ref--;
+            }
+
+            size_t match_len = LZ_MIN_MATCH;
+            while (ip + match_len < match_limit && src[ref + match_len] == src[ip + match_len]) {
+                match_len++;
+            }
+
+            uint8_t *token = op++;
+            op = put_literals(op, token, src + anchor, ip - anchor);
+
+            size_t offset = ip - ref;
+            *op++ = offset & 0xFF;
+            *op++ = offset >> 8;
+
+            size_t ml = match_len - LZ_MIN_MATCH;
+            *token |= ml >= 15 ? 15 : ml;
+            if (ml >= 15) {
+                op = put_length(op, ml - 15);
+            }
+
+            ip += match_len;
+            anchor = ip;
+
+            // Registra uma posição dentro do match para melhorar os próximos
+            if (ip < mf_limit) {
+                table[hash32(read32(src + ip - 2))] = ip - 2;
+            }
+        }
+    }
+
+    uint8_t *token = op++;
+    op = put_literals(op, token, src + anchor, len - anchor);
+
+    return op - dst;
+}
+
+// Lê a parte extra de um comprimento (bytes 255 seguidos do último)
+static inline bool get_length(const uint8_t **ip, const uint8_t *end, size_t *len) {
+    uint8_t b;
+    do {
+        if (*ip >= end) {
+            return false;
+        }
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return true;
+}
+
+bool lz_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t raw_len) {
+    const uint8_t *ip = src;
+    const uint8_t *end = src + len;
+    uint8_t *op = dst;
+    uint8_t *op_end = dst + raw_len;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+
+        size_t lit = token >> 4;
+        if (lit == 15 && !get_length(&ip, end, &lit)) {
+            return false;
+        }
+        if ((size_t)(end - ip) < lit || (size_t)(op_end - op) < lit) {
+            return false;
+        }
+        memcpy(op, ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == end) {
+            break; // A última sequência só tem literais
+        }
+
+        if (end - ip < 2) {
+            return false;
+        }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t match_len = token & 15;
+        if (match_len == 15 && !get_length(&ip, end, &match_len)) {
+            return false;
+        }
+        match_len += LZ_MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(op - dst) || (size_t)(op_end - op) < match_len) {
+            return false;
+        }
+
+        const uint8_t *ref = op - offset;
+        if (offset >= match_len) {
+            memcpy(op, ref, match_len);
+            op += match_len;
+        } else {
+            // Match sobreposto: repete os últimos offset bytes
+            while (match_len--) {
+                *op++ = *ref++;
+            }
+        }
+    }
+
+    return op == op_end;
+}
@@ -0,0 +1,34 @@
+#ifndef LZ_CODEC_H
+#define LZ_CODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Tabela hash de posições anteriores: 2^LZ_HASH_BITS entradas de 16 bits (2 KB)
+#define LZ_HASH_BITS 10
+#define LZ_HASH_SIZE (1u << LZ_HASH_BITS)
+
+// Maior tamanho possível da saída para uma entrada de len bytes
+#define LZ_COMPRESS_BOUND(len) ((len) + (len) / 255 + 16)
+
+/*
+ Compressor LZ77 guloso no formato de bloco do LZ4: sequências de
+ [token][literais][offset u16][comprimento extra], com match mínimo de
+ 4 bytes. A janela é o próprio bloco de entrada (até 64 KB), então cada
+ bloco é descomprimido de forma independente e pode ser lido no
+ computador com qualquer implementação de LZ4 (lz4.block.decompress).
+
+ table deve ter LZ_HASH_SIZE entradas; é reinicializada a cada chamada.
+ dst deve ter ao menos LZ_COMPRESS_BOUND(len) bytes.
+*/
+size_t lz_compress(const uint8_t *src, size_t len, uint8_t *dst, uint16_t *table);
+
+/*
+ Descompressor do mesmo formato, para os conversores no computador. O
+ bloco de len bytes deve produzir exatamente raw_len bytes em dst; retorna
+ false se ele estiver truncado, referenciar antes do início ou não fechar.
+*/
+bool lz_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t raw_len);
+
+#endif
@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "log_writer.h"
+#include "inc/cycle_counter/cycle_counter.h"
+#include "inc/log_codec/crc32.h"
+
+static inline void put_u16(uint8_t *dst, uint16_t v) {
+    dst[0] = v & 0xFF;
+    dst[1] = v >> 8;
+}
+
+static inline void put_u32(uint8_t *dst, uint32_t v) {
+    dst[0] = v & 0xFF;
+    dst[1] = (v >> 8) & 0xFF;
+    dst[2] = (v >> 16) & 0xFF;
+    dst[3] = v >> 24;
+}
+
+// A compressão sempre usa frames; sem frames os grupos são gravados como estão
+void log_writer_open(log_writer_t *w, FIL *file, bool framed, bool compress, uint8_t format, uint32_t session,
+    uint16_t info) {
+    w->file = file;
+    w->framed = framed || compress;
+    w->compress = compress;
+    w->format = format;
+    w->session = session;
+    w->info = info;
+    w->seq = 0;
+    w->len = 0;
+    w->raw_bytes = 0;
+    w->stored_bytes = 0;
+    w->lz_cycles = 0;
+    w->writes = 0;
+    w->write_us_max = 0;
+}
+
+// Grava no cartão medindo a duração. O SysTick não cobre as pausas de
+// centenas de ms do cartão, por isso a medida é em microssegundos.
+static FRESULT log_writer_store(log_writer_t *w, const void *data, size_t len) {
+    UINT bw;
+    uint32_t start = time_us_32();
+    FRESULT res = f_write(w->file, data, len, &bw);
+    uint32_t elapsed = time_us_32() - start;
+
+    w->stored_bytes += bw;
+    w->writes++;
+    if (elapsed > w->write_us_max) {
+        w->write_us_max = elapsed;
+    }
+    return res;
+}
+
+// Comprime (se habilitado), monta o frame e grava o grupo acumulado
+static FRESULT log_writer_write_group(log_writer_t *w) {
+    if (!w->framed) {
+        return log_writer_store(w, w->group, w->len);
+    }
+
+    uint8_t *frame = w->frame;
+    uint8_t *data = frame + LOG_FRAME_HEADER_SIZE;
+    uint8_t method = LOG_FRAME_STORED;
+    size_t data_len = w->len;
+
+    if (w->compress) {
+        uint32_t start = cycle_counter_get();
+        data_len = lz_compress(w->group, w->len, data, w->lz_table);
+        w->lz_cycles += cycle_counter_elapsed(start);
+        method = LOG_FRAME_LZ;
+    }
+
+    if (!w->compress || data_len >= w->len) {
+        method = LOG_FRAME_STORED;
+        data_len = w->len;
+        memcpy(data, w->group, w->len);
+    }
+
+    put_u32(frame, LOG_FRAME_SYNC);
+    put_u32(frame + 4, w->session);
+    put_u32(frame + 8, w->seq++);
+    frame[12] = method;
+    frame[13] = w->format;
+    put_u16(frame + 14, w->len);
+    put_u16(frame + 16, data_len);
+    put_u16(frame + 18, w->info);
+
+    uint32_t crc = crc32_update(0, frame, 20);
+    crc = crc32_update(crc, data, data_len);
+    put_u32(frame + 20, crc);
+
+    return log_writer_store(w, frame, LOG_FRAME_HEADER_SIZE + data_len);
+}
+
+// Garante que os próximos len bytes fiquem no mesmo frame: se não couberem
+// no grupo atual, ele é gravado antes. Sem frames não há o que alinhar.
+FRESULT log_writer_reserve(log_writer_t *w, size_t len) {
+    if (!w->framed || len > LOG_GROUP_SIZE || w->len + len <= LOG_GROUP_SIZE) {
+        return FR_OK;
+    }
+    return log_writer_flush(w);
+}
+
+// Acumula os dados e grava no cartão a cada grupo completo. Cada chamada é
+// tratada como um registro e não é dividida entre frames.
+FRESULT log_writer_write(log_writer_t *w, const void *data, size_t len) {
+    const uint8_t *src = data;
+    FRESULT res = log_writer_reserve(w, len);
+
+    if (res != FR_OK) {
+        return res;
+    }
+
+    w->raw_bytes += len;
+
+    while (len > 0) {
+        size_t chunk = LOG_GROUP_SIZE - w->len;
+        if (chunk > len) {
+            chunk = len;
+        }
+
+        memcpy(w->group + w->len, src, chunk);
+        w->len += chunk;
+        src += chunk;
+        len -= chunk;
+
+        if (w->len == LOG_GROUP_SIZE) {
+            res = log_writer_write_group(w);
+            w->len = 0;
+            if (res != FR_OK) {
+                break;
+            }
+        }
+    }
+
+    return res;
+}
+
+// Grava o grupo parcial pendente (ao encerrar a coleta)
+FRESULT log_writer_flush(log_writer_t *w) {
+    FRESULT res = FR_OK;
+
+    if (w->len > 0) {
+        res = log_writer_write_group(w);
+        w->len = 0;
+    }
+
+    return res;
+}
+
+// Exibe a taxa de compressão e o custo em ciclos por byte
+void log_writer_print_stats(const log_writer_t *w) {
+    printf("Bytes do logger: %llu\n", (unsigned long long)w->raw_bytes);
+    printf("Bytes gravados:  %llu\n", (unsigned long long)w->stored_bytes);
+
+    if (w->stored_bytes > 0) {
+        printf("Taxa de compressão: %.2fx\n", (double)w->raw_bytes / w->stored_bytes);
+    }
+
+    if (w->compress && w->raw_bytes > 0) {
+        printf("LZ: %.1f ciclos/byte\n", (double)w->lz_cycles / w->raw_bytes);
+    }
+
+    printf("Escritas: %lu, maior latência: %lu us\n", (unsigned long)w->writes,
+        (unsigned long)w->write_us_max);
+}
@@ -0,0 +1,65 @@
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ff.h"
+#include "inc/log_codec/lz_codec.h"
+
+// Grupo de setores acumulado em RAM antes de cada f_write. São 8 setores
+// (4 KB) para que um chunk colunar (COL_CHUNK_SIZE) caiba inteiro em um
+// frame; com 4 setores ele seria dividido entre frames. Custa 4 KB a mais
+// de RAM no grupo e no frame, e o LZ rende um pouco mais com a janela
+// maior (CSV de exemplo: 1,25x com 2 KB, 1,31x com 4 KB).
+#define LOG_GROUP_SIZE (8 * FF_MAX_SS)
+
+/*
+ No modo com frames cada grupo é gravado como:
+   u32 sync     = LOG_FRAME_SYNC
+   u32 session  - identifica a sessão de coleta
+   u32 seq      - número do frame na sessão, a partir de 0
+   u8  method   - LOG_FRAME_STORED ou LOG_FRAME_LZ
+   u8  format   - log_format_t dos dados
+   u16 raw_len  - tamanho do grupo descomprimido
+   u16 data_len - bytes que seguem o cabeçalho
+   u16 info     - configuração da coleta (log_frame_info)
+   u32 crc      - CRC-32 dos 20 bytes anteriores e dos dados
+ Os registros (linhas, blocos, chunks) nunca são divididos entre frames,
+ então cada frame íntegro pode ser decodificado mesmo que outros se percam.
+ Grupos que não diminuem com o LZ são gravados sem compressão.
+*/
+#define LOG_FRAME_SYNC 0xA55AD10Cu
+#define LOG_FRAME_HEADER_SIZE 24
+#define LOG_FRAME_STORED 0
+#define LOG_FRAME_LZ 1
+
+typedef struct {
+    FIL *file;
+    bool framed;
+    bool compress;
+    uint8_t format;
+    uint32_t session;
+    uint16_t info;
+    uint32_t seq;
+    size_t len;
+    uint8_t group[LOG_GROUP_SIZE];
+    uint8_t frame[LOG_FRAME_HEADER_SIZE + LZ_COMPRESS_BOUND(LOG_GROUP_SIZE)];
+    uint16_t lz_table[LZ_HASH_SIZE];
+
+    // Estatísticas da sessão atual
+    uint64_t raw_bytes;    // Bytes recebidos do logger
+    uint64_t stored_bytes; // Bytes efetivamente escritos no cartão
+    uint64_t lz_cycles;    // Ciclos gastos na compressão
+    uint32_t writes;       // Chamadas de f_write
+    uint32_t write_us_max; // Maior duração de um f_write
+} log_writer_t;
+
+void log_writer_open(log_writer_t *w, FIL *file, bool framed, bool compress, uint8_t format, uint32_t session,
+    uint16_t info);
+FRESULT log_writer_reserve(log_writer_t *w, size_t len);
+FRESULT log_writer_write(log_writer_t *w, const void *data, size_t len);
+FRESULT log_writer_flush(log_writer_t *w);
+void log_writer_print_stats(const log_writer_t *w);
+
+#endif
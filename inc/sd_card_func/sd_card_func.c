@@ -141,6 +141,21 @@ void run_get_size() {
     printf("%10lu KiB total drive space.\n%10lu KiB available.\n", tot_sect / 2, fre_sect / 2);
 }
 
+// Espaço livre no primeiro cartão, em KiB. f_getfree pode percorrer a FAT
+// inteira, então não deve ser chamada durante a coleta.
+bool sd_get_free_kb(uint32_t *free_kb) {
+    const char *name = sd_get_by_num(0)->pcName;
+    FATFS *p_fs = sd_get_fs_by_name(name);
+    DWORD fre_clust;
+
+    if (!p_fs || f_getfree(name, &fre_clust, &p_fs) != FR_OK) {
+        return false;
+    }
+
+    *free_kb = fre_clust * p_fs->csize / 2;
+    return true;
+}
+
 // Exibe os diretórios e arquivos dentro do cartão SD
 void run_ls() {
     const char *arg1 = strtok(NULL, " ");
@@ -250,3 +265,36 @@ void read_file(const char *filename) {
     printf("\nLeitura do arquivo %s concluída.\n\n", filename);
 }
 
+
+// Mede a vazão (bytes/s) da camada ff_stdio para escritas de 1 e 16 bytes,
+// com e sem o buffer de usuário. O cartão deve estar montado.
+void run_bench_stdio() {
+    static const size_t record_sizes[] = {1, 16};
+    static const int modes[] = {FF_IONBF, FF_IOFBF};
+    const size_t total = 64 * 1024;
+    const char rec[16] = "0123456789abcde";
+
+    for (size_t m = 0; m < count_of(modes); m++) {
+        for (size_t r = 0; r < count_of(record_sizes); r++) {
+            FF_FILE *fp = ff_fopen("bench.bin", "w");
+            if (!fp) {
+                printf("ff_fopen error: %s (%d)\n", strerror(errno), errno);
+                return;
+            }
+            ff_setvbuf(fp, NULL, modes[m], FF_IONBF == modes[m] ? 0 : ffconfigSTDIO_BUFFER_SIZE);
+
+            uint64_t start = time_us_64();
+            for (size_t n = 0; n < total; n += record_sizes[r]) {
+                ff_fwrite(rec, 1, record_sizes[r], fp);
+            }
+            ff_fclose(fp);
+            uint64_t elapsed = time_us_64() - start;
+
+            printf("%s %2u B: %8llu bytes/s\n",
+                FF_IONBF == modes[m] ? "sem buffer" : "com buffer",
+                (unsigned)record_sizes[r], (unsigned long long)total * 1000000ULL / elapsed);
+        }
+    }
+
+    ff_remove("bench.bin");
+}
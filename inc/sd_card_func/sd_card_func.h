@@ -9,6 +9,7 @@
 #include <time.h>
 
 #include "ff.h"
+#include "ff_stdio.h"
 #include "diskio.h"
 #include "f_util.h"
 #include "hw_config.h"
@@ -21,9 +22,11 @@ bool run_format();
 bool run_mount();
 bool run_unmount();
 void run_get_size();
+bool sd_get_free_kb(uint32_t *free_kb);
 void run_ls();
 void run_cat();
 void read_file(const char *filename);
+void run_bench_stdio();
 
 #endif
 
@@ -0,0 +1,232 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "calibration.h"
+#include "mpu6050.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "inc/log_codec/crc32.h"
+
+// A flash é programada em páginas de 256 bytes
+_Static_assert(sizeof(cal_data_t) <= FLASH_PAGE_SIZE, "calibração maior que uma página da flash");
+
+static uint32_t cal_crc(const cal_data_t *c) {
+    return crc32_update(0, c, offsetof(cal_data_t, crc));
+}
+
+// Lê a calibração gravada. Retorna false (e zera os offsets) se o setor
+// estiver apagado ou corrompido.
+bool cal_load(cal_data_t *c) {
+    const cal_data_t *stored = (const cal_data_t *)(XIP_BASE + CAL_FLASH_OFFSET);
+
+    if (stored->magic != CAL_MAGIC || stored->version != CAL_VERSION || stored->bins > CAL_MAX_BINS ||
+        stored->crc != cal_crc(stored)) {
+        cal_clear(c);
+        return false;
+    }
+
+    *c = *stored;
+    return true;
+}
+
+// Apaga o setor reservado e grava a calibração. As interrupções ficam
+// desligadas porque o código roda da própria flash (XIP).
+bool cal_save(cal_data_t *c) {
+    static uint8_t page[FLASH_PAGE_SIZE];
+
+    c->magic = CAL_MAGIC;
+    c->version = CAL_VERSION;
+    c->crc = cal_crc(c);
+
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, c, sizeof(*c));
+
+    uint32_t ints = save_and_disable_interrupts();
+    flash_range_erase(CAL_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    flash_range_program(CAL_FLASH_OFFSET, page, FLASH_PAGE_SIZE);
+    restore_interrupts(ints);
+
+    const cal_data_t *stored = (const cal_data_t *)(XIP_BASE + CAL_FLASH_OFFSET);
+    return memcmp(stored, c, sizeof(*c)) == 0;
+}
+
+void cal_clear(cal_data_t *c) {
+    memset(c, 0, sizeof(*c));
+}
+
+static int16_t div_round(int32_t sum, int32_t n) {
+    return (sum + (sum < 0 ? -n / 2 : n / 2)) / n;
+}
+
+// Média das leituras com a placa parada. O offset do giroscópio é a própria
+// média; o do acelerômetro é a média menos a gravidade esperada, que deve
+// estar sobre um único eixo (placa nivelada em qualquer face).
+cal_result_t cal_measure(i2c_inst_t *i2c, const mpu6050_scale_t *scale, cal_bin_t *out) {
+    int32_t one_g = scale->accel_lsb_per_g;
+    int32_t gyro_spread = scale->gyro_lsb_per_dps_x10 * CAL_GYRO_SPREAD_DPS / 10;
+
+    int32_t sum[7] = {0};
+    int16_t min[6];
+    int16_t max[6];
+
+    for (uint16_t n = 0; n < CAL_SAMPLES; n++) {
+        int16_t accel[3];
+        int16_t gyro[3];
+        int16_t temp;
+        mpu6050_read_raw(i2c, accel, gyro, &temp);
+
+        const int16_t in[6] = {accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2]};
+        for (uint8_t a = 0; a < 6; a++) {
+            sum[a] += in[a];
+            if (n == 0 || in[a] < min[a]) {
+                min[a] = in[a];
+            }
+            if (n == 0 || in[a] > max[a]) {
+                max[a] = in[a];
+            }
+        }
+        sum[6] += temp;
+        sleep_ms(CAL_INTERVAL_MS);
+    }
+
+    for (uint8_t a = 0; a < 6; a++) {
+        int32_t limit = a < 3 ? one_g * CAL_ACCEL_SPREAD_G20 / 20 : gyro_spread;
+        if (max[a] - min[a] > limit) {
+            return CAL_MOVING;
+        }
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->temp_raw = div_round(sum[6], CAL_SAMPLES);
+    for (uint8_t i = 0; i < 3; i++) {
+        int32_t mean = div_round(sum[3 + i], CAL_SAMPLES);
+        out->gyro[i] = div_round(mean * CAL_BASE_GYRO_LSB_X10, scale->gyro_lsb_per_dps_x10);
+    }
+
+    // Eixo vertical: o de maior módulo, que deve ter quase 1 g
+    int16_t mean[3];
+    uint8_t up = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        mean[i] = div_round(sum[i], CAL_SAMPLES);
+        if (abs(mean[i]) > abs(mean[up])) {
+            up = i;
+        }
+    }
+    for (uint8_t i = 0; i < 3; i++) {
+        int32_t limit = one_g * (i == up ? CAL_LEVEL_MIN_G20 : CAL_LEVEL_MAX_OTHER_G20) / 20;
+        if (i == up ? abs(mean[i]) < limit : abs(mean[i]) > limit) {
+            return CAL_GYRO_ONLY;
+        }
+    }
+
+    for (uint8_t i = 0; i < 3; i++) {
+        int32_t g = i != up ? 0 : mean[i] < 0 ? -one_g : one_g;
+        out->accel[i] = (mean[i] - g) << scale->accel_shift;
+    }
+    out->accel_ok = 1;
+    return CAL_OK;
+}
+
+// Guarda a calibração na faixa da sua temperatura: substitui uma faixa
+// próxima, ocupa uma livre ou, com todas ocupadas, a mais próxima
+void cal_store(cal_data_t *c, const cal_bin_t *b) {
+    uint8_t slot = c->bins;
+    int32_t best = INT32_MAX;
+
+    for (uint8_t i = 0; i < c->bins; i++) {
+        int32_t d = abs(c->bin[i].temp_raw - b->temp_raw);
+        if (d < best) {
+            best = d;
+            slot = i;
+        }
+    }
+    if (best >= CAL_BIN_WIDTH && c->bins < CAL_MAX_BINS) {
+        slot = c->bins++;
+    }
+
+    // Sem acelerômetro nivelado, mantém os offsets de aceleração anteriores
+    if (!b->accel_ok && best < CAL_BIN_WIDTH) {
+        memcpy(c->bin[slot].gyro, b->gyro, sizeof(b->gyro));
+        c->bin[slot].temp_raw = b->temp_raw;
+        return;
+    }
+    c->bin[slot] = *b;
+}
+
+// Interpola os offsets entre as duas faixas mais próximas abaixo e acima
+// de temp_raw; fora da faixa calibrada usa a extremidade mais próxima.
+// Só as faixas com o acelerômetro calibrado entram nos offsets de
+// aceleração (accel == true).
+static void interpolate(const cal_data_t *c, int16_t temp_raw, bool accel, int16_t out[3]) {
+    const cal_bin_t *lo = NULL;
+    const cal_bin_t *hi = NULL;
+
+    for (uint8_t i = 0; i < c->bins; i++) {
+        const cal_bin_t *b = &c->bin[i];
+        if (accel && !b->accel_ok) {
+            continue;
+        }
+        if (b->temp_raw <= temp_raw && (!lo || b->temp_raw > lo->temp_raw)) {
+            lo = b;
+        }
+        if (b->temp_raw >= temp_raw && (!hi || b->temp_raw < hi->temp_raw)) {
+            hi = b;
+        }
+    }
+
+    if (!lo) {
+        lo = hi;
+    }
+    if (!hi) {
+        hi = lo;
+    }
+    if (!lo) {
+        memset(out, 0, 3 * sizeof(int16_t));
+        return;
+    }
+
+    int32_t span = hi->temp_raw - lo->temp_raw;
+    int32_t pos = temp_raw - lo->temp_raw;
+    for (uint8_t i = 0; i < 3; i++) {
+        const int16_t *a = accel ? lo->accel : lo->gyro;
+        const int16_t *b = accel ? hi->accel : hi->gyro;
+        int64_t d = (int64_t)(b[i] - a[i]) * pos;
+        out[i] = span ? a[i] + (int32_t)((d + (d < 0 ? -span / 2 : span / 2)) / span) : a[i];
+    }
+}
+
+// Calcula os offsets para a temperatura atual (compensação linear por
+// partes entre as faixas gravadas) e os converte para as contagens da
+// configuração atual (zeros se não há calibração)
+void cal_select(const cal_data_t *c, int16_t temp_raw, const mpu6050_scale_t *scale, cal_bin_t *active) {
+    memset(active, 0, sizeof(*active));
+    active->temp_raw = temp_raw;
+
+    interpolate(c, temp_raw, true, active->accel);
+    interpolate(c, temp_raw, false, active->gyro);
+    for (uint8_t i = 0; i < c->bins; i++) {
+        active->accel_ok |= c->bin[i].accel_ok;
+    }
+
+    for (uint8_t i = 0; i < 3; i++) {
+        active->accel[i] = div_round(active->accel[i], 1 << scale->accel_shift);
+        active->gyro[i] = div_round(active->gyro[i] * scale->gyro_lsb_per_dps_x10, CAL_BASE_GYRO_LSB_X10);
+    }
+}
+
+void cal_print(const cal_data_t *c) {
+    if (c->bins == 0) {
+        printf("Sem calibração: offsets zerados\n");
+        return;
+    }
+
+    for (uint8_t i = 0; i < c->bins; i++) {
+        const cal_bin_t *b = &c->bin[i];
+        int32_t t = mpu6050_temp_centi(b->temp_raw);
+        printf("Faixa %d (%ld.%02ld °C): acel %d %d %d%s, giro %d %d %d\n", i + 1, (long)(t / 100),
+            (long)abs(t % 100), b->accel[0], b->accel[1], b->accel[2], b->accel_ok ? "" : " (não calibrado)",
+            b->gyro[0], b->gyro[1], b->gyro[2]);
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hardware/i2c.h"
+#include "mpu6050.h"
+
+// Último setor de 4 KB da flash, fora da área do programa
+#define CAL_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+
+#define CAL_MAGIC 0x4C41434Du // "MCAL"
+#define CAL_VERSION 1
+
+// Faixas de temperatura guardadas. Uma nova calibração substitui a faixa
+// com temperatura a menos de CAL_BIN_WIDTH (2.5 °C, 340 contagens por °C).
+#define CAL_MAX_BINS 4
+#define CAL_BIN_WIDTH 850
+
+// Média de 512 leituras a cada 2 ms (cerca de 1 s parado)
+#define CAL_SAMPLES 512
+#define CAL_INTERVAL_MS 2
+
+// Os offsets são guardados em contagens das faixas ±2 g e ±250 °/s e
+// convertidos para a faixa configurada em cal_select
+#define CAL_BASE_GYRO_LSB_X10 1310
+
+// Limites em frações da escala (numerador / 20). Variação máxima aceita
+// durante a média: 0.05 g no acelerômetro e 2 °/s no giroscópio; acima
+// disso a placa foi movida e a calibração é descartada. O offset do
+// acelerômetro só é calculado com um eixo acima de 0.85 g e os outros
+// abaixo de 0.15 g (o offset de fábrica chega a 0.08 g). Uma inclinação
+// residual é confundida com offset, então a placa deve estar apoiada em
+// uma superfície nivelada.
+#define CAL_ACCEL_SPREAD_G20 1
+#define CAL_GYRO_SPREAD_DPS 2
+#define CAL_LEVEL_MIN_G20 17
+#define CAL_LEVEL_MAX_OTHER_G20 3
+
+typedef struct {
+    int16_t temp_raw;   // Temperatura da calibração (registrador 0x41)
+    uint8_t accel_ok;   // Acelerômetro nivelado: offsets de aceleração válidos
+    uint8_t reserved;
+    int16_t accel[3];   // Offsets em contagens (±2 g e ±250 °/s)
+    int16_t gyro[3];
+} cal_bin_t;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t bins;
+    uint8_t reserved;
+    cal_bin_t bin[CAL_MAX_BINS];
+    uint32_t crc;
+} cal_data_t;
+
+typedef enum {
+    CAL_OK,
+    CAL_GYRO_ONLY, // Placa inclinada: só o giroscópio foi calibrado
+    CAL_MOVING     // Placa em movimento: nada foi alterado
+} cal_result_t;
+
+static inline int16_t cal_sub(int16_t v, int16_t offset) {
+    int32_t r = v - offset;
+    return r > INT16_MAX ? INT16_MAX : r < INT16_MIN ? INT16_MIN : r;
+}
+
+// Subtrai os offsets já selecionados das contagens brutas (caminho da coleta)
+static inline void cal_apply(const cal_bin_t *b, int16_t accel[3], int16_t gyro[3]) {
+    for (int i = 0; i < 3; i++) {
+        accel[i] = cal_sub(accel[i], b->accel[i]);
+        gyro[i] = cal_sub(gyro[i], b->gyro[i]);
+    }
+}
+
+bool cal_load(cal_data_t *c);
+bool cal_save(cal_data_t *c);
+void cal_clear(cal_data_t *c);
+cal_result_t cal_measure(i2c_inst_t *i2c, const mpu6050_scale_t *scale, cal_bin_t *out);
+void cal_store(cal_data_t *c, const cal_bin_t *b);
+void cal_select(const cal_data_t *c, int16_t temp_raw, const mpu6050_scale_t *scale, cal_bin_t *active);
+void cal_print(const cal_data_t *c);
+
+#endif
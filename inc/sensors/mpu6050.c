@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include "mpu6050.h"
 
 void mpu6050_reset(i2c_inst_t *i2c) {
@@ -11,26 +13,61 @@ void mpu6050_reset(i2c_inst_t *i2c) {
     sleep_ms(10);
 }
 
+static bool mpu6050_write_reg(i2c_inst_t *i2c, uint8_t reg, uint8_t value) {
+    uint8_t buffer[] = {reg, value};
+    return i2c_write_blocking(i2c, MPU6050_ADDR, buffer, 2, false) == 2;
+}
+
+// Grava os registradores de configuração e confere a leitura de volta
+bool mpu6050_configure(i2c_inst_t *i2c, const mpu6050_config_t *cfg) {
+    const uint8_t values[4] = {
+        cfg->smplrt_div,
+        cfg->dlpf & 0x07,
+        (cfg->gyro_range & 0x03) << 3,
+        (cfg->accel_range & 0x03) << 3
+    };
+
+    for (uint8_t i = 0; i < 4; i++) {
+        if (!mpu6050_write_reg(i2c, MPU6050_SMPLRT_DIV + i, values[i])) {
+            return false;
+        }
+    }
+
+    uint8_t reg = MPU6050_SMPLRT_DIV;
+    uint8_t check[4];
+    i2c_write_blocking(i2c, MPU6050_ADDR, &reg, 1, true);
+    if (i2c_read_blocking(i2c, MPU6050_ADDR, check, 4, false) != 4) {
+        return false;
+    }
+    return memcmp(check, values, sizeof(values)) == 0;
+}
+
+// Sensibilidade do giroscópio em LSB/(°/s) * 10, como no datasheet
+static const uint16_t gyro_lsb_x10[4] = {1310, 655, 328, 164};
+
+void mpu6050_scale(const mpu6050_config_t *cfg, mpu6050_scale_t *scale) {
+    scale->accel_shift = cfg->accel_range;
+    scale->accel_lsb_per_g = 16384 >> cfg->accel_range;
+    scale->gyro_lsb_per_dps_x10 = gyro_lsb_x10[cfg->gyro_range];
+    scale->accel_scale = 9.81f / scale->accel_lsb_per_g;
+    scale->gyro_scale = 10.0f / scale->gyro_lsb_per_dps_x10;
+
+    uint32_t rate = (cfg->dlpf == 0 || cfg->dlpf == 7) ? 8000 : 1000;
+    scale->sample_period_us = 1000000u * (1 + cfg->smplrt_div) / rate;
+}
+
 // Realiza a leitura dos dados do acelerômetro, giroscópio e temperatura interna
+// Os registradores 0x3B a 0x48 (acel, temperatura, giro) são contíguos e
+// lidos em uma única transação de 14 bytes
 void mpu6050_read_raw(i2c_inst_t *i2c, int16_t accel[3], int16_t gyro[3], int16_t *temp) {
-    uint8_t buffer[6];
+    uint8_t buffer[14];
     uint8_t val = 0x3B;
 
     i2c_write_blocking(i2c, MPU6050_ADDR, &val, 1, true);
-    i2c_read_blocking(i2c, MPU6050_ADDR, buffer, 6, false);
+    i2c_read_blocking(i2c, MPU6050_ADDR, buffer, 14, false);
     for (int i = 0; i < 3; i++) {
         accel[i] = (buffer[i * 2] << 8) | buffer[(i * 2) + 1];
+        gyro[i] = (buffer[8 + i * 2] << 8) | buffer[8 + (i * 2) + 1];
     }
-
-    val = 0x43;
-    i2c_write_blocking(i2c, MPU6050_ADDR, &val, 1, true);
-    i2c_read_blocking(i2c, MPU6050_ADDR, buffer, 6, false);
-    for (int i = 0; i < 3; i++) {
-        gyro[i] = (buffer[i * 2] << 8) | buffer[(i * 2) + 1];
-    }
-
-    val = 0x41;
-    i2c_write_blocking(i2c, MPU6050_ADDR, &val, 1, true);
-    i2c_read_blocking(i2c, MPU6050_ADDR, buffer, 2, false);
-    *temp = (buffer[0] << 8) | buffer[1];
+    *temp = (buffer[6] << 8) | buffer[7];
 }
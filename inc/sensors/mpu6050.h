@@ -7,7 +7,61 @@
 
 #define MPU6050_ADDR 0x68
 
+// Registradores de configuração
+#define MPU6050_SMPLRT_DIV 0x19
+#define MPU6050_CONFIG 0x1A
+#define MPU6050_GYRO_CONFIG 0x1B
+#define MPU6050_ACCEL_CONFIG 0x1C
+
+// Faixas: o valor é o campo FS_SEL / AFS_SEL (bits 4:3)
+typedef enum {
+    MPU6050_ACCEL_2G = 0,
+    MPU6050_ACCEL_4G = 1,
+    MPU6050_ACCEL_8G = 2,
+    MPU6050_ACCEL_16G = 3
+} mpu6050_accel_range_t;
+
+typedef enum {
+    MPU6050_GYRO_250DPS = 0,
+    MPU6050_GYRO_500DPS = 1,
+    MPU6050_GYRO_1000DPS = 2,
+    MPU6050_GYRO_2000DPS = 3
+} mpu6050_gyro_range_t;
+
+/*
+ Configuração do sensor. dlpf é o campo DLPF_CFG do registrador CONFIG
+ (0 = sem filtro, 260 Hz; 6 = 5 Hz). A taxa de saída é
+ 1 kHz / (1 + smplrt_div) com o filtro ligado e 8 kHz / (1 + smplrt_div)
+ com dlpf = 0 (o acelerômetro continua limitado a 1 kHz).
+*/
+typedef struct {
+    mpu6050_accel_range_t accel_range;
+    mpu6050_gyro_range_t gyro_range;
+    uint8_t dlpf;
+    uint8_t smplrt_div;
+} mpu6050_config_t;
+
+// Valores após o reset: ±2 g, ±250 °/s, sem filtro e sem divisor
+#define MPU6050_DEFAULT_CONFIG {MPU6050_ACCEL_2G, MPU6050_GYRO_250DPS, 0, 0}
+
+// Fatores de escala derivados da configuração, calculados uma vez
+typedef struct {
+    uint16_t accel_lsb_per_g;      // 16384 >> accel_range (exato)
+    uint8_t accel_shift;           // accel_range
+    uint16_t gyro_lsb_per_dps_x10; // 1310, 655, 328, 164 (tabela do datasheet)
+    float accel_scale;             // m/s² por contagem
+    float gyro_scale;              // °/s por contagem
+    uint32_t sample_period_us;     // Intervalo entre dados novos do sensor
+} mpu6050_scale_t;
+
+// Temperatura em centésimos de °C: raw / 340 + 36.53
+static inline int32_t mpu6050_temp_centi(int16_t raw) {
+    return (raw * 5 + (raw < 0 ? -8 : 8)) / 17 + 3653;
+}
+
 void mpu6050_reset(i2c_inst_t *i2c);
+bool mpu6050_configure(i2c_inst_t *i2c, const mpu6050_config_t *cfg);
+void mpu6050_scale(const mpu6050_config_t *cfg, mpu6050_scale_t *scale);
 void mpu6050_read_raw(i2c_inst_t *i2c, int16_t accel[3], int16_t gyro[3], int16_t *temp);
 
 #endif
@@ -0,0 +1,29 @@
+#include "temp_comp.h"
+
+void temp_comp_init(temp_comp_t *t, uint16_t decim) {
+    t->enabled = true;
+    t->decim = decim ? decim : 1;
+    temp_comp_reset(t, 0);
+}
+
+// Inicia uma nova média com a leitura atual como valor vigente
+void temp_comp_reset(temp_comp_t *t, int16_t temp_raw) {
+    t->count = 0;
+    t->sum = 0;
+    t->temp_raw = temp_raw;
+}
+
+// Acumula uma leitura. Retorna true quando um bloco de decim leituras
+// termina; temp_raw passa a ter a nova média.
+bool temp_comp_push(temp_comp_t *t, int16_t temp_raw) {
+    t->sum += temp_raw;
+    if (++t->count < t->decim) {
+        return false;
+    }
+
+    int32_t n = t->count;
+    t->temp_raw = (t->sum + (t->sum < 0 ? -n / 2 : n / 2)) / n;
+    t->count = 0;
+    t->sum = 0;
+    return true;
+}
@@ -0,0 +1,23 @@
+#ifndef TEMP_COMP_H
+#define TEMP_COMP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Amostras por média de temperatura. A temperatura muda em segundos, então
+// os offsets são recalculados só uma vez por bloco e não a cada amostra.
+#define TEMP_COMP_DEFAULT_DECIM 64
+
+typedef struct {
+    bool enabled;      // Recalcula os offsets com a temperatura medida
+    uint16_t decim;
+    uint16_t count;
+    int32_t sum;
+    int16_t temp_raw;  // Última média (registrador 0x41)
+} temp_comp_t;
+
+void temp_comp_init(temp_comp_t *t, uint16_t decim);
+void temp_comp_reset(temp_comp_t *t, int16_t temp_raw);
+bool temp_comp_push(temp_comp_t *t, int16_t temp_raw);
+
+#endif
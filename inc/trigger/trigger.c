@@ -0,0 +1,136 @@
+#include <string.h>
+
+#include "trigger.h"
+
+#define RING_MASK (TRIGGER_RING_SIZE - 1)
+
+void trigger_config(trigger_t *t, trigger_mode_t mode, uint16_t threshold, uint32_t pre_ms, uint32_t post_ms,
+    uint32_t holdoff_ms) {
+    t->mode = mode;
+    t->threshold = threshold;
+    t->pre_ms = pre_ms;
+    t->post_ms = post_ms;
+    t->holdoff_ms = holdoff_ms;
+    trigger_reset(t);
+}
+
+// Esvazia o anel e rearma, mantendo a configuração
+void trigger_reset(trigger_t *t) {
+    t->state = TRIGGER_ARMED;
+    t->end_us = 0;
+    t->trigger_us = 0;
+    t->events = 0;
+    t->primed = false;
+    t->head = 0;
+    t->count = 0;
+    t->pop = 0;
+}
+
+static void ring_store(trigger_t *t, uint32_t index, uint64_t time_us, const int16_t accel[3],
+    const int16_t gyro[3]) {
+    trigger_sample_t *s = &t->ring[t->head];
+    s->time_us = time_us;
+    s->index = index;
+    memcpy(s->accel, accel, sizeof(s->accel));
+    memcpy(s->gyro, gyro, sizeof(s->gyro));
+
+    t->head = (t->head + 1) & RING_MASK;
+    if (t->count < TRIGGER_RING_SIZE) {
+        t->count++;
+    }
+}
+
+// Avalia a condição em todos os eixos e atualiza o histórico do detector.
+// A linha de base fica congelada durante a captura para que um evento
+// longo não passe a ser tratado como repouso.
+static bool detect(trigger_t *t, const int16_t accel[3], const int16_t gyro[3]) {
+    const int16_t in[TRIGGER_AXES] = {accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2]};
+    bool fired = false;
+
+    if (!t->primed) {
+        for (uint8_t a = 0; a < TRIGGER_AXES; a++) {
+            t->prev[a] = in[a];
+            t->baseline[a] = (int32_t)in[a] << 8;
+        }
+        t->primed = true;
+    }
+
+    for (uint8_t a = 0; a < TRIGGER_AXES; a++) {
+        int32_t ref = t->mode == TRIGGER_SLOPE ? t->prev[a] : (t->baseline[a] + 128) >> 8;
+        int32_t d = in[a] - ref;
+
+        if ((d < 0 ? -d : d) > t->threshold) {
+            fired = true;
+        }
+        if (t->state != TRIGGER_CAPTURE) {
+            t->baseline[a] += (((int32_t)in[a] << 8) - t->baseline[a]) >> TRIGGER_BASELINE_SHIFT;
+        }
+        t->prev[a] = in[a];
+    }
+
+    return fired;
+}
+
+// Os tempos são contados em us desde o início da coleta (64 bits, sem volta)
+trigger_action_t trigger_push(trigger_t *t, uint32_t index, uint64_t time_us, const int16_t accel[3],
+    const int16_t gyro[3]) {
+    bool fired = detect(t, accel, gyro);
+
+    if (t->state == TRIGGER_CAPTURE) {
+        if (fired) {
+            t->end_us = time_us + t->post_ms * 1000ull; // Novo disparo estende o evento
+        }
+        if (time_us <= t->end_us) {
+            return TRIGGER_WRITE;
+        }
+
+        t->state = TRIGGER_HOLDOFF;
+        t->end_us = time_us + t->holdoff_ms * 1000ull;
+        ring_store(t, index, time_us, accel, gyro);
+        return TRIGGER_END;
+    }
+
+    ring_store(t, index, time_us, accel, gyro);
+
+    if (t->state == TRIGGER_HOLDOFF) {
+        if (time_us <= t->end_us) {
+            return TRIGGER_IDLE;
+        }
+        t->state = TRIGGER_ARMED;
+    }
+
+    if (!fired) {
+        return TRIGGER_IDLE;
+    }
+
+    // Seleciona as amostras do anel dentro da janela de pré-disparo
+    uint64_t pre_us = t->pre_ms * 1000ull;
+    uint16_t n = 0;
+    while (n < t->count) {
+        const trigger_sample_t *s = &t->ring[(t->head - 1 - n) & RING_MASK];
+        if (time_us - s->time_us > pre_us) {
+            break;
+        }
+        n++;
+    }
+
+    t->pop = n;
+    t->count = 0;
+    t->state = TRIGGER_CAPTURE;
+    t->trigger_us = time_us;
+    t->end_us = time_us + t->post_ms * 1000ull;
+    t->events++;
+    return TRIGGER_START;
+}
+
+// Entrega o pré-disparo do evento atual, da amostra mais antiga para a
+// mais recente. Retorna false quando não há mais amostras.
+bool trigger_pop(trigger_t *t, trigger_sample_t *out) {
+    if (t->pop == 0) {
+        return false;
+    }
+
+    *out = t->ring[(t->head - t->pop) & RING_MASK];
+    t->pop--;
+    return true;
+}
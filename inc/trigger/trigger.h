@@ -0,0 +1,80 @@
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Eixos monitorados: acel x/y/z e giro x/y/z (contagens do sensor)
+#define TRIGGER_AXES 6
+
+// Amostras guardadas antes do disparo (potência de 2). Com 24 bytes por
+// amostra são 24 KB de RAM; a 1 kHz cobrem cerca de 1 s de pré-disparo.
+#define TRIGGER_RING_SIZE 1024
+
+// Constante de tempo da linha de base do modo "level": 2^7 amostras
+#define TRIGGER_BASELINE_SHIFT 7
+
+typedef enum {
+    TRIGGER_LEVEL, // |x - linha de base| > limiar
+    TRIGGER_SLOPE  // |x[n] - x[n-1]| > limiar
+} trigger_mode_t;
+
+typedef enum {
+    TRIGGER_ARMED,
+    TRIGGER_CAPTURE,
+    TRIGGER_HOLDOFF
+} trigger_state_t;
+
+// O que o chamador deve fazer com a amostra passada a trigger_push
+typedef enum {
+    TRIGGER_IDLE,  // Guardada no anel, nada a gravar
+    TRIGGER_START, // Novo evento: gravar o pré-disparo (trigger_pop), que já inclui esta amostra
+    TRIGGER_WRITE, // Gravar a amostra
+    TRIGGER_END    // Evento encerrado; a amostra voltou para o anel
+} trigger_action_t;
+
+typedef struct {
+    uint64_t time_us; // Instante medido desde o início da coleta
+    uint32_t index;   // Posição na grade de amostragem
+    int16_t accel[3];
+    int16_t gyro[3];
+} trigger_sample_t;
+
+/*
+ Captura por disparo. Fora dos eventos as amostras só passam por um anel
+ em RAM. Quando algum eixo ultrapassa o limiar, o evento começa com as
+ amostras do anel dos últimos pre_ms e continua até post_ms depois do
+ último disparo: um novo disparo durante a captura estende o evento. Após
+ o fim, disparos são ignorados por holdoff_ms, mas o anel continua sendo
+ preenchido, de modo que o próximo evento também tem pré-disparo (sem
+ repetir amostras já gravadas).
+*/
+typedef struct {
+    trigger_mode_t mode;
+    uint16_t threshold;
+    uint32_t pre_ms;
+    uint32_t post_ms;
+    uint32_t holdoff_ms;
+
+    trigger_state_t state;
+    uint64_t end_us;     // Fim da captura ou do hold-off
+    uint64_t trigger_us; // Instante do disparo que abriu o evento
+    uint32_t events;
+    bool primed;
+    int16_t prev[TRIGGER_AXES];
+    int32_t baseline[TRIGGER_AXES]; // Q8
+
+    uint16_t head;  // Próxima posição livre
+    uint16_t count; // Amostras válidas no anel
+    uint16_t pop;   // Amostras ainda a entregar por trigger_pop
+    trigger_sample_t ring[TRIGGER_RING_SIZE];
+} trigger_t;
+
+void trigger_config(trigger_t *t, trigger_mode_t mode, uint16_t threshold, uint32_t pre_ms, uint32_t post_ms,
+    uint32_t holdoff_ms);
+void trigger_reset(trigger_t *t);
+trigger_action_t trigger_push(trigger_t *t, uint32_t index, uint64_t time_us, const int16_t accel[3],
+    const int16_t gyro[3]);
+bool trigger_pop(trigger_t *t, trigger_sample_t *out);
+
+#endif
@@ -13,10 +13,26 @@
 #include "inc/button/button.h"
 #include "inc/buzzer/buzzer.h"
 #include "inc/display/ssd1306.h"
+#include "inc/display/strip_chart.h"
+#include "inc/display/notify.h"
 #include "inc/i2c_protocol/i2c_protocol.h"
 #include "inc/led_rgb/led.h"
 #include "inc/sensors/mpu6050.h"
+#include "inc/sensors/calibration.h"
+#include "inc/sensors/temp_comp.h"
 #include "inc/sd_card_func/sd_card_func.h"
+#include "inc/log_codec/delta_codec.h"
+#include "inc/log_codec/log_file.h"
+#include "inc/log_codec/csv_format.h"
+#include "inc/log_codec/col_chunk.h"
+#include "inc/log_writer/log_writer.h"
+#include "inc/cycle_counter/cycle_counter.h"
+#include "inc/dsp/decimator.h"
+#include "inc/dsp/window_stats.h"
+#include "inc/dsp/filter_bank.h"
+#include "inc/dsp/attitude.h"
+#include "inc/dsp/spectrum.h"
+#include "inc/trigger/trigger.h"
 
 // Definição de variáveis e macros importantes para o debounce dos botões
 #define DEBOUNCE_TIME 260
@@ -31,6 +47,100 @@ static volatile bool is_mount_runned = false;
 // Informações do arquivo gerado
 static char file_name[20] = "adc_col_data.csv";
 
+// Formato de gravação selecionado pelo terminal (comando "format csv|delta|col")
+static log_format_t log_format = LOG_FORMAT_CSV;
+
+// Compressão LZ dos grupos de setores (comando "compress on|off")
+static bool log_compress = false;
+
+// Frames com sincronismo e CRC para recuperação após falta de energia. Os
+// formatos binários e a compressão sempre usam frames; o comando
+// "frame on|off" permite usá-los também no CSV.
+static bool log_frame_csv = false;
+
+// Extensão do arquivo para cada formato: sem frames, com frames e comprimido
+static const char *log_file_ext[LOG_FORMAT_MAX][3] = {
+    [LOG_FORMAT_CSV] = {".csv", ".cfr", ".clz"},
+    [LOG_FORMAT_DELTA] = {".bin", ".bin", ".blz"},
+    [LOG_FORMAT_COLUMNAR] = {".col", ".col", ".olz"},
+    [LOG_FORMAT_STATS] = {".sta", ".sfr", ".slz"},
+};
+
+// Acumula os dados em grupos de setores antes de escrever no cartão
+static log_writer_t log_writer;
+
+// Número de canais gravados no formato binário (tempo, acel x/y/z, giro x/y/z).
+// Nos blocos delta o tempo não é gravado por amostra: vem da âncora do bloco.
+#define LOG_CHANNELS 7
+
+// Bloco de amostras comprimidas com delta + zigzag (varint ou largura fixa)
+static delta_block_t delta_block;
+static uint8_t delta_block_buf[DELTA_BLOCK_MAX_SIZE];
+
+// Chunk colunar: cada canal armazenado de forma contígua
+static col_chunk_t col_chunk;
+
+// Configuração do MPU6050 (comando "mpu") e fatores de escala derivados dela.
+// A inicial é 200 Hz com o filtro de 44 Hz: a grade de 125 us dos valores de
+// reset é mais curta que a própria leitura I2C, e toda amostra seria perdida.
+static mpu6050_config_t mpu_config = {MPU6050_ACCEL_2G, MPU6050_GYRO_250DPS, 3, 4};
+static mpu6050_scale_t mpu_scale;
+
+// Relógio da coleta em us: posição da amostra atual na grade de amostragem
+// e instante medido da leitura desde a primeira amostra
+static bool sample_clock_started = false;
+static uint64_t start_us;
+static uint64_t next_sample_us;
+static uint32_t sample_index;
+static uint64_t sample_us;
+
+// Mostra cada amostra no terminal (comando "echo", para depuração). Com a
+// saída serial a cada amostra o laço não acompanha taxas altas.
+static bool sample_echo = false;
+
+// A página de coleta mostra a contagem de amostras a cada SAMPLING_REFRESH_MS
+#define SAMPLING_REFRESH_MS 200
+static uint64_t sampling_last_us = 0;
+
+// Calibração gravada na flash e offsets da faixa de temperatura em uso,
+// subtraídos das contagens brutas em cada leitura
+static cal_data_t calibration;
+static cal_bin_t cal_active;
+
+// Temperatura média a cada TEMP_COMP_DEFAULT_DECIM amostras: recalcula os
+// offsets da calibração e pode ser gravada como canal extra (comando "temp")
+static temp_comp_t temp_comp = {.enabled = true, .decim = TEMP_COMP_DEFAULT_DECIM};
+static bool temp_log = false;
+
+// Filtros aplicados às leituras do sensor antes de qualquer gravação
+static filter_bank_t filter_bank;
+
+// Atitude estimada durante a coleta, gravada em adc_att.csv
+static attitude_t attitude = {.tau_ms = ATTITUDE_DEFAULT_TAU_MS};
+static bool attitude_enabled = false;
+static FIL attitude_file;
+static bool attitude_file_ok = false;
+
+// Espectro de vibração por janelas, gravado em adc_fft.csv (uma linha por eixo)
+static spectrum_t spectrum = {.n = SPECTRUM_DEFAULT_N};
+static bool spectrum_enabled = false;
+static FIL spectrum_file;
+static bool spectrum_file_ok = false;
+
+// Captura por disparo: fora dos eventos as amostras ficam só no anel em RAM
+// e o cartão não é acessado (comando "trig")
+static trigger_t trigger;
+static bool trigger_enabled = false;
+
+// Agregador do formato "stats": só o resumo de cada janela é gravado
+static wstats_t wstats = {.window = WSTATS_DEFAULT_WINDOW};
+
+// Fluxos em taxas menores, obtidos da mesma coleta por decimação em cascata.
+// Cada estágio grava um CSV próprio (adc_decN.csv, N = fator acumulado).
+static decim_chain_t decim_chain;
+static FIL decim_file[DECIM_MAX_STAGES];
+static bool decim_file_ok[DECIM_MAX_STAGES];
+
 // Definição de contadores que controlam estados temporários no sistema
 static volatile uint mount_counter = 0;
 static volatile uint file_counter = 0;
@@ -39,6 +149,8 @@ static volatile uint file_counter = 0;
 typedef enum {
     MENU_MAIN = 0,
     MENU_SAMPLING = 1,
+    MENU_DASHBOARD = 2,
+    MENU_WAVE = 3,
     MENU_MAX
 } menu_page_t;
 
@@ -61,13 +173,14 @@ static int16_t accel[3];
 static int16_t gyro[3];
 static int16_t temp;
 
+// Valores convertidos em ponto fixo: centésimos de m/s² e de °/s
 typedef struct sensor_data {
-    float accel_x;
-    float accel_y;
-    float accel_z;
-    float gyro_x;
-    float gyro_y;
-    float gyro_z;
+    int32_t accel_x;
+    int32_t accel_y;
+    int32_t accel_z;
+    int32_t gyro_x;
+    int32_t gyro_y;
+    int32_t gyro_z;
 } sensor_data_t;
 
 static sensor_data_t sensor_data;
@@ -78,19 +191,83 @@ static bool color = true;
 static char buffer[100];
 static volatile bool needs_redraw = true;
 
+// Mensagens temporárias e bipes, exibidos sem parar o laço principal
+#define NOTIFY_MS 2500
+static notify_t notify;
+static buzzer_beep_t beep;
+
+// Painel de desempenho: recalculado e redesenhado a cada DASH_REFRESH_MS,
+// independente da taxa de amostragem
+#define DASH_REFRESH_MS 500
+static uint64_t dash_last_us = 0;
+static uint32_t dash_last_samples = 0;
+static uint64_t dash_last_bytes = 0;
+static uint32_t samples_dropped = 0; // Posições da grade de amostragem perdidas
+static uint32_t sd_free_kb = 0;      // Espaço livre no início da coleta
+static bool sd_free_ok = false;
+
+// Gráfico de um eixo na página MENU_WAVE, alimentado durante a coleta por
+// colunas de mínimo/máximo. As linhas acima de WAVE_TOP mostram o eixo e a
+// faixa vertical.
+#define WAVE_REFRESH_MS 100
+#define WAVE_TOP 10
+static const char *wave_axis_name[6] = {"ax", "ay", "az", "gx", "gy", "gz"};
+static strip_chart_t wave;
+static uint8_t wave_axis = 2;
+static uint64_t wave_last_us = 0;
+
 // Definição do protótipo das funções que serão criadas
 static void gpio_irq_handler(uint gpio, uint32_t events);
-static void show_action_message(const char* l1, const char* l2, const char* l3, uint32_t duration);
 static void show_main_menu();
 static void show_sampling_menu();
+static void show_dashboard();
+static void show_wave();
+static void set_wave(char *args);
 static void get_sensor_data();
+static char *centi_str(char *buf, int32_t centi, bool negative);
 static void process_stdio(int cRxedChar);
-
-static absolute_time_t start_time;
+static FRESULT log_write_header(FIL *file);
+static FRESULT log_write_sample(FIL *file, uint32_t index, uint64_t time_us, const int16_t a[3], const int16_t g[3]);
+static FRESULT log_flush(FIL *file);
+static FRESULT log_write_chunk();
+static void set_log_format(const char *name);
+static void set_log_compress(const char *arg);
+static void set_log_frame(const char *arg);
+static bool log_is_framed();
+static void update_file_name();
+static void set_decim(char *args);
+static void set_stats_window(const char *arg);
+static void set_filter(char *args);
+static void set_attitude(const char *arg, const char *tau);
+static void attitude_open();
+static FRESULT attitude_write(uint32_t elapsed_ms);
+static void attitude_close();
+static void set_spectrum(const char *arg);
+static void set_trigger(char *args);
+static void run_calibration(const char *arg);
+static void select_calibration();
+static void set_temp(char *args);
+static bool log_has_temp();
+static bool apply_mpu_config();
+static void set_mpu(char *args);
+static bool sample_due();
+static void wait_next_sample();
+static void set_echo(const char *arg);
+static FRESULT trigger_write(FIL *file);
+static void spectrum_open();
+static FRESULT spectrum_write(uint32_t elapsed_ms);
+static void spectrum_close();
+static FRESULT log_write_stats();
+static void decim_open();
+static FRESULT decim_write(uint32_t elapsed_ms);
+static void decim_close();
 
 int main() {
     stdio_init_all();
 
+    // Contador de ciclos usado nas medições de desempenho
+    cycle_counter_init();
+
     // Inicialização dos botões
     btns_init();
 
@@ -111,6 +288,16 @@ int main() {
     // Inicializa o MPU6050
     printf("Inicializando o MPU6050...\n");
     mpu6050_reset(I2C0_PORT);
+    if (!apply_mpu_config()) {
+        printf("Falha ao configurar o MPU6050\n");
+    }
+
+    // Offsets de calibração gravados na flash
+    if (cal_load(&calibration)) {
+        select_calibration();
+    } else {
+        printf("MPU6050 sem calibração (comando \"cal\")\n");
+    }
 
     //Inicialização do barramento I2C para o display
     i2c_setup(I2C1_SDA, I2C1_SCL);
@@ -120,30 +307,26 @@ int main() {
     ssd1306_setup(&ssd, WIDTH, HEIGHT, false, DISP_ADDR, I2C1_PORT);
     ssd1306_config(&ssd);
     ssd1306_send_data(&ssd);
+    if (!ssd1306_dma_init(&ssd, NULL)) {
+        printf("Display sem DMA, atualizações bloqueantes\n");
+    }
 
     // Limpa o display. O display inicia com todos os pixels apagados.
     ssd1306_fill(&ssd, false);
     ssd1306_send_data(&ssd);
 
-    printf("Tudo pronto...\n");
+    strip_chart_init(&wave, WIDTH, STRIP_DEFAULT_DECIM);
 
-    ssd1306_fill(&ssd, !color);
-    ssd1306_send_data(&ssd);
+    notify_init(&notify, &ssd, color);
 
-    sprintf(buffer, "DATA LOGGER");
-    ssd1306_draw_string(&ssd, buffer, 5, 20);
-    sprintf(buffer, "INICIALIZADO");
-    ssd1306_draw_string(&ssd, buffer, 5, 30);
-    ssd1306_send_data(&ssd);
+    printf("Tudo pronto...\n");
 
-    sleep_ms(2500);
-
-    ssd1306_fill(&ssd, !color);
-    ssd1306_send_data(&ssd);
+    notify_post(&notify, "DATA LOGGER", "INICIALIZADO", "", NOTIFY_MS, -1);
 
     // Criação de instância para o arquiv
     FIL file;
     uint file_open_counter = 0;
+    menu_page_t shown_page = MENU_MAX;
 
     while (true) {
         // Realiza a leitura da entrada do terminal serial
@@ -152,33 +335,66 @@ int main() {
             process_stdio(cRxedChar);
         }
 
-        // Exibe o conteúdo do arquivo se pressionar 'd'
-        if (cRxedChar == 'd') {
-            read_file(file_name);
+        // Mensagens e bipes temporários. Quando a última mensagem sai da tela
+        // a página atual é redesenhada por completo.
+        if (notify_poll(&notify)) {
+            needs_redraw = true;
+            shown_page = MENU_MAX;
         }
+        buzzer_poll(&beep);
+
+        // Exibição do menu principal (a mensagem temporária tem prioridade)
+        bool page_changed = menu_page != shown_page;
+        if (!notify_active(&notify)) {
+            shown_page = menu_page;
+            switch (menu_page) {
+                case MENU_MAIN:
+                    if (needs_redraw) { // Verifica se é necessário atualizar o display
+                        show_main_menu();
+                        needs_redraw = false;
+                    }
+                    break;
 
-        // Exibição do menu principal
-        switch (menu_page) {
-            case MENU_MAIN:
-                if (needs_redraw) { // Verifica se é necessário atualizar o display
-                    show_main_menu();
-                    needs_redraw = false;
-                }
-                break;
+                case MENU_SAMPLING:
+                    if (needs_redraw) { // Verifica se é necessário atualizar o display
+                        show_sampling_menu();
+                        needs_redraw = false;
+                    }
+                    break;
+
+                case MENU_DASHBOARD:
+                    // Atualização em intervalo fixo: a tela não disputa tempo com a coleta
+                    if (page_changed || time_us_64() - dash_last_us >= DASH_REFRESH_MS * 1000ull) {
+                        show_dashboard();
+                        needs_redraw = false;
+                    }
+                    break;
 
-            case MENU_SAMPLING:
-                if (needs_redraw) { // Verifica se é necessário atualizar o display
-                    show_sampling_menu();
+                case MENU_WAVE:
+                    // As outras páginas apagam a tela: ao entrar o gráfico é redesenhado
+                    if (page_changed) {
+                        strip_chart_invalidate(&wave);
+                    }
+                    if (strip_chart_pending(&wave) && time_us_64() - wave_last_us >= WAVE_REFRESH_MS * 1000ull) {
+                        show_wave();
+                    }
                     needs_redraw = false;
-                }
-                break;
+                    break;
 
-            default:
-                break;
+                default:
+                    break;
+            }
         }
 
-        // Controle do LED azul durante a coleta de dados
-        if (absolute_time_diff_us(led_time, get_absolute_time()) / 1000 > 600 && sampling_state == SAMPLING_RUNNING) {
+        // Envia o quadro que ficou pendente enquanto o anterior era transmitido
+        ssd1306_flush_poll(&ssd);
+
+        // LED da mensagem em exibição; fora dela, controle do LED azul
+        // durante a coleta de dados
+        if (notify_led(&notify) >= 0) {
+            leds_turnoff();
+            gpio_put(notify_led(&notify), 1);
+        } else if (absolute_time_diff_us(led_time, get_absolute_time()) / 1000 > 600 && sampling_state == SAMPLING_RUNNING) {
             led_time = get_absolute_time();
             leds_turnoff();
             gpio_put(BLUE_LED_PIN, 1);
@@ -191,21 +407,18 @@ int main() {
             leds_turnoff();
             gpio_put(BLUE_LED_PIN, 1);
 
-            show_action_message("Montando o", "Cartao SD", "", 2500);
+            // Fica na tela até o resultado
+            notify_post(&notify, "Montando o", "Cartao SD", "", 0, BLUE_LED_PIN);
 
             bool success = run_mount();
 
             if (success) {
-                leds_turnoff();
-                gpio_put(GREEN_LED_PIN, 1);
-                show_action_message("Cartao SD", "Montado com", "Sucesso", 2500);
+                notify_post(&notify, "Cartao SD", "Montado com", "Sucesso", NOTIFY_MS, GREEN_LED_PIN);
                 is_mount_runned = true;
                 needs_redraw = true;
                 mount_counter = 1;
             } else {
-                leds_turnoff();
-                gpio_put(RED_LED_PIN, 1);
-                show_action_message("Falha ao", "Montar o", "Cartao SD", 2500);
+                notify_post(&notify, "Falha ao", "Montar o", "Cartao SD", NOTIFY_MS, RED_LED_PIN);
                 is_mount_runned = false;
                 needs_redraw = true;
                 mount_counter = 0;
@@ -219,21 +432,17 @@ int main() {
             leds_turnoff();
             gpio_put(BLUE_LED_PIN, 1);
 
-            show_action_message("Desmontando o", "Cartao SD", "", 2500);
+            notify_post(&notify, "Desmontando o", "Cartao SD", "", 0, BLUE_LED_PIN);
 
             bool success = run_unmount();
 
             if (success) {
-                leds_turnoff();
-                gpio_put(GREEN_LED_PIN, 1);
-                show_action_message("Cartao SD", "Desmontado", "com Sucesso", 2500);
+                notify_post(&notify, "Cartao SD", "Desmontado", "com Sucesso", NOTIFY_MS, GREEN_LED_PIN);
                 is_mount_runned = false;
                 needs_redraw = true;
                 mount_counter = 0;
             } else {
-                leds_turnoff();
-                gpio_put(RED_LED_PIN, 1);
-                show_action_message("Falha ao", "Desmontar o", "Cartao SD", 2500);
+                notify_post(&notify, "Falha ao", "Desmontar o", "Cartao SD", NOTIFY_MS, RED_LED_PIN);
                 is_mount_runned = true;
                 needs_redraw = true;
                 mount_counter = 1;
@@ -257,107 +466,87 @@ int main() {
             }
 
             if (res != FR_OK) {
-                leds_turnoff();
-                gpio_put(RED_LED_PIN, 1);
-
-                show_action_message("Erro ao", "Iniciar", "Coleta", 2000);
-                show_action_message("Realize a", "Montagem", "do Cartao SD", 1500);
+                notify_post(&notify, "Erro ao", "Iniciar", "Coleta", 2000, RED_LED_PIN);
+                notify_post(&notify, "Realize a", "Montagem", "do Cartao SD", 1500, RED_LED_PIN);
                 needs_redraw = true;
 
                 file_open_counter = 0;
                 sampling_state = SAMPLING_IDLE;
-
-                gpio_put(RED_LED_PIN, 0);
             } else {
-                UINT bw;
-                needs_redraw = true;
-                char buffer_file[256];
-
                 // Escreve o cabeçalho do arquivo
                 if (file_counter == 0) {
-                    buzzer_play(BUZZER_LEFT_PIN, 1000);
-                    sleep_ms(250);
-                    buzzer_stop(BUZZER_LEFT_PIN);
-                    buzzer_play(BUZZER_LEFT_PIN, 1000);
-                    sleep_ms(250);
-                    buzzer_stop(BUZZER_LEFT_PIN);
-
-                    sprintf(buffer_file, "time_s,accel_x,accel_y,accel_z,giro_x,giro_y,giro_z\n");
-                    res = f_write(&file, buffer_file, strlen(buffer_file), &bw);
-                } else {
-                    absolute_time_t instant_time = to_ms_since_boot(get_absolute_time());
+                    needs_redraw = true;
+                    buzzer_beep(&beep, BUZZER_LEFT_PIN, 1000, 2, 200, 100);
+
+                    select_calibration();
+                    sd_free_ok = sd_get_free_kb(&sd_free_kb);
+                    strip_chart_reset(&wave);
+                    sample_clock_started = false;
+                    res = log_write_header(&file);
+                    trigger_reset(&trigger);
+                    decim_open();
+                    attitude_open();
+                    spectrum_open();
+                    filter_bank_reset(&filter_bank);
+                    file_counter++;
+                } else if (sample_due()) {
+                    if (time_us_64() - sampling_last_us >= SAMPLING_REFRESH_MS * 1000ull) {
+                        sampling_last_us = time_us_64();
+                        needs_redraw = true;
+                    }
+                    uint32_t elapsed_ms = (uint32_t)(sample_us / 1000);
 
                     get_sensor_data();
+                    strip_chart_push(&wave, wave_axis < 3 ? accel[wave_axis] : gyro[wave_axis - 3]);
 
-                    if (file_counter == 1) {
-                        start_time = instant_time;
+                    if (trigger_enabled) {
+                        res = trigger_write(&file);
+                    } else {
+                        res = log_write_sample(&file, sample_index, sample_us, accel, gyro);
                     }
-
-                    float elapsed_time = (instant_time - start_time) / 1000.0f;
-
-                    sprintf(buffer_file, "%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n",
-                        elapsed_time,
-                        sensor_data.accel_x,sensor_data.accel_y,sensor_data.accel_z,
-                        sensor_data.gyro_x,sensor_data.gyro_y,sensor_data.gyro_z
-                    );
-                    res = f_write(&file, buffer_file, strlen(buffer_file), &bw);
+                    decim_write(elapsed_ms);
+                    attitude_write(elapsed_ms);
+                    spectrum_write(elapsed_ms);
+                    file_counter++;
                 }
-
-                file_counter++;
             }
         }
 
         // Fecha o arquivo
         if (sampling_state == SAMPLING_STOPPING) {
+            log_flush(&file);
             f_close(&file);
+            decim_close();
+            attitude_close();
+            spectrum_close();
 
-            leds_turnoff();
-            gpio_put(BLUE_LED_PIN, 0);
-            gpio_put(GREEN_LED_PIN, 1);
-
-            buzzer_play(BUZZER_LEFT_PIN, 600);
-            sleep_ms(250);
-            buzzer_stop(BUZZER_LEFT_PIN);
-            buzzer_play(BUZZER_LEFT_PIN, 600);
-            sleep_ms(250);
-            buzzer_stop(BUZZER_LEFT_PIN);
+            buzzer_beep(&beep, BUZZER_LEFT_PIN, 600, 2, 200, 100);
+            notify_post(&notify, "Coleta de", "Dados", "Encerrada", NOTIFY_MS, GREEN_LED_PIN);
 
-            needs_redraw = true;
-            show_action_message("Coleta de", "Dados", "Encerrada", 2500);
             // Reset de variáveis
             file_counter = 0;
             file_open_counter = 0;
 
-            leds_turnoff();
-
             // Volta ao estado inicial
             sampling_state = SAMPLING_IDLE;
             needs_redraw = true;
         }
 
-        sleep_ms(60);
+        // Durante a coleta o laço dorme só até a próxima posição da grade de
+        // amostragem; parado, volta a cada 60 ms para os botões e o terminal
+        if (sampling_state == SAMPLING_RUNNING && sample_clock_started) {
+            wait_next_sample();
+        } else {
+            sleep_ms(60);
+        }
     }
 
     return 0;
 }
 
-// Responsável por montar as menssagens temporárioas na tela
-static void show_action_message(const char* l1, const char* l2, const char* l3, uint32_t duration) {
-    ssd1306_fill(&ssd, !color);
-    ssd1306_send_data(&ssd);
-
-    ssd1306_draw_string(&ssd, l1, 5, 20);
-    ssd1306_draw_string(&ssd, l2, 5, 30);
-    ssd1306_draw_string(&ssd, l3, 5, 40);
-    ssd1306_send_data(&ssd);
-
-    sleep_ms(duration);
-}
-
 // Exibe a tela com o menu principal
 static void show_main_menu() {
     ssd1306_fill(&ssd, !color);
-    ssd1306_send_data(&ssd);
 
     if (sampling_state == SAMPLING_IDLE) {
         sprintf(buffer, "A - INICIAR");
@@ -373,19 +562,20 @@ static void show_main_menu() {
     }
     ssd1306_draw_string(&ssd, buffer, 5, 30);
 
-    ssd1306_send_data(&ssd);
+    ssd1306_flush(&ssd);
 }
 
 // Exibe a tela com o número de amostras coletadas em tempo real
 static void show_sampling_menu() {
     ssd1306_fill(&ssd, !color);
-    ssd1306_send_data(&ssd);
 
     if (sampling_state == SAMPLING_RUNNING) {
-        sprintf(buffer, "Amostras Coletadas");
         sprintf(buffer, "QTND: %d", file_counter);
         ssd1306_draw_string(&ssd, buffer, 5, 30);
-        ssd1306_draw_string(&ssd, buffer, 5, 30);
+        if (trigger_enabled) {
+            sprintf(buffer, "EVENTOS: %lu", (unsigned long)trigger.events);
+            ssd1306_draw_string(&ssd, buffer, 5, 40);
+        }
     } else {
         sprintf(buffer, "Coleta");
         ssd1306_draw_string(&ssd, buffer, 5, 20);
@@ -395,7 +585,75 @@ static void show_sampling_menu() {
         ssd1306_draw_string(&ssd, buffer, 5, 40);
     }
 
-    ssd1306_send_data(&ssd);
+    ssd1306_flush(&ssd);
+}
+
+// Painel de desempenho: taxa real de amostragem, ocupação do grupo em RAM
+// que aguarda o f_write, amostras perdidas, vazão e maior latência de
+// escrita no cartão e espaço livre estimado
+static void show_dashboard() {
+    uint64_t now = time_us_64();
+    uint32_t dt_us = (uint32_t)(now - dash_last_us);
+    uint32_t samples = file_counter > 0 ? file_counter - 1 : 0; // O cabeçalho também conta
+    uint64_t stored = log_writer.stored_bytes;
+    uint32_t rate_centi = 0;
+    uint32_t bytes_per_s = 0;
+
+    // Sem referência anterior ou com uma coleta nova, a taxa fica em zero
+    if (dash_last_us != 0 && samples >= dash_last_samples && stored >= dash_last_bytes && dt_us > 0) {
+        rate_centi = (uint32_t)((uint64_t)(samples - dash_last_samples) * 100000000 / dt_us);
+        bytes_per_s = (uint32_t)((stored - dash_last_bytes) * 1000000 / dt_us);
+    }
+    dash_last_us = now;
+    dash_last_samples = samples;
+    dash_last_bytes = stored;
+
+    ssd1306_fill(&ssd, !color);
+
+    sprintf(buffer, "TAXA: %lu.%lu/s", (unsigned long)(rate_centi / 100), (unsigned long)(rate_centi / 10 % 10));
+    ssd1306_draw_string(&ssd, buffer, 5, 2);
+    sprintf(buffer, "GRUPO: %u%%", (unsigned)(log_writer.len * 100 / LOG_GROUP_SIZE));
+    ssd1306_draw_string(&ssd, buffer, 5, 12);
+    sprintf(buffer, "PERDAS: %lu", (unsigned long)samples_dropped);
+    ssd1306_draw_string(&ssd, buffer, 5, 22);
+    uint32_t kbps_x10 = (uint32_t)((uint64_t)bytes_per_s * 10 / 1024);
+    sprintf(buffer, "SD: %lu.%lu KB/s", (unsigned long)(kbps_x10 / 10), (unsigned long)(kbps_x10 % 10));
+    ssd1306_draw_string(&ssd, buffer, 5, 32);
+    sprintf(buffer, "LATMAX: %lu ms", (unsigned long)((log_writer.write_us_max + 500) / 1000));
+    ssd1306_draw_string(&ssd, buffer, 5, 42);
+    if (sd_free_ok) {
+        uint32_t used_kb = (uint32_t)(stored / 1024);
+        uint32_t free_kb = sd_free_kb > used_kb ? sd_free_kb - used_kb : 0;
+        sprintf(buffer, "LIVRE: %lu MB", (unsigned long)(free_kb / 1024));
+    } else {
+        sprintf(buffer, "LIVRE: --");
+    }
+    ssd1306_draw_string(&ssd, buffer, 5, 52);
+
+    ssd1306_flush(&ssd);
+}
+
+// Gráfico do eixo selecionado. A tela só é apagada quando a escala muda;
+// no resto dos quadros só as colunas novas são desenhadas e enviadas.
+static void show_wave() {
+    if (wave.full_redraw) {
+        ssd1306_fill(&ssd, !color);
+
+        // Faixa vertical do gráfico em g ou °/s
+        const char *name = wave_axis_name[wave_axis];
+        if (wave_axis < 3) {
+            uint32_t centi_g = (uint32_t)wave.span * 100 / mpu_scale.accel_lsb_per_g;
+            sprintf(buffer, "%s faixa %lu.%02lug", name, (unsigned long)(centi_g / 100), (unsigned long)(centi_g % 100));
+        } else {
+            uint32_t dps = (uint32_t)wave.span * 10 / mpu_scale.gyro_lsb_per_dps_x10;
+            sprintf(buffer, "%s faixa %lu/s", name, (unsigned long)dps);
+        }
+        ssd1306_draw_string(&ssd, buffer, 0, 0);
+    }
+
+    strip_chart_draw(&wave, &ssd, WAVE_TOP, HEIGHT - 1);
+    ssd1306_flush(&ssd);
+    wave_last_us = time_us_64();
 }
 
 // Função responsável por realizar o tratamento das interrupções geradas pelos botões
@@ -430,19 +688,874 @@ static void get_sensor_data() {
     // Realiza a leitura dos sensores integrados no MPU6050
     mpu6050_read_raw(I2C0_PORT, accel, gyro, &temp);
 
-    // Conversão para float dos valores lidos pelo giroscópio
-    sensor_data.gyro_x = gyro[0] / 131.0f;  // em °/s
-    sensor_data.gyro_y = gyro[1] / 131.0f;
-    sensor_data.gyro_z = gyro[2] / 131.0f;
+    // A temperatura vem na mesma leitura; os offsets só são recalculados
+    // quando a média de um bloco de amostras fica pronta
+    if (temp_comp_push(&temp_comp, temp) && temp_comp.enabled) {
+        cal_select(&calibration, temp_comp.temp_raw, &mpu_scale, &cal_active);
+    }
+
+    // Offsets de calibração, já em contagens: uma subtração por eixo
+    cal_apply(&cal_active, accel, gyro);
+
+    // Filtragem em ponto fixo, no lugar, das contagens brutas
+    filter_bank_process(&filter_bank, accel, gyro);
 
-    // Conversão para float dos valores lidos pelo acelerômetro e adequação à escala (g=9.81 m/s^2)
-    sensor_data.accel_x = (accel[0] / 16384.0f) * 9.81; // em g
-    sensor_data.accel_y = (accel[1] / 16384.0f) * 9.81;
-    sensor_data.accel_z = (accel[2] / 16384.0f) * 9.81;
+    // Conversão em ponto fixo dos valores lidos pelo giroscópio (centésimos de °/s)
+    sensor_data.gyro_x = gyro_to_centi(gyro[0], mpu_scale.gyro_lsb_per_dps_x10);
+    sensor_data.gyro_y = gyro_to_centi(gyro[1], mpu_scale.gyro_lsb_per_dps_x10);
+    sensor_data.gyro_z = gyro_to_centi(gyro[2], mpu_scale.gyro_lsb_per_dps_x10);
 
+    // Conversão em ponto fixo dos valores lidos pelo acelerômetro (centésimos de m/s², g=9.81 m/s^2)
+    sensor_data.accel_x = accel_to_centi(accel[0], mpu_scale.accel_shift);
+    sensor_data.accel_y = accel_to_centi(accel[1], mpu_scale.accel_shift);
+    sensor_data.accel_z = accel_to_centi(accel[2], mpu_scale.accel_shift);
+
+    if (!sample_echo) {
+        return;
+    }
+
+    char x[12], y[12], z[12];
     printf("----\n");
-    printf("ACCEL X: %.2f, Y: %.2f, Z: %.2f \n", sensor_data.accel_x, sensor_data.accel_y, sensor_data.accel_z);
-    printf("GYRO X: %.2f, Y: %.2f, Z: %.2f \n", sensor_data.gyro_x, sensor_data.gyro_y, sensor_data.gyro_z);
+    printf("ACCEL X: %s, Y: %s, Z: %s \n", centi_str(x, sensor_data.accel_x, accel[0] < 0),
+        centi_str(y, sensor_data.accel_y, accel[1] < 0), centi_str(z, sensor_data.accel_z, accel[2] < 0));
+    printf("GYRO X: %s, Y: %s, Z: %s \n", centi_str(x, sensor_data.gyro_x, gyro[0] < 0),
+        centi_str(y, sensor_data.gyro_y, gyro[1] < 0), centi_str(z, sensor_data.gyro_z, gyro[2] < 0));
+}
+
+// Formata um valor em centésimos como string terminada em '\0'
+static char *centi_str(char *buf, int32_t centi, bool negative) {
+    *csv_put_centi(buf, centi, negative) = '\0';
+    return buf;
+}
+
+// Escreve o cabeçalho do arquivo de acordo com o formato selecionado
+static FRESULT log_write_header(FIL *file) {
+    UINT bw;
+    FRESULT res = FR_OK;
+
+    log_sensor_info_t sensor = {
+        .accel_range = mpu_config.accel_range,
+        .gyro_range = mpu_config.gyro_range,
+        .dlpf = mpu_config.dlpf,
+        .smplrt_div = mpu_config.smplrt_div,
+        .accel_scale = mpu_scale.accel_scale,
+        .gyro_scale = mpu_scale.gyro_scale,
+    };
+    uint8_t channels = log_has_temp() ? LOG_CHANNELS + 1 : LOG_CHANNELS;
+
+    // Arquivos binários e comprimidos começam com o cabeçalho DLOG, fora dos frames
+    bool framed = log_is_framed();
+    if (framed) {
+        uint8_t header[LOG_FILE_HEADER_SIZE];
+        uint8_t flags = LOG_FLAG_FRAMED | (log_compress ? LOG_FLAG_LZ : 0);
+        size_t len = log_file_header(header, log_format, channels, flags, &sensor);
+
+        res = f_write(file, header, len, &bw);
+    }
+
+    // O identificador da sessão separa coletas diferentes na recuperação, e
+    // cada frame repete a configuração do sensor
+    log_writer_open(&log_writer, file, framed, log_compress, log_format, time_us_32(),
+        log_frame_info(&sensor, channels));
+
+    if (log_format == LOG_FORMAT_DELTA) {
+        delta_block_init(&delta_block, log_has_temp() ? LOG_CHANNELS : LOG_CHANNELS - 1);
+        return res;
+    }
+
+    if (log_format == LOG_FORMAT_COLUMNAR) {
+        col_chunk_reset(&col_chunk);
+        return res;
+    }
+
+    if (log_format == LOG_FORMAT_STATS) {
+        wstats_reset(&wstats);
+        if (res == FR_OK) {
+            res = log_writer_write(&log_writer, WSTATS_HEADER, strlen(WSTATS_HEADER));
+        }
+        return res;
+    }
+
+    if (res == FR_OK) {
+        const char *csv_header = log_has_temp() ? CSV_HEADER_TEMP : CSV_HEADER;
+        res = log_writer_write(&log_writer, csv_header, strlen(csv_header));
+    }
+    return res;
+}
+
+// Grava uma amostra (valores brutos do acelerômetro em a e do giroscópio em
+// g) da posição index da grade, lida time_us depois do início da coleta
+static FRESULT log_write_sample(FIL *file, uint32_t index, uint64_t time_us, const int16_t a[3], const int16_t g[3]) {
+    FRESULT res = FR_OK;
+
+    if (log_format == LOG_FORMAT_DELTA) {
+        // Valores brutos do sensor; a conversão de escala é feita no computador.
+        // O último canal (temperatura média) só é usado com "temp log on".
+        int32_t sample[LOG_CHANNELS] = {
+            a[0], a[1], a[2],
+            g[0], g[1], g[2],
+            temp_comp.temp_raw
+        };
+
+        // O bloco é escrito no cartão quando está completo. Posições perdidas
+        // da grade ficam no próprio bloco (quase sempre 0 bits por amostra).
+        if (!delta_block_accepts(&delta_block, index)) {
+            res = log_flush(file);
+        }
+        delta_block_push_at(&delta_block, index, mpu_scale.sample_period_us, time_us, sample);
+        return res;
+    }
+
+    if (log_format == LOG_FORMAT_COLUMNAR) {
+        if (col_chunk_full(&col_chunk)) {
+            res = log_write_chunk();
+        }
+        col_chunk_push(&col_chunk, index, mpu_scale.sample_period_us, time_us, a, g);
+        return res;
+    }
+
+    if (log_format == LOG_FORMAT_STATS) {
+        if (wstats_push(&wstats, (uint32_t)(time_us / 1000), a, g)) {
+            res = log_write_stats();
+        }
+        return res;
+    }
+
+    // Linha montada só com inteiros, com o tempo em resolução de 1 us
+    char buffer_file[CSV_LINE_MAX];
+    size_t len = csv_format_line(buffer_file, time_us, a, g);
+    if (log_has_temp()) {
+        int32_t t = mpu6050_temp_centi(temp_comp.temp_raw);
+        buffer_file[len - 1] = ',';
+        len = csv_put_centi(buffer_file + len, t, t < 0) - buffer_file;
+        buffer_file[len++] = '\n';
+    }
+    return log_writer_write(&log_writer, buffer_file, len);
+}
+
+// Escreve no cartão as amostras ainda pendentes no bloco atual
+static FRESULT log_flush(FIL *file) {
+    FRESULT res = FR_OK;
+
+    if (log_format == LOG_FORMAT_DELTA && delta_block.samples > 0) {
+        size_t len = delta_block_encode(&delta_block, delta_block_buf);
+        res = log_writer_write(&log_writer, delta_block_buf, len);
+        delta_block_reset(&delta_block);
+    }
+
+    if (log_format == LOG_FORMAT_COLUMNAR && col_chunk.samples > 0) {
+        res = log_write_chunk();
+    }
+
+    // A última janela, incompleta, também é gravada (com o seu n real)
+    if (log_format == LOG_FORMAT_STATS && wstats.count > 0) {
+        res = log_write_stats();
+    }
+
+    FRESULT res_group = log_writer_flush(&log_writer);
+    return res != FR_OK ? res : res_group;
+}
+
+_Static_assert(COL_CHUNK_SIZE <= LOG_GROUP_SIZE, "chunk colunar maior que um frame do log_writer");
+
+// Grava o chunk colunar completo (COL_CHUNK_SIZE bytes) e o esvazia
+static FRESULT log_write_chunk() {
+    uint8_t header[COL_CHUNK_HEADER_SIZE];
+    col_chunk_header(&col_chunk, header);
+
+    // O chunk é gravado em três partes, mas deve ficar inteiro em um frame
+    FRESULT res = log_writer_reserve(&log_writer, COL_CHUNK_SIZE);
+    if (res == FR_OK) {
+        res = log_writer_write(&log_writer, header, sizeof(header));
+    }
+    if (res == FR_OK) {
+        res = log_writer_write(&log_writer, col_chunk.index, sizeof(col_chunk.index));
+    }
+    if (res == FR_OK) {
+        res = log_writer_write(&log_writer, col_chunk.axis, sizeof(col_chunk.axis));
+    }
+
+    col_chunk_reset(&col_chunk);
+    return res;
+}
+
+// Grava a linha de resumo da janela atual e inicia a próxima
+static FRESULT log_write_stats() {
+    char line[WSTATS_LINE_MAX];
+    size_t len = wstats_format_line(&wstats, line);
+
+    wstats_reset(&wstats);
+    return log_writer_write(&log_writer, line, len);
+}
+
+// Altera o formato de gravação (só permitido fora da coleta)
+static void set_log_format(const char *name) {
+    if (sampling_state != SAMPLING_IDLE) {
+        printf("Formato não pode ser alterado durante a coleta\n");
+        return;
+    }
+
+    if (name && 0 == strcmp(name, "csv")) {
+        log_format = LOG_FORMAT_CSV;
+    } else if (name && 0 == strcmp(name, "delta")) {
+        log_format = LOG_FORMAT_DELTA;
+    } else if (name && 0 == strcmp(name, "col")) {
+        log_format = LOG_FORMAT_COLUMNAR;
+    } else if (name && 0 == strcmp(name, "stats")) {
+        log_format = LOG_FORMAT_STATS;
+    } else {
+        printf("Uso: format csv|delta|col|stats\n");
+        return;
+    }
+
+    update_file_name();
+    printf("Formato: %s (arquivo %s)\n", name, file_name);
+}
+
+// Habilita ou desabilita a compressão LZ (só permitido fora da coleta)
+static void set_log_compress(const char *arg) {
+    if (sampling_state != SAMPLING_IDLE) {
+        printf("Compressão não pode ser alterada durante a coleta\n");
+        return;
+    }
+
+    if (arg && 0 == strcmp(arg, "on")) {
+        log_compress = true;
+    } else if (arg && 0 == strcmp(arg, "off")) {
+        log_compress = false;
+    } else {
+        printf("Uso: compress on|off\n");
+        return;
+    }
+
+    update_file_name();
+    printf("Compressão: %s (arquivo %s)\n", arg, file_name);
+}
+
+// Habilita ou desabilita os frames com CRC no CSV (só permitido fora da coleta)
+static void set_log_frame(const char *arg) {
+    if (sampling_state != SAMPLING_IDLE) {
+        printf("Frames não podem ser alterados durante a coleta\n");
+        return;
+    }
+
+    if (arg && 0 == strcmp(arg, "on")) {
+        log_frame_csv = true;
+    } else if (arg && 0 == strcmp(arg, "off")) {
+        log_frame_csv = false;
+    } else {
+        printf("Uso: frame on|off\n");
+        return;
+    }
+
+    update_file_name();
+    printf("Frames no CSV: %s (arquivo %s)\n", arg, file_name);
+}
+
+// Tudo que não é CSV puro é gravado em frames, após o cabeçalho DLOG
+static bool log_is_framed() {
+    return log_format != LOG_FORMAT_CSV || log_compress || log_frame_csv;
+}
+
+// Define o número de amostras por janela do formato "stats"
+static void set_stats_window(const char *arg) {
+    if (sampling_state != SAMPLING_IDLE) {
+        printf("Janela não pode ser alterada durante a coleta\n");
+        return;
+    }
+
+    long window = arg ? atol(arg) : 0;
+    if (window < 1 || window > WSTATS_MAX_WINDOW) {
+        printf("Uso: stats <amostras> (1 a %d, atual %d)\n", WSTATS_MAX_WINDOW, wstats.window);
+        return;
+    }
+
+    wstats_init(&wstats, window);
+    printf("Janela de estatísticas: %d amostras\n", wstats.window);
+}
+
+// Configura os filtros:
+//   filter lp|hp <fc_hz> <fs_hz> [seções]  cascata Butterworth de biquads
+//   filter fir <coef> <fc_hz> <fs_hz>      FIR passa-baixas curto
+//   filter off                             remove todos os filtros
+static void set_filter(char *args) {
+    if (sampling_state != SAMPLING_IDLE) {
+        printf("Filtros não podem ser alterados durante a coleta\n");
+        return;
+    }
+
+    char *type = args ? strtok(args, " ") : NULL;
+    bool ok = true;
+
+    if (type && 0 == strcmp(type, "off")) {
+        filter_bank_clear(&filter_bank);
+    } else if (type && (0 == strcmp(type, "lp") || 0 == strcmp(type, "hp"))) {
+        char *fc = strtok(NULL, " ");
+        char *fs = strtok(NULL, " ");
+        char *sections = strtok(NULL, " ");
+        ok = fc && fs && filter_bank_set_biquads(&filter_bank,
+            type[0] == 'l' ? FILTER_LOWPASS : FILTER_HIGHPASS,
+            strtof(fc, NULL), strtof(fs, NULL), sections ? atoi(sections) : 1);
+    } else if (type && 0 == strcmp(type, "fir")) {
+        char *taps = strtok(NULL, " ");
+        char *fc = strtok(NULL, " ");
+        char *fs = strtok(NULL, " ");
+        ok = taps && fc && fs && filter_bank_set_fir(&filter_bank, atoi(taps), strtof(fc, NULL), strtof(fs, NULL));
+    } else if (type) {
+        ok = false;
+    }
+
+    if (!ok) {
+        printf("Uso: filter lp|hp <fc_hz> <fs_hz> [seções 1-%d] | filter fir <coef 1-%d> <fc_hz> <fs_hz> | filter off\n",
+            FILTER_MAX_BIQUADS, FILTER_MAX_FIR);
+        return;
+    }
+    filter_bank_print(&filter_bank);
+}
+
+// Liga ou desliga a estimativa de atitude: "att on [tau_ms]" ou "att off"
+static void set_attitude(const char *arg, const char *tau) {
+    if (sampling_state != SAMPLING_IDLE) {
+        printf("Atitude não pode ser alterada durante a coleta\n");
+        return;
+    }
+
+    if (arg && 0 == strcmp(arg, "on")) {
+        long tau_ms = tau ? atol(tau) : ATTITUDE_DEFAULT_TAU_MS;
+        if (tau_ms < 1 || tau_ms > 60000) {
+            printf("Constante de tempo inválida (1 a 60000 ms)\n");
+            return;
+        }
+        attitude_init(&attitude, tau_ms);
+        attitude_enabled = true;
+        printf("Atitude: ligada, tau = %lu ms (arquivo adc_att.csv)\n", (unsigned long)attitude.tau_ms);
+    } else if (arg && 0 == strcmp(arg, "off")) {
+        attitude_enabled = false;
+        printf("Atitude: desligada\n");
+    } else {
+        printf("Uso: att on [tau_ms] | att off\n");
+    }
+}
+
+static void attitude_open() {
+    if (!attitude_enabled) {
+        return;
+    }
+
+    UINT bw;
+    attitude_reset(&attitude);
+    FRESULT res = f_open(&attitude_file, "adc_att.csv", FA_WRITE | FA_CREATE_ALWAYS);
+    if (res == FR_OK) {
+        res = f_write(&attitude_file, ATTITUDE_HEADER, strlen(ATTITUDE_HEADER), &bw);
+    }
+    attitude_file_ok = (res == FR_OK);
+    if (!attitude_file_ok) {
+        printf("Erro ao abrir adc_att.csv: %s (%d)\n", FRESULT_str(res), res);
+    }
+}
+
+// Atualiza a atitude com a amostra atual e grava uma linha
+static FRESULT attitude_write(uint32_t elapsed_ms) {
+    if (!attitude_enabled) {
+        return FR_OK;
+    }
+
+    attitude_update(&attitude, elapsed_ms, accel, gyro);
+    if (!attitude_file_ok) {
+        return FR_OK;
+    }
+
+    char line[ATTITUDE_LINE_MAX];
+    UINT bw;
+    size_t len = attitude_format_line(&attitude, elapsed_ms, line);
+    return f_write(&attitude_file, line, len, &bw);
+}
+
+static void attitude_close() {
+    if (attitude_file_ok) {
+        f_close(&attitude_file);
+        attitude_file_ok = false;
+    }
+}
+
+// Liga ou desliga o espectro: "fft <pontos>" ou "fft off"
+static void set_spectrum(const char *arg) {
+    if (sampling_state != SAMPLING_IDLE) {
+        printf("Espectro não pode ser alterado durante a coleta\n");
+        return;
+    }
+
+    if (arg && 0 == strcmp(arg, "off")) {
+        spectrum_enabled = false;
+        printf("Espectro: desligado\n");
+    } else if (arg && spectrum_init(&spectrum, atoi(arg))) {
+        spectrum_enabled = true;
+        printf("Espectro: janelas de %d amostras (arquivo adc_fft.csv)\n", spectrum.n);
+    } else {
+        printf("Uso: fft <pontos: %d a %d, potência de 2> | fft off\n", FFT_MIN_N, FFT_MAX_N);
+    }
+}
+
+static void spectrum_open() {
+    if (!spectrum_enabled) {
+        return;
+    }
+
+    // Também calcula as tabelas da FFT antes do início da coleta
+    UINT bw;
+    spectrum_init(&spectrum, spectrum.n);
+    FRESULT res = f_open(&spectrum_file, "adc_fft.csv", FA_WRITE | FA_CREATE_ALWAYS);
+    if (res == FR_OK) {
+        res = f_write(&spectrum_file, SPECTRUM_HEADER, strlen(SPECTRUM_HEADER), &bw);
+    }
+    spectrum_file_ok = (res == FR_OK);
+    if (!spectrum_file_ok) {
+        printf("Erro ao abrir adc_fft.csv: %s (%d)\n", FRESULT_str(res), res);
+    }
+}
+
+// Acrescenta a amostra atual à janela. Quando ela completa, calcula o
+// espectro e grava uma linha por eixo; a janela incompleta do fim da
+// coleta é descartada.
+static FRESULT spectrum_write(uint32_t elapsed_ms) {
+    if (!spectrum_file_ok || !spectrum_push(&spectrum, elapsed_ms, accel, gyro)) {
+        return FR_OK;
+    }
+
+    spectrum_process(&spectrum);
+
+    FRESULT res = FR_OK;
+    for (uint8_t a = 0; a < SPECTRUM_AXES && res == FR_OK; a++) {
+        char line[SPECTRUM_LINE_MAX];
+        UINT bw;
+        size_t len = spectrum_format_line(&spectrum, a, line);
+        res = f_write(&spectrum_file, line, len, &bw);
+    }
+    spectrum_reset(&spectrum);
+    return res;
+}
+
+static void spectrum_close() {
+    if (spectrum_file_ok) {
+        f_close(&spectrum_file);
+        spectrum_file_ok = false;
+    }
+}
+
+// Configura a captura por disparo:
+// "trig level|slope <limiar> <pre_ms> <post_ms> [holdoff_ms]" ou "trig off"
+static void set_trigger(char *args) {
+    if (sampling_state != SAMPLING_IDLE) {
+        printf("Disparo não pode ser alterado durante a coleta\n");
+        return;
+    }
+
+    char *mode = args ? strtok(args, " ") : NULL;
+    if (mode && 0 == strcmp(mode, "off")) {
+        trigger_enabled = false;
+        printf("Disparo: desligado (gravação contínua)\n");
+        return;
+    }
+
+    char *threshold = strtok(NULL, " ");
+    char *pre = strtok(NULL, " ");
+    char *post = strtok(NULL, " ");
+    char *holdoff = strtok(NULL, " ");
+    bool level = mode && 0 == strcmp(mode, "level");
+    long limit = threshold ? atol(threshold) : 0;
+    long pre_ms = pre ? atol(pre) : -1;
+    long post_ms = post ? atol(post) : -1;
+    long holdoff_ms = holdoff ? atol(holdoff) : 0;
+
+    if (!mode || (!level && 0 != strcmp(mode, "slope")) || limit < 1 || limit > INT16_MAX ||
+        pre_ms < 0 || post_ms < 1 || holdoff_ms < 0) {
+        printf("Uso: trig level|slope <limiar em contagens> <pre_ms> <post_ms> [holdoff_ms] | trig off\n");
+        return;
+    }
+
+    trigger_config(&trigger, level ? TRIGGER_LEVEL : TRIGGER_SLOPE, limit, pre_ms, post_ms, holdoff_ms);
+    trigger_enabled = true;
+    printf("Disparo: %s > %ld contagens, pré %ld ms, pós %ld ms, hold-off %ld ms\n",
+        level ? "nível" : "inclinação", limit, pre_ms, post_ms, holdoff_ms);
+    printf("Pré-disparo limitado a %d amostras\n", TRIGGER_RING_SIZE);
+}
+
+// Passa a amostra atual pelo detector e grava apenas os eventos
+static FRESULT trigger_write(FIL *file) {
+    FRESULT res = FR_OK;
+    trigger_sample_t s;
+
+    switch (trigger_push(&trigger, sample_index, sample_us, accel, gyro)) {
+    case TRIGGER_START:
+        printf("Evento %lu em %lu ms\n", (unsigned long)trigger.events, (unsigned long)(sample_us / 1000));
+        while (res == FR_OK && trigger_pop(&trigger, &s)) {
+            res = log_write_sample(file, s.index, s.time_us, s.accel, s.gyro);
+        }
+        needs_redraw = true;
+        break;
+    case TRIGGER_WRITE:
+        res = log_write_sample(file, sample_index, sample_us, accel, gyro);
+        break;
+    case TRIGGER_END:
+        // Esvazia os buffers e atualiza a FAT; o cartão fica parado até o
+        // próximo evento
+        res = log_flush(file);
+        if (res == FR_OK) {
+            res = f_sync(file);
+        }
+        printf("Evento %lu encerrado (%lu ms)\n", (unsigned long)trigger.events,
+            (unsigned long)((sample_us - trigger.trigger_us) / 1000));
+        break;
+    default:
+        break;
+    }
+
+    return res;
+}
+
+// Grava a configuração no sensor e recalcula tudo o que depende da escala
+static bool apply_mpu_config() {
+    bool ok = mpu6050_configure(I2C0_PORT, &mpu_config);
+
+    mpu6050_scale(&mpu_config, &mpu_scale);
+    csv_set_scale(mpu_scale.accel_shift, mpu_scale.gyro_lsb_per_dps_x10);
+    attitude_set_scale(&attitude, mpu_scale.accel_lsb_per_g, mpu_scale.gyro_lsb_per_dps_x10);
+    return ok;
+}
+
+// Só lê o sensor quando há um dado novo (taxa definida por DLPF e
+// SMPLRT_DIV), sem ocupar o barramento com leituras repetidas. As leituras
+// seguem uma grade fixa a partir da primeira amostra, medida com o
+// time_us_64(): sample_index é a posição na grade e sample_us o instante
+// real da leitura. Posições perdidas (laço ocupado por mais de um período,
+// por exemplo em uma escrita no cartão) aparecem como saltos no índice.
+static bool sample_due() {
+    uint64_t now = time_us_64();
+    uint32_t period = mpu_scale.sample_period_us;
+
+    if (!sample_clock_started) {
+        sample_clock_started = true;
+        start_us = now;
+        next_sample_us = now + period;
+        sample_index = 0;
+        sample_us = 0;
+        samples_dropped = 0;
+        return true;
+    }
+    if (now < next_sample_us) {
+        return false;
+    }
+
+    uint64_t late = now - next_sample_us;
+    uint32_t skipped = late < period ? 0 : (uint32_t)(late / period);
+    sample_index += 1 + skipped;
+    samples_dropped += skipped;
+    next_sample_us += (uint64_t)(1 + skipped) * period;
+    sample_us = now - start_us;
+    return true;
+}
+
+// Dorme até a próxima amostra da grade, no máximo 60 ms para que botões e
+// terminal continuem atendidos com taxas baixas
+static void wait_next_sample() {
+    uint64_t now = time_us_64();
+    if (next_sample_us > now) {
+        uint64_t wait = next_sample_us - now;
+        sleep_us(wait < 60000 ? wait : 60000);
+    }
+}
+
+// Liga ou desliga a impressão de cada amostra no terminal: "echo on|off"
+static void set_echo(const char *arg) {
+    if (arg && 0 == strcmp(arg, "on")) {
+        sample_echo = true;
+    } else if (arg && 0 == strcmp(arg, "off")) {
+        sample_echo = false;
+    } else {
+        printf("Uso: echo on|off\n");
+        return;
+    }
+    printf("Amostras no terminal: %s\n", sample_echo ? "ligado" : "desligado");
+}
+
+// Configura o sensor: "mpu <2|4|8|16 g> <250|500|1000|2000 °/s> [dlpf 0-6] [divisor 0-255]".
+// Sem argumentos, mostra a configuração atual.
+static void set_mpu(char *args) {
+    static const uint16_t accel_g[4] = {2, 4, 8, 16};
+    static const uint16_t gyro_dps[4] = {250, 500, 1000, 2000};
+
+    char *accel_arg = args ? strtok(args, " ") : NULL;
+    if (accel_arg) {
+        if (sampling_state != SAMPLING_IDLE) {
+            printf("Configuração do sensor não pode ser alterada durante a coleta\n");
+            return;
+        }
+
+        char *gyro_arg = strtok(NULL, " ");
+        char *dlpf_arg = strtok(NULL, " ");
+        char *div_arg = strtok(NULL, " ");
+        int accel_v = atoi(accel_arg);
+        int gyro_v = gyro_arg ? atoi(gyro_arg) : -1;
+        int dlpf = dlpf_arg ? atoi(dlpf_arg) : 0;
+        int div = div_arg ? atoi(div_arg) : 0;
+        mpu6050_config_t cfg = {.dlpf = dlpf, .smplrt_div = div};
+        bool ok = dlpf >= 0 && dlpf <= 6 && div >= 0 && div <= 255;
+        bool found_accel = false;
+        bool found_gyro = false;
+
+        for (uint8_t i = 0; i < 4; i++) {
+            if (accel_v == accel_g[i]) {
+                cfg.accel_range = i;
+                found_accel = true;
+            }
+            if (gyro_v == gyro_dps[i]) {
+                cfg.gyro_range = i;
+                found_gyro = true;
+            }
+        }
+
+        if (!ok || !found_accel || !found_gyro) {
+            printf("Uso: mpu <2|4|8|16> <250|500|1000|2000> [dlpf 0-6] [divisor 0-255]\n");
+            return;
+        }
+
+        mpu_config = cfg;
+        if (!apply_mpu_config()) {
+            printf("Falha ao configurar o MPU6050\n");
+        }
+        select_calibration();
+    }
+
+    printf("MPU6050: ±%d g, ±%d °/s, DLPF %d, divisor %d (%lu us por amostra)\n",
+        accel_g[mpu_config.accel_range], gyro_dps[mpu_config.gyro_range], mpu_config.dlpf,
+        mpu_config.smplrt_div, (unsigned long)mpu_scale.sample_period_us);
+    printf("Escala: %d LSB/g, %d.%d LSB/(°/s)\n", mpu_scale.accel_lsb_per_g,
+        mpu_scale.gyro_lsb_per_dps_x10 / 10, mpu_scale.gyro_lsb_per_dps_x10 % 10);
+}
+
+// Calcula os offsets para a temperatura atual e reinicia a média usada
+// na compensação durante a coleta
+static void select_calibration() {
+    int16_t a[3], g[3];
+    mpu6050_read_raw(I2C0_PORT, a, g, &temp);
+    cal_select(&calibration, temp, &mpu_scale, &cal_active);
+    temp_comp_reset(&temp_comp, temp);
+}
+
+// O canal de temperatura só existe nos formatos por amostra (csv e delta)
+static bool log_has_temp() {
+    return temp_log && (log_format == LOG_FORMAT_CSV || log_format == LOG_FORMAT_DELTA);
+}
+
+// "temp" mostra a temperatura e os offsets em uso, "temp comp on|off" liga
+// a compensação durante a coleta e "temp log on|off" grava a temperatura
+static void set_temp(char *args) {
+    char *what = args ? strtok(args, " ") : NULL;
+    char *arg = what ? strtok(NULL, " ") : NULL;
+
+    if (!what) {
+        if (sampling_state == SAMPLING_IDLE) {
+            select_calibration();
+        }
+        int32_t t = mpu6050_temp_centi(temp_comp.temp_raw);
+        printf("Temperatura: %ld.%02ld °C (compensação %s, gravação %s)\n", (long)(t / 100), (long)abs(t % 100),
+            temp_comp.enabled ? "ligada" : "desligada", temp_log ? "ligada" : "desligada");
+        printf("Offsets em uso: acel %d %d %d, giro %d %d %d\n", cal_active.accel[0], cal_active.accel[1],
+            cal_active.accel[2], cal_active.gyro[0], cal_active.gyro[1], cal_active.gyro[2]);
+        return;
+    }
+
+    if (sampling_state != SAMPLING_IDLE) {
+        printf("Temperatura não pode ser configurada durante a coleta\n");
+        return;
+    }
+
+    bool on = arg && 0 == strcmp(arg, "on");
+    if (!arg || (!on && 0 != strcmp(arg, "off"))) {
+        printf("Uso: temp | temp comp on|off | temp log on|off\n");
+    } else if (0 == strcmp(what, "comp")) {
+        temp_comp.enabled = on;
+        printf("Compensação de temperatura: %s\n", on ? "ligada" : "desligada");
+    } else if (0 == strcmp(what, "log")) {
+        temp_log = on;
+        if (on) {
+            printf("Gravação da temperatura: ligada (média a cada %d amostras)\n", temp_comp.decim);
+        } else {
+            printf("Gravação da temperatura: desligada\n");
+        }
+        if (on && !log_has_temp()) {
+            printf("O formato atual não tem canal de temperatura (só csv e delta)\n");
+        }
+    } else {
+        printf("Uso: temp | temp comp on|off | temp log on|off\n");
+    }
+}
+
+// Calibração com a placa parada: "cal" mede e grava na flash, "cal show"
+// lista as faixas gravadas e "cal clear" apaga a calibração
+static void run_calibration(const char *arg) {
+    if (sampling_state != SAMPLING_IDLE) {
+        printf("Calibração não pode ser feita durante a coleta\n");
+        return;
+    }
+
+    if (arg && 0 == strcmp(arg, "show")) {
+        cal_print(&calibration);
+        return;
+    }
+
+    if (arg && 0 == strcmp(arg, "clear")) {
+        cal_clear(&calibration);
+        printf(cal_save(&calibration) ? "Calibração apagada\n" : "Erro ao gravar a flash\n");
+        select_calibration();
+        return;
+    }
+
+    if (arg) {
+        printf("Uso: cal | cal show | cal clear\n");
+        return;
+    }
+
+    printf("Calibrando: mantenha a placa parada e nivelada...\n");
+    notify_post(&notify, "Calibrando", "Mantenha a", "placa parada", 0, -1);
+
+    cal_bin_t bin;
+    cal_result_t result = cal_measure(I2C0_PORT, &mpu_scale, &bin);
+    needs_redraw = true;
+
+    if (result == CAL_MOVING) {
+        printf("Placa em movimento: calibração descartada\n");
+        notify_post(&notify, "Calibracao", "descartada", "", NOTIFY_MS, RED_LED_PIN);
+        return;
+    }
+    notify_post(&notify, "Calibracao", "concluida", "", NOTIFY_MS, GREEN_LED_PIN);
+    if (result == CAL_GYRO_ONLY) {
+        printf("Placa inclinada: só o giroscópio foi calibrado\n");
+    }
+
+    cal_store(&calibration, &bin);
+    if (!cal_save(&calibration)) {
+        printf("Erro ao gravar a flash\n");
+    }
+    select_calibration();
+    cal_print(&calibration);
+}
+
+// Configura os estágios de decimação: "decim 5 5 4" ou "decim off"
+static void set_decim(char *args) {
+    if (sampling_state != SAMPLING_IDLE) {
+        printf("Decimação não pode ser alterada durante a coleta\n");
+        return;
+    }
+
+    uint16_t factors[DECIM_MAX_STAGES];
+    uint8_t count = 0;
+    char *arg = args ? strtok(args, " ") : NULL;
+
+    if (!arg) {
+        printf("Uso: decim <fator> [fator ...] | decim off (até %d estágios, fatores 2 a %d)\n",
+            DECIM_MAX_STAGES, DECIM_MAX_FACTOR);
+    } else if (0 != strcmp(arg, "off")) {
+        while (arg && count < DECIM_MAX_STAGES) {
+            factors[count++] = atoi(arg);
+            arg = strtok(NULL, " ");
+        }
+        if (arg || !decim_chain_config(&decim_chain, factors, count)) {
+            printf("Configuração de decimação inválida (fatores 2 a %d por estágio, use a cascata para fatores maiores)\n",
+                DECIM_MAX_FACTOR);
+            decim_chain_config(&decim_chain, NULL, 0);
+            return;
+        }
+    } else {
+        decim_chain_config(&decim_chain, NULL, 0);
+    }
+
+    if (decim_chain.stages == 0) {
+        printf("Decimação desligada\n");
+    }
+    for (uint8_t i = 0; i < decim_chain.stages; i++) {
+        printf("Estágio %d: fator %d, %d coeficientes, arquivo adc_dec%lu.csv\n", i + 1,
+            decim_chain.stage[i].factor, decim_chain.stage[i].taps,
+            (unsigned long)decim_chain_total_factor(&decim_chain, i));
+    }
+}
+
+// Seleciona o eixo do gráfico: "wave <ax|ay|az|gx|gy|gz> [amostras por coluna]".
+// Só afeta a tela, então pode ser alterado durante a coleta.
+static void set_wave(char *args) {
+    char *axis = args ? strtok(args, " ") : NULL;
+    char *decim = axis ? strtok(NULL, " ") : NULL;
+
+    if (axis) {
+        uint8_t a = 0;
+        while (a < 6 && 0 != strcmp(axis, wave_axis_name[a])) {
+            a++;
+        }
+        if (a == 6 || (decim && atoi(decim) <= 0)) {
+            printf("Uso: wave <ax|ay|az|gx|gy|gz> [amostras por coluna]\n");
+            return;
+        }
+        wave_axis = a;
+        strip_chart_init(&wave, WIDTH, decim ? atoi(decim) : wave.decim);
+    }
+
+    printf("Gráfico: eixo %s, %d amostras por coluna\n", wave_axis_name[wave_axis], wave.decim);
+}
+
+// Abre um CSV por estágio de decimação e escreve o cabeçalho
+static void decim_open() {
+    decim_chain_reset(&decim_chain);
+
+    for (uint8_t i = 0; i < decim_chain.stages; i++) {
+        char name[20];
+        UINT bw;
+        snprintf(name, sizeof(name), "adc_dec%lu.csv", (unsigned long)decim_chain_total_factor(&decim_chain, i));
+
+        FRESULT res = f_open(&decim_file[i], name, FA_WRITE | FA_CREATE_ALWAYS);
+        if (res == FR_OK) {
+            res = f_write(&decim_file[i], CSV_HEADER, strlen(CSV_HEADER), &bw);
+        }
+        decim_file_ok[i] = (res == FR_OK);
+        if (!decim_file_ok[i]) {
+            printf("Erro ao abrir %s: %s (%d)\n", name, FRESULT_str(res), res);
+        }
+    }
+}
+
+// Passa a amostra atual pela cascata e grava as saídas produzidas. As taxas
+// são baixas, então cada linha vai direto para o buffer de setor do FatFs.
+static FRESULT decim_write(uint32_t elapsed_ms) {
+    FRESULT res = FR_OK;
+    uint8_t mask = decim_chain_push(&decim_chain, elapsed_ms, accel, gyro);
+
+    for (uint8_t i = 0; mask; i++, mask >>= 1) {
+        if (!(mask & 1) || !decim_file_ok[i]) {
+            continue;
+        }
+
+        const decim_stage_t *s = &decim_chain.stage[i];
+        char line[CSV_LINE_MAX];
+        UINT bw;
+        size_t len = csv_format_line(line, s->out_time * 1000ull, s->out, s->out + 3);
+        res = f_write(&decim_file[i], line, len, &bw);
+    }
+
+    return res;
+}
+
+static void decim_close() {
+    for (uint8_t i = 0; i < decim_chain.stages; i++) {
+        if (decim_file_ok[i]) {
+            f_close(&decim_file[i]);
+            decim_file_ok[i] = false;
+        }
+    }
+}
+
+// Define o nome do arquivo a partir do formato, dos frames e da compressão
+static void update_file_name() {
+    uint8_t variant = log_compress ? 2 : log_is_framed() ? 1 : 0;
+    snprintf(file_name, sizeof(file_name), "adc_col_data%s", log_file_ext[log_format][variant]);
 }
 
 static void process_stdio(int cRxedChar) {
@@ -464,8 +1577,57 @@ static void process_stdio(int cRxedChar) {
             return;
         }
         char *cmdn = strtok(cmd, " ");
-        if (cmdn) {
-           read_file(file_name);
+        if (cmdn && 0 == strcmp(cmdn, "bench_stdio")) {
+            run_bench_stdio();
+        } else if (cmdn && 0 == strcmp(cmdn, "format")) {
+            set_log_format(strtok(NULL, " "));
+        } else if (cmdn && 0 == strcmp(cmdn, "compress")) {
+            set_log_compress(strtok(NULL, " "));
+        } else if (cmdn && 0 == strcmp(cmdn, "frame")) {
+            set_log_frame(strtok(NULL, " "));
+        } else if (cmdn && 0 == strcmp(cmdn, "stats")) {
+            set_stats_window(strtok(NULL, " "));
+        } else if (cmdn && 0 == strcmp(cmdn, "filter")) {
+            set_filter(strtok(NULL, ""));
+        } else if (cmdn && 0 == strcmp(cmdn, "bench_filter")) {
+            filter_bank_bench(&filter_bank);
+        } else if (cmdn && 0 == strcmp(cmdn, "att")) {
+            char *arg = strtok(NULL, " ");
+            set_attitude(arg, strtok(NULL, " "));
+        } else if (cmdn && 0 == strcmp(cmdn, "bench_att")) {
+            attitude_bench();
+        } else if (cmdn && 0 == strcmp(cmdn, "echo")) {
+            set_echo(strtok(NULL, " "));
+        } else if (cmdn && 0 == strcmp(cmdn, "mpu")) {
+            set_mpu(strtok(NULL, ""));
+        } else if (cmdn && 0 == strcmp(cmdn, "cal")) {
+            run_calibration(strtok(NULL, " "));
+        } else if (cmdn && 0 == strcmp(cmdn, "temp")) {
+            set_temp(strtok(NULL, ""));
+        } else if (cmdn && 0 == strcmp(cmdn, "trig")) {
+            set_trigger(strtok(NULL, ""));
+        } else if (cmdn && 0 == strcmp(cmdn, "fft")) {
+            set_spectrum(strtok(NULL, " "));
+        } else if (cmdn && 0 == strcmp(cmdn, "bench_fft")) {
+            spectrum_bench();
+        } else if (cmdn && 0 == strcmp(cmdn, "decim")) {
+            set_decim(strtok(NULL, ""));
+        } else if (cmdn && 0 == strcmp(cmdn, "wave")) {
+            set_wave(strtok(NULL, ""));
+        } else if (cmdn && 0 == strcmp(cmdn, "bench_csv")) {
+            csv_format_bench();
+        } else if (cmdn && 0 == strcmp(cmdn, "bench_delta")) {
+            delta_block_bench();
+        } else if (cmdn && 0 == strcmp(cmdn, "bench_oled")) {
+            ssd1306_bench(&ssd);
+        } else if (cmdn && 0 == strcmp(cmdn, "lz_stats")) {
+            log_writer_print_stats(&log_writer);
+        } else if (cmdn && 0 == strcmp(cmdn, "dump")) {
+            // Exibe o arquivo indicado ou o da coleta atual
+            char *name = strtok(NULL, " ");
+            read_file(name ? name : file_name);
+        } else if (cmdn) {
+            printf("Comando desconhecido: %s\n", cmdn);
         }
         ix = 0;
         memset(cmd, 0, sizeof cmd);